@@ -34,6 +34,7 @@ Dir.mktmpdir do |tempDir|
     FileUtils.cp_r File.join(baseDir, 'examples'), tempDir
     FileUtils.cp_r binAppDir, tempDir
     FileUtils.cp   File.join(binDir,'tmxrasterizer'), File.join(tempDir, 'Tiled.app/Contents/MacOS')
+    FileUtils.cp   File.join(binDir,'tmxconvert'), File.join(tempDir, 'Tiled.app/Contents/MacOS')
     FileUtils.ln_s '/Applications', File.join(tempDir, 'Applications') #Symlink to Applications for easy install
     FileUtils.cp File.join(baseDir, 'src/tiled/images/tmx-icon-mac.icns'), File.join(tempDir, 'Tiled.app/Contents/Resources')
 
@@ -43,7 +44,7 @@ Dir.mktmpdir do |tempDir|
     raise "macdeployqt error #{$?}" unless $? == 0
 
     # Modify plugins to use Qt frameworks contained within the app bundle (is there some way to get macdeployqt to do this?)
-    Dir["#{File.join tempDir, 'Tiled.app'}/**/*.dylib","#{File.join tempDir, 'Tiled.app'}/Contents/MacOS/tmxrasterizer"].each do |library|
+    Dir["#{File.join tempDir, 'Tiled.app'}/**/*.dylib","#{File.join tempDir, 'Tiled.app'}/Contents/MacOS/tmxrasterizer","#{File.join tempDir, 'Tiled.app'}/Contents/MacOS/tmxconvert"].each do |library|
         ["QtCore", "QtGui"].each do |qtlib|
             #find any qt dependencies within this library
             qtdependency = `otool -L "#{library}" | grep #{qtlib}`.split(' ')[0]
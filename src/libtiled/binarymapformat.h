@@ -0,0 +1,68 @@
+/*
+ * binarymapformat.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BINARYMAPFORMAT_H
+#define BINARYMAPFORMAT_H
+
+#include <QtGlobal>
+
+namespace Tiled {
+namespace Internal {
+
+/*
+ * Layout of the binary map format. All numbers are stored little-endian.
+ *
+ * The file starts with a header of HeaderSize bytes:
+ *
+ *   char[4]  magic ("TBIN")
+ *   u16      version
+ *   u16      header size
+ *   u32      flags (currently always 0)
+ *   u32      body size
+ *   u32      string count
+ *   u32      string offsets offset
+ *   u32      string data offset
+ *   u32      reserved
+ *
+ * The body follows directly after the header. Strings in the body are
+ * stored as a u32 index into the string table, where index 0 is always the
+ * empty string. The string table is stored after the body, as string
+ * count + 1 u32 offsets into the UTF-8 encoded string data.
+ *
+ * The GIDs of each tile layer are stored as one block of u32 values, which
+ * is aligned to GidAlignment bytes relative to the start of the file. This
+ * allows them to be read straight from a memory mapped file.
+ */
+
+static const char BinaryMapMagic[4] = { 'T', 'B', 'I', 'N' };
+static const quint16 BinaryMapVersion = 1;
+static const int BinaryMapHeaderSize = 32;
+static const int GidAlignment = 16;
+
+enum BinaryLayerType {
+    BinaryTileLayer     = 1,
+    BinaryObjectGroup   = 2,
+    BinaryImageLayer    = 3
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // BINARYMAPFORMAT_H
@@ -0,0 +1,644 @@
+/*
+ * binarymapreader.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "binarymapreader.h"
+
+#include "binarymapformat.h"
+#include "gidmapper.h"
+#include "imagecache.h"
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "mapreader.h"
+#include "objectgroup.h"
+#include "rtbattributes.h"
+#include "tilelayer.h"
+#include "tracing.h"
+
+#include <QBuffer>
+#include <QColor>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QtEndian>
+
+#include <cstring>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+namespace Tiled {
+namespace Internal {
+
+class BinaryMapReaderPrivate
+{
+    Q_DECLARE_TR_FUNCTIONS(BinaryMapReader)
+
+public:
+    BinaryMapReaderPrivate(BinaryMapReader *binaryMapReader):
+        p(binaryMapReader),
+        mMap(0),
+        mData(0),
+        mSize(0),
+        mPos(0)
+    {}
+
+    Map *readMap(const QByteArray &data, const QString &path);
+
+    QString mError;
+
+private:
+    bool readHeader();
+    SharedTileset readTileset();
+    void readLayerAttributes(Layer *layer);
+    TileLayer *readTileLayer();
+    ObjectGroup *readObjectGroup();
+    MapObject *readMapObject();
+    ImageLayer *readImageLayer();
+    Properties readProperties();
+    QXmlStreamAttributes readAttributes();
+    QColor readColor();
+    Cell cellForGid(unsigned gid);
+
+    quint8 readU8();
+    quint32 readU32();
+    qint32 readI32() { return qint32(readU32()); }
+    double readF64();
+    QString readString();
+    QByteArray readBlob();
+    bool align(int alignment);
+    bool canRead(quint64 size);
+    quint32 readCount(quint32 minimumElementSize);
+
+    void setError(const QString &message);
+    bool hasError() const { return !mError.isEmpty(); }
+
+    BinaryMapReader *p;
+
+    QString mPath;
+    Map *mMap;
+    GidMapper mGidMapper;
+    QVector<QString> mStrings;
+
+    const uchar *mData;
+    quint32 mSize;
+    quint32 mPos;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+
+Map *BinaryMapReaderPrivate::readMap(const QByteArray &data,
+                                     const QString &path)
+{
+    mError.clear();
+    mPath = path;
+    mData = reinterpret_cast<const uchar*>(data.constData());
+    mSize = data.size();
+    mPos = 0;
+    mGidMapper.clear();
+    mStrings.clear();
+
+    if (!readHeader())
+        return 0;
+
+    const Map::Orientation orientation = Map::Orientation(readU32());
+    const Map::RenderOrder renderOrder = Map::RenderOrder(readU32());
+    const int width = readI32();
+    const int height = readI32();
+    const int tileWidth = readI32();
+    const int tileHeight = readI32();
+
+    mMap = new Map(orientation, width, height, tileWidth, tileHeight);
+    mMap->setRenderOrder(renderOrder);
+    mMap->setHexSideLength(readI32());
+    mMap->setStaggerAxis(Map::StaggerAxis(readU32()));
+    mMap->setStaggerIndex(Map::StaggerIndex(readU32()));
+    mMap->setBackgroundColor(readColor());
+
+    const int nextObjectId = readI32();
+    if (nextObjectId)
+        mMap->setNextObjectId(nextObjectId);
+
+    mMap->setLayerDataFormat(Map::LayerDataFormat(readU32()));
+    mMap->setProperties(readProperties());
+
+    // RTB
+    readRTBMapAttributes(mMap->rtbMap(), readAttributes());
+
+    const quint32 tilesetCount = readCount(8);
+    for (quint32 i = 0; i < tilesetCount && !hasError(); ++i) {
+        SharedTileset tileset = readTileset();
+        if (tileset)
+            mMap->addTileset(tileset);
+    }
+
+    const quint32 layerCount = readCount(1);
+    for (quint32 i = 0; i < layerCount && !hasError(); ++i) {
+        Layer *layer = 0;
+
+        switch (readU8()) {
+        case BinaryTileLayer:   layer = readTileLayer();    break;
+        case BinaryObjectGroup: layer = readObjectGroup();  break;
+        case BinaryImageLayer:  layer = readImageLayer();   break;
+        default:
+            setError(tr("Unknown layer type"));
+            break;
+        }
+
+        if (layer)
+            mMap->addLayer(layer);
+    }
+
+    // Clean up in case of error
+    if (hasError()) {
+        delete mMap;
+        mMap = 0;
+    }
+
+    Map *map = mMap;
+    mMap = 0;
+    mData = 0;
+    return map;
+}
+
+bool BinaryMapReaderPrivate::readHeader()
+{
+    if (!BinaryMapReader::isBinaryMap(QByteArray::fromRawData(
+                                          reinterpret_cast<const char*>(mData),
+                                          mSize))) {
+        setError(tr("Not a binary map file."));
+        return false;
+    }
+
+    const quint16 version = qFromLittleEndian<quint16>(mData + 4);
+    const quint16 headerSize = qFromLittleEndian<quint16>(mData + 6);
+    if (version != BinaryMapVersion) {
+        setError(tr("Unsupported binary map version: %1").arg(version));
+        return false;
+    }
+
+    const quint32 bodySize = qFromLittleEndian<quint32>(mData + 12);
+    const quint32 stringCount = qFromLittleEndian<quint32>(mData + 16);
+    const quint32 stringOffsetsOffset = qFromLittleEndian<quint32>(mData + 20);
+    const quint32 stringDataOffset = qFromLittleEndian<quint32>(mData + 24);
+
+    if (headerSize < BinaryMapHeaderSize ||
+            quint64(headerSize) + bodySize > stringOffsetsOffset ||
+            stringOffsetsOffset > mSize ||
+            (quint64(stringCount) + 1) * sizeof(quint32) >
+            mSize - stringOffsetsOffset ||
+            stringDataOffset > mSize) {
+        setError(tr("Corrupt binary map file."));
+        return false;
+    }
+
+    // The strings are decoded up front, since most of them are used
+    // several times
+    const uchar *offsets = mData + stringOffsetsOffset;
+    const char *stringData = reinterpret_cast<const char*>(mData) +
+            stringDataOffset;
+    const quint32 stringDataSize = mSize - stringDataOffset;
+
+    mStrings.reserve(stringCount);
+    quint32 start = qFromLittleEndian<quint32>(offsets);
+    for (quint32 i = 0; i < stringCount; ++i) {
+        const quint32 end =
+                qFromLittleEndian<quint32>(offsets + (i + 1) * sizeof(quint32));
+        if (end < start || end > stringDataSize) {
+            setError(tr("Corrupt binary map file."));
+            return false;
+        }
+        mStrings.append(QString::fromUtf8(stringData + start, end - start));
+        start = end;
+    }
+
+    // Only the body may be read from now on
+    mPos = headerSize;
+    mSize = headerSize + bodySize;
+    return true;
+}
+
+SharedTileset BinaryMapReaderPrivate::readTileset()
+{
+    const unsigned firstGid = readU32();
+    const QString source = readString();
+    const QByteArray tsx = readBlob();
+
+    if (hasError())
+        return SharedTileset();
+
+    SharedTileset tileset;
+    QString error;
+
+    if (!source.isEmpty()) {
+        QString absoluteSource = source;
+        if (QDir::isRelativePath(source))
+            absoluteSource = mPath + QLatin1Char('/') + source;
+
+        tileset = p->readExternalTileset(absoluteSource, &error);
+        if (!tileset) {
+            setError(tr("Error while loading tileset '%1': %2")
+                     .arg(absoluteSource, error));
+        }
+    } else {
+        QBuffer buffer;
+        buffer.setData(tsx);
+        buffer.open(QIODevice::ReadOnly);
+
+        MapReader reader;
+        tileset = reader.readTileset(&buffer, mPath);
+        if (!tileset) {
+            setError(tr("Error while loading embedded tileset: %1")
+                     .arg(reader.errorString()));
+        }
+    }
+
+    if (tileset)
+        mGidMapper.insert(firstGid, tileset.data());
+
+    return tileset;
+}
+
+void BinaryMapReaderPrivate::readLayerAttributes(Layer *layer)
+{
+    layer->setOpacity(readF64());
+    layer->setVisible(readU8());
+    layer->setProperties(readProperties());
+}
+
+TileLayer *BinaryMapReaderPrivate::readTileLayer()
+{
+    const QString name = readString();
+    const int x = readI32();
+    const int y = readI32();
+    const int width = readI32();
+    const int height = readI32();
+
+    // The cells are only allocated once the data is known to contain them
+    TileLayer *tileLayer = new TileLayer(name, x, y, 0, 0);
+    readLayerAttributes(tileLayer);
+
+    if (width < 0 || height < 0 || !align(GidAlignment) ||
+            !canRead(quint64(width) * quint64(height) * sizeof(quint32))) {
+        setError(tr("Corrupt tile layer data"));
+        return tileLayer;
+    }
+
+    tileLayer->resize(QSize(width, height), QPoint());
+
+    const uchar *gids = mData + mPos;
+    mPos += width * height * sizeof(quint32);
+
+    // Neighbouring cells often use the same tile, in which case the lookup
+    // can be skipped
+    unsigned lastGid = 0;
+    Cell lastCell;
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const unsigned gid = qFromLittleEndian<quint32>(gids);
+            gids += sizeof(quint32);
+
+            if (gid == 0)
+                continue;
+
+            if (gid != lastGid) {
+                lastCell = cellForGid(gid);
+                lastGid = gid;
+            }
+
+            if (!lastCell.isEmpty())
+                tileLayer->setCell(x, y, lastCell);
+        }
+    }
+
+    return tileLayer;
+}
+
+ObjectGroup *BinaryMapReaderPrivate::readObjectGroup()
+{
+    const QString name = readString();
+    const int x = readI32();
+    const int y = readI32();
+    const int width = readI32();
+    const int height = readI32();
+
+    ObjectGroup *objectGroup = new ObjectGroup(name, x, y, width, height);
+    readLayerAttributes(objectGroup);
+
+    const QColor color = readColor();
+    if (color.isValid())
+        objectGroup->setColor(color);
+
+    objectGroup->setDrawOrder(ObjectGroup::DrawOrder(readI32()));
+
+    const quint32 objectCount = readCount(4);
+    for (quint32 i = 0; i < objectCount && !hasError(); ++i)
+        objectGroup->addObject(readMapObject());
+
+    return objectGroup;
+}
+
+MapObject *BinaryMapReaderPrivate::readMapObject()
+{
+    MapObject *object = new MapObject;
+    object->setId(readI32());
+    object->setName(readString());
+    object->setType(readString());
+
+    const qreal x = readF64();
+    const qreal y = readF64();
+    const qreal width = readF64();
+    const qreal height = readF64();
+    object->setPosition(QPointF(x, y));
+    object->setSize(QSizeF(width, height));
+    object->setRotation(readF64());
+    object->setVisible(readU8());
+
+    const unsigned gid = readU32();
+    if (gid)
+        object->setCell(cellForGid(gid));
+
+    object->setShape(MapObject::Shape(readU32()));
+
+    const quint32 pointCount = readCount(16);
+    if (pointCount > 0) {
+        QPolygonF polygon;
+        polygon.reserve(pointCount);
+        for (quint32 i = 0; i < pointCount; ++i) {
+            const qreal pointX = readF64();
+            const qreal pointY = readF64();
+            polygon.append(QPointF(pointX, pointY));
+        }
+        object->setPolygon(polygon);
+    }
+
+    object->setProperties(readProperties());
+
+    // RTB
+    const QXmlStreamAttributes atts = readAttributes();
+    if (!atts.isEmpty())
+        object->setRTBMapObject(rtbMapObjectFromAttributes(atts));
+
+    return object;
+}
+
+ImageLayer *BinaryMapReaderPrivate::readImageLayer()
+{
+    const QString name = readString();
+    const int x = readI32();
+    const int y = readI32();
+    const int width = readI32();
+    const int height = readI32();
+
+    ImageLayer *imageLayer = new ImageLayer(name, x, y, width, height);
+    readLayerAttributes(imageLayer);
+
+    QString source = readString();
+    imageLayer->setTransparentColor(readColor());
+
+    if (!source.isEmpty() && !hasError()) {
+        if (QDir::isRelativePath(source))
+            source = mPath + QLatin1Char('/') + source;
+
+        if (!imageLayer->loadFromImage(ImageCache::instance()->image(source), source))
+            setError(tr("Error loading image layer image:\n'%1'").arg(source));
+    }
+
+    return imageLayer;
+}
+
+Properties BinaryMapReaderPrivate::readProperties()
+{
+    Properties properties;
+
+    const quint32 count = readCount(8);
+    for (quint32 i = 0; i < count; ++i) {
+        const QString name = readString();
+        properties.insert(name, readString());
+    }
+
+    return properties;
+}
+
+QXmlStreamAttributes BinaryMapReaderPrivate::readAttributes()
+{
+    QXmlStreamAttributes atts;
+
+    const quint32 count = readCount(8);
+    for (quint32 i = 0; i < count; ++i) {
+        const QString name = readString();
+        atts.append(name, readString());
+    }
+
+    return atts;
+}
+
+QColor BinaryMapReaderPrivate::readColor()
+{
+    const bool valid = readU8();
+    const QRgb rgba = readU32();
+    return valid ? QColor::fromRgba(rgba) : QColor();
+}
+
+Cell BinaryMapReaderPrivate::cellForGid(unsigned gid)
+{
+    bool ok;
+    const Cell result = mGidMapper.gidToCell(gid, ok);
+
+    if (!ok) {
+        if (mGidMapper.isEmpty())
+            setError(tr("Tile used but no tilesets specified"));
+        else
+            setError(tr("Invalid tile: %1").arg(gid));
+    }
+
+    return result;
+}
+
+quint8 BinaryMapReaderPrivate::readU8()
+{
+    if (!canRead(1))
+        return 0;
+    return mData[mPos++];
+}
+
+quint32 BinaryMapReaderPrivate::readU32()
+{
+    if (!canRead(sizeof(quint32)))
+        return 0;
+
+    const quint32 value = qFromLittleEndian<quint32>(mData + mPos);
+    mPos += sizeof(quint32);
+    return value;
+}
+
+double BinaryMapReaderPrivate::readF64()
+{
+    if (!canRead(sizeof(quint64)))
+        return 0;
+
+    const quint64 bits = qFromLittleEndian<quint64>(mData + mPos);
+    mPos += sizeof(quint64);
+
+    double value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+QString BinaryMapReaderPrivate::readString()
+{
+    const quint32 index = readU32();
+    if (index >= quint32(mStrings.size())) {
+        setError(tr("Corrupt binary map file."));
+        return QString();
+    }
+    return mStrings.at(index);
+}
+
+QByteArray BinaryMapReaderPrivate::readBlob()
+{
+    const quint32 size = readU32();
+    if (!canRead(size))
+        return QByteArray();
+
+    const QByteArray blob(reinterpret_cast<const char*>(mData + mPos), size);
+    mPos += size;
+    align(4);
+    return blob;
+}
+
+bool BinaryMapReaderPrivate::align(int alignment)
+{
+    const quint32 padding = (alignment - mPos % alignment) % alignment;
+    if (!canRead(padding))
+        return false;
+    mPos += padding;
+    return true;
+}
+
+bool BinaryMapReaderPrivate::canRead(quint64 size)
+{
+    if (hasError())
+        return false;
+
+    if (size > mSize - mPos) {
+        setError(tr("Unexpected end of file"));
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Reads the number of elements that follow. Guards against corrupt counts
+ * by checking that the remaining data could actually contain that many
+ * elements of at least \a minimumElementSize bytes.
+ */
+quint32 BinaryMapReaderPrivate::readCount(quint32 minimumElementSize)
+{
+    const quint32 count = readU32();
+    if (hasError())
+        return 0;
+
+    if (quint64(count) * minimumElementSize > mSize - mPos) {
+        setError(tr("Corrupt binary map file."));
+        return 0;
+    }
+
+    return count;
+}
+
+void BinaryMapReaderPrivate::setError(const QString &message)
+{
+    // Only the first error is of interest
+    if (!hasError())
+        mError = message;
+}
+
+
+BinaryMapReader::BinaryMapReader()
+    : d(new BinaryMapReaderPrivate(this))
+{
+}
+
+BinaryMapReader::~BinaryMapReader()
+{
+    delete d;
+}
+
+Map *BinaryMapReader::readMap(const QByteArray &data, const QString &path)
+{
+    TILED_TRACE("BinaryMapReader::readMap");
+
+    return d->readMap(data, path);
+}
+
+Map *BinaryMapReader::readMap(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        d->mError = QCoreApplication::translate("BinaryMapReader",
+                                                "Could not open file for reading.");
+        return 0;
+    }
+
+    const QString path = QFileInfo(fileName).absolutePath();
+
+    // Mapping the file avoids copying it, and only the pages that are
+    // actually touched get loaded.
+    if (uchar *mapped = file.map(0, file.size())) {
+        const QByteArray data =
+                QByteArray::fromRawData(reinterpret_cast<const char*>(mapped),
+                                        int(file.size()));
+        Map *map = readMap(data, path);
+        file.unmap(mapped);
+        return map;
+    }
+
+    return readMap(file.readAll(), path);
+}
+
+QString BinaryMapReader::errorString() const
+{
+    return d->mError;
+}
+
+bool BinaryMapReader::isBinaryMap(const QByteArray &data)
+{
+    return data.size() >= BinaryMapHeaderSize &&
+            std::memcmp(data.constData(), BinaryMapMagic,
+                        sizeof(BinaryMapMagic)) == 0;
+}
+
+SharedTileset BinaryMapReader::readExternalTileset(const QString &source,
+                                                   QString *error)
+{
+    MapReader reader;
+
+    SharedTileset tileset = reader.readTileset(source);
+    if (!tileset)
+        *error = reader.errorString();
+
+    return tileset;
+}
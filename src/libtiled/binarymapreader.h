@@ -0,0 +1,98 @@
+/*
+ * binarymapreader.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BINARYMAPREADER_H
+#define BINARYMAPREADER_H
+
+#include "tiled_global.h"
+#include "tileset.h"
+
+#include <QByteArray>
+#include <QString>
+
+namespace Tiled {
+
+class Map;
+
+namespace Internal {
+class BinaryMapReaderPrivate;
+}
+
+/**
+ * A reader for the binary map format written by BinaryMapWriter.
+ *
+ * Files are memory mapped when possible, in which case the tile layer data
+ * is read straight from the mapped pages.
+ *
+ * Can be subclassed when special handling of external tilesets is needed.
+ */
+class TILEDSHARED_EXPORT BinaryMapReader
+{
+public:
+    BinaryMapReader();
+    virtual ~BinaryMapReader();
+
+    /**
+     * Reads a binary map from the given \a data. Optionally a \a path can be
+     * given, which will be used to resolve relative references to external
+     * images and tilesets.
+     *
+     * Returns 0 and sets errorString() when reading failed.
+     *
+     * The caller takes ownership over the newly created map.
+     */
+    Map *readMap(const QByteArray &data, const QString &path = QString());
+
+    /**
+     * Reads a binary map from the given \a fileName.
+     * \overload
+     */
+    Map *readMap(const QString &fileName);
+
+    /**
+     * Returns the error message for the last occurred error.
+     */
+    QString errorString() const;
+
+    /**
+     * Returns whether the given \a data starts with the header of the binary
+     * map format.
+     */
+    static bool isBinaryMap(const QByteArray &data);
+
+protected:
+    /**
+     * Called when an external tileset is encountered while a map is loaded.
+     * The default implementation uses MapReader to read the TSX file.
+     *
+     * If an error occurred, the \a error parameter should be set to the error
+     * message.
+     */
+    virtual SharedTileset readExternalTileset(const QString &source,
+                                              QString *error);
+
+private:
+    friend class Internal::BinaryMapReaderPrivate;
+    Internal::BinaryMapReaderPrivate *d;
+};
+
+} // namespace Tiled
+
+#endif // BINARYMAPREADER_H
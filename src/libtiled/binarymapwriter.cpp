@@ -0,0 +1,453 @@
+/*
+ * binarymapwriter.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "binarymapwriter.h"
+
+#include "binarymapformat.h"
+#include "gidmapper.h"
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "mapwriter.h"
+#include "objectgroup.h"
+#include "rtbattributes.h"
+#include "tilelayer.h"
+#include "tileset.h"
+#include "tracing.h"
+
+#include <QBuffer>
+#include <QCoreApplication>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QtEndian>
+
+#include <cstring>
+
+#if QT_VERSION >= 0x050100
+#define HAS_QSAVEFILE_SUPPORT
+#endif
+
+#ifdef HAS_QSAVEFILE_SUPPORT
+#include <QSaveFile>
+#endif
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+namespace Tiled {
+namespace Internal {
+
+class BinaryMapWriterPrivate
+{
+    Q_DECLARE_TR_FUNCTIONS(BinaryMapWriter)
+
+public:
+    bool writeMap(const Map *map, QIODevice *device, const QString &path);
+
+    QString mError;
+
+private:
+    void writeTileset(const Tileset *tileset, unsigned firstGid);
+    void writeLayerAttributes(const Layer *layer);
+    void writeTileLayer(const TileLayer *tileLayer);
+    void writeObjectGroup(const ObjectGroup *objectGroup);
+    void writeMapObject(const MapObject *mapObject);
+    void writeImageLayer(const ImageLayer *imageLayer);
+    void writeProperties(const Properties &properties);
+    void writeAttributes(const QXmlStreamAttributes &atts);
+    void writeColor(const QColor &color);
+
+    void writeU8(quint8 value);
+    void writeU32(quint32 value);
+    void writeI32(qint32 value) { writeU32(quint32(value)); }
+    void writeF64(double value);
+    void writeString(const QString &string);
+    void writeBlob(const QByteArray &data);
+    void align(int alignment);
+
+    QString referenceTo(const QString &fileName) const;
+
+    QByteArray mBody;
+    QList<QByteArray> mStrings;
+    QHash<QString, quint32> mStringIndex;
+    GidMapper mGidMapper;
+    QDir mMapDir;
+    bool mUseAbsolutePaths;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+
+bool BinaryMapWriterPrivate::writeMap(const Map *map, QIODevice *device,
+                                      const QString &path)
+{
+    mMapDir = QDir(path);
+    mUseAbsolutePaths = path.isEmpty();
+    mBody.clear();
+    mStrings.clear();
+    mStringIndex.clear();
+    mGidMapper.clear();
+
+    // String index 0 is reserved for the empty string
+    mStrings.append(QByteArray());
+    mStringIndex.insert(QString(), 0);
+
+    writeU32(map->orientation());
+    writeU32(map->renderOrder());
+    writeI32(map->width());
+    writeI32(map->height());
+    writeI32(map->tileWidth());
+    writeI32(map->tileHeight());
+    writeI32(map->hexSideLength());
+    writeU32(map->staggerAxis());
+    writeU32(map->staggerIndex());
+    writeColor(map->backgroundColor());
+    writeI32(map->nextObjectId());
+    writeU32(map->layerDataFormat());
+    writeProperties(map->properties());
+    writeAttributes(rtbMapAttributes(map->rtbMap()));
+
+    writeU32(map->tilesetCount());
+    unsigned firstGid = 1;
+    foreach (const SharedTileset &tileset, map->tilesets()) {
+        writeTileset(tileset.data(), firstGid);
+        mGidMapper.insert(firstGid, tileset.data());
+        firstGid += tileset->tileCount();
+    }
+
+    writeU32(map->layerCount());
+    foreach (const Layer *layer, map->layers()) {
+        switch (layer->layerType()) {
+        case Layer::TileLayerType:
+            writeU8(BinaryTileLayer);
+            writeTileLayer(static_cast<const TileLayer*>(layer));
+            break;
+        case Layer::ObjectGroupType:
+            writeU8(BinaryObjectGroup);
+            writeObjectGroup(static_cast<const ObjectGroup*>(layer));
+            break;
+        case Layer::ImageLayerType:
+            writeU8(BinaryImageLayer);
+            writeImageLayer(static_cast<const ImageLayer*>(layer));
+            break;
+        }
+    }
+
+    align(4);
+
+    // The string table follows the body
+    const quint32 stringOffsetsOffset = BinaryMapHeaderSize + mBody.size();
+    const quint32 stringDataOffset = stringOffsetsOffset +
+            (mStrings.size() + 1) * sizeof(quint32);
+
+    QByteArray stringTable;
+    stringTable.resize((mStrings.size() + 1) * sizeof(quint32));
+    uchar *offsets = reinterpret_cast<uchar*>(stringTable.data());
+
+    quint32 stringOffset = 0;
+    for (int i = 0; i < mStrings.size(); ++i) {
+        qToLittleEndian<quint32>(stringOffset, offsets + i * sizeof(quint32));
+        stringOffset += mStrings.at(i).size();
+    }
+    qToLittleEndian<quint32>(stringOffset,
+                             offsets + mStrings.size() * sizeof(quint32));
+
+    foreach (const QByteArray &string, mStrings)
+        stringTable.append(string);
+
+    uchar header[BinaryMapHeaderSize];
+    std::memset(header, 0, sizeof(header));
+    std::memcpy(header, BinaryMapMagic, sizeof(BinaryMapMagic));
+    qToLittleEndian<quint16>(BinaryMapVersion, header + 4);
+    qToLittleEndian<quint16>(BinaryMapHeaderSize, header + 6);
+    qToLittleEndian<quint32>(0, header + 8);
+    qToLittleEndian<quint32>(mBody.size(), header + 12);
+    qToLittleEndian<quint32>(mStrings.size(), header + 16);
+    qToLittleEndian<quint32>(stringOffsetsOffset, header + 20);
+    qToLittleEndian<quint32>(stringDataOffset, header + 24);
+
+    if (device->write(reinterpret_cast<const char*>(header),
+                      BinaryMapHeaderSize) != BinaryMapHeaderSize ||
+            device->write(mBody) != mBody.size() ||
+            device->write(stringTable) != stringTable.size()) {
+        mError = device->errorString();
+        return false;
+    }
+
+    mBody.clear();
+    return true;
+}
+
+void BinaryMapWriterPrivate::writeTileset(const Tileset *tileset,
+                                          unsigned firstGid)
+{
+    writeU32(firstGid);
+
+    const QString &fileName = tileset->fileName();
+    if (!fileName.isEmpty()) {
+        writeString(referenceTo(fileName));
+        writeBlob(QByteArray());
+        return;
+    }
+
+    // Embedded tilesets are rare, so they are simply stored as TSX
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+
+    MapWriter writer;
+    writer.setDtdEnabled(false);
+    writer.writeTileset(*tileset, &buffer,
+                        mUseAbsolutePaths ? QString() : mMapDir.path());
+
+    writeString(QString());
+    writeBlob(buffer.data());
+}
+
+void BinaryMapWriterPrivate::writeLayerAttributes(const Layer *layer)
+{
+    writeString(layer->name());
+    writeI32(layer->x());
+    writeI32(layer->y());
+    writeI32(layer->width());
+    writeI32(layer->height());
+    writeF64(layer->opacity());
+    writeU8(layer->isVisible());
+    writeProperties(layer->properties());
+}
+
+void BinaryMapWriterPrivate::writeTileLayer(const TileLayer *tileLayer)
+{
+    writeLayerAttributes(tileLayer);
+
+    // The GIDs are stored as an aligned block, so that they can be read
+    // without copying them first.
+    align(GidAlignment);
+
+    const int count = tileLayer->width() * tileLayer->height();
+    const int start = mBody.size();
+    mBody.resize(start + count * sizeof(quint32));
+
+    uchar *gids = reinterpret_cast<uchar*>(mBody.data() + start);
+    int i = 0;
+
+    for (int y = 0; y < tileLayer->height(); ++y) {
+        for (int x = 0; x < tileLayer->width(); ++x) {
+            const unsigned gid = mGidMapper.cellToGid(tileLayer->cellAt(x, y));
+            qToLittleEndian<quint32>(gid, gids + i * sizeof(quint32));
+            ++i;
+        }
+    }
+}
+
+void BinaryMapWriterPrivate::writeObjectGroup(const ObjectGroup *objectGroup)
+{
+    writeLayerAttributes(objectGroup);
+    writeColor(objectGroup->color());
+    writeI32(objectGroup->drawOrder());
+
+    writeU32(objectGroup->objectCount());
+    foreach (const MapObject *mapObject, objectGroup->objects())
+        writeMapObject(mapObject);
+}
+
+void BinaryMapWriterPrivate::writeMapObject(const MapObject *mapObject)
+{
+    writeI32(mapObject->id());
+    writeString(mapObject->name());
+    writeString(mapObject->type());
+    writeF64(mapObject->x());
+    writeF64(mapObject->y());
+    writeF64(mapObject->width());
+    writeF64(mapObject->height());
+    writeF64(mapObject->rotation());
+    writeU8(mapObject->isVisible());
+    writeU32(mGidMapper.cellToGid(mapObject->cell()));
+    writeU32(mapObject->shape());
+
+    const QPolygonF &polygon = mapObject->polygon();
+    writeU32(polygon.size());
+    foreach (const QPointF &point, polygon) {
+        writeF64(point.x());
+        writeF64(point.y());
+    }
+
+    writeProperties(mapObject->properties());
+
+    // RTB
+    if (mapObject->rtbMapObject())
+        writeAttributes(rtbMapObjectAttributes(mapObject->rtbMapObject()));
+    else
+        writeU32(0);
+}
+
+void BinaryMapWriterPrivate::writeImageLayer(const ImageLayer *imageLayer)
+{
+    writeLayerAttributes(imageLayer);
+
+    const QString &imageSource = imageLayer->imageSource();
+    writeString(imageSource.isEmpty() ? QString() : referenceTo(imageSource));
+    writeColor(imageLayer->transparentColor());
+}
+
+void BinaryMapWriterPrivate::writeProperties(const Properties &properties)
+{
+    writeU32(properties.size());
+
+    Properties::const_iterator it = properties.constBegin();
+    Properties::const_iterator it_end = properties.constEnd();
+    for (; it != it_end; ++it) {
+        writeString(it.key());
+        writeString(it.value());
+    }
+}
+
+void BinaryMapWriterPrivate::writeAttributes(const QXmlStreamAttributes &atts)
+{
+    writeU32(atts.size());
+
+    foreach (const QXmlStreamAttribute &attribute, atts) {
+        writeString(attribute.name().toString());
+        writeString(attribute.value().toString());
+    }
+}
+
+/**
+ * Colors are stored as a validity flag followed by the ARGB value.
+ */
+void BinaryMapWriterPrivate::writeColor(const QColor &color)
+{
+    writeU8(color.isValid());
+    writeU32(color.isValid() ? color.rgba() : 0);
+}
+
+void BinaryMapWriterPrivate::writeU8(quint8 value)
+{
+    mBody.append(char(value));
+}
+
+void BinaryMapWriterPrivate::writeU32(quint32 value)
+{
+    uchar bytes[sizeof(quint32)];
+    qToLittleEndian<quint32>(value, bytes);
+    mBody.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+void BinaryMapWriterPrivate::writeF64(double value)
+{
+    quint64 bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+
+    uchar bytes[sizeof(quint64)];
+    qToLittleEndian<quint64>(bits, bytes);
+    mBody.append(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+}
+
+void BinaryMapWriterPrivate::writeString(const QString &string)
+{
+    QHash<QString, quint32>::const_iterator it = mStringIndex.constFind(string);
+    if (it != mStringIndex.constEnd()) {
+        writeU32(it.value());
+        return;
+    }
+
+    const quint32 index = mStrings.size();
+    mStrings.append(string.toUtf8());
+    mStringIndex.insert(string, index);
+    writeU32(index);
+}
+
+void BinaryMapWriterPrivate::writeBlob(const QByteArray &data)
+{
+    writeU32(data.size());
+    mBody.append(data);
+    align(4);
+}
+
+/**
+ * Pads the body so that the next value starts at a multiple of
+ * \a alignment bytes from the start of the file.
+ */
+void BinaryMapWriterPrivate::align(int alignment)
+{
+    const int offset = BinaryMapHeaderSize + mBody.size();
+    const int padding = (alignment - offset % alignment) % alignment;
+    mBody.append(QByteArray(padding, '\0'));
+}
+
+QString BinaryMapWriterPrivate::referenceTo(const QString &fileName) const
+{
+    // Files from the resources can't be made relative
+    if (mUseAbsolutePaths || fileName.startsWith(QLatin1Char(':')))
+        return fileName;
+    return mMapDir.relativeFilePath(fileName);
+}
+
+
+BinaryMapWriter::BinaryMapWriter()
+    : d(new BinaryMapWriterPrivate)
+{
+}
+
+BinaryMapWriter::~BinaryMapWriter()
+{
+    delete d;
+}
+
+bool BinaryMapWriter::writeMap(const Map *map, QIODevice *device,
+                               const QString &path)
+{
+    TILED_TRACE("BinaryMapWriter::writeMap");
+
+    d->mError.clear();
+    return d->writeMap(map, device, path);
+}
+
+bool BinaryMapWriter::writeMap(const Map *map, const QString &fileName)
+{
+#ifdef HAS_QSAVEFILE_SUPPORT
+    QSaveFile file(fileName);
+#else
+    QFile file(fileName);
+#endif
+    if (!file.open(QIODevice::WriteOnly)) {
+        d->mError = QCoreApplication::translate("BinaryMapWriter",
+                                                "Could not open file for writing.");
+        return false;
+    }
+
+    if (!writeMap(map, &file, QFileInfo(fileName).absolutePath()))
+        return false;
+
+#ifdef HAS_QSAVEFILE_SUPPORT
+    if (!file.commit()) {
+        d->mError = file.errorString();
+        return false;
+    }
+#endif
+
+    return true;
+}
+
+QString BinaryMapWriter::errorString() const
+{
+    return d->mError;
+}
@@ -0,0 +1,80 @@
+/*
+ * binarymapwriter.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BINARYMAPWRITER_H
+#define BINARYMAPWRITER_H
+
+#include "tiled_global.h"
+
+#include <QString>
+
+class QIODevice;
+
+namespace Tiled {
+
+class Map;
+
+namespace Internal {
+class BinaryMapWriterPrivate;
+}
+
+/**
+ * A writer for the binary map format, which is meant as a cache that loads
+ * much faster than TMX. The layout is described in binarymapformat.h.
+ *
+ * External tilesets are referenced by file name, while embedded tilesets
+ * are stored as a TSX document.
+ */
+class TILEDSHARED_EXPORT BinaryMapWriter
+{
+public:
+    BinaryMapWriter();
+    ~BinaryMapWriter();
+
+    /**
+     * Writes a binary map to the given \a device. Optionally a \a path can
+     * be given, which will be used to create relative references to external
+     * images and tilesets.
+     *
+     * Returns false and sets errorString() when writing failed.
+     */
+    bool writeMap(const Map *map, QIODevice *device,
+                  const QString &path = QString());
+
+    /**
+     * Writes a binary map to the given \a fileName.
+     *
+     * Returns false and sets errorString() when writing failed.
+     * \overload
+     */
+    bool writeMap(const Map *map, const QString &fileName);
+
+    /**
+     * Returns the error message for the last occurred error.
+     */
+    QString errorString() const;
+
+private:
+    Internal::BinaryMapWriterPrivate *d;
+};
+
+} // namespace Tiled
+
+#endif // BINARYMAPWRITER_H
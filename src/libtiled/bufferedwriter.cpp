@@ -0,0 +1,91 @@
+/*
+ * bufferedwriter.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "bufferedwriter.h"
+
+#include <QIODevice>
+
+using namespace Tiled;
+
+BufferedWriter::BufferedWriter(QIODevice *device, int bufferSize)
+    : mDevice(device)
+    , mBuffer(qMax(bufferSize, 16), '\0')
+    , mData(mBuffer.data())
+    , mCapacity(mBuffer.size())
+    , mSize(0)
+    , mError(false)
+{
+}
+
+BufferedWriter::~BufferedWriter()
+{
+    flush();
+}
+
+void BufferedWriter::writeNumber(int value)
+{
+    if (value < 0) {
+        write('-');
+        // Negating as unsigned also works for the smallest int
+        writeNumber(0u - unsigned(value));
+    } else {
+        writeNumber(unsigned(value));
+    }
+}
+
+void BufferedWriter::writeNumber(unsigned value)
+{
+    char digits[10];
+    int start = sizeof(digits);
+
+    do {
+        digits[--start] = char('0' + value % 10);
+        value /= 10;
+    } while (value);
+
+    write(digits + start, int(sizeof(digits)) - start);
+}
+
+bool BufferedWriter::flush()
+{
+    if (mSize > 0) {
+        if (mDevice->write(mData, mSize) != mSize)
+            mError = true;
+        mSize = 0;
+    }
+    return !mError;
+}
+
+/**
+ * Called when the data does not fit in the buffer anymore. Large blocks are
+ * written to the device directly, rather than being copied in parts.
+ */
+void BufferedWriter::writeUnbuffered(const char *data, int length)
+{
+    flush();
+
+    if (length >= mCapacity) {
+        if (mDevice->write(data, length) != length)
+            mError = true;
+    } else {
+        std::memcpy(mData, data, length);
+        mSize = length;
+    }
+}
@@ -0,0 +1,101 @@
+/*
+ * bufferedwriter.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BUFFEREDWRITER_H
+#define BUFFEREDWRITER_H
+
+#include "tiled_global.h"
+
+#include <QByteArray>
+
+#include <cstring>
+
+class QIODevice;
+
+namespace Tiled {
+
+/**
+ * Collects small writes in a buffer, which is written to the device only when
+ * it is full or when flush() is called. Numbers are formatted without any
+ * temporary allocations.
+ *
+ * Meant for writers that produce their output in many small pieces, for
+ * which writing to the device directly would mostly be function call and
+ * system call overhead.
+ */
+class TILEDSHARED_EXPORT BufferedWriter
+{
+public:
+    explicit BufferedWriter(QIODevice *device, int bufferSize = 65536);
+
+    /**
+     * Flushes any remaining data to the device.
+     */
+    ~BufferedWriter();
+
+    void write(const char *data, int length);
+    void write(const char *string) { write(string, int(qstrlen(string))); }
+    void write(const QByteArray &bytes) { write(bytes.constData(), bytes.size()); }
+    void write(char c);
+
+    void writeNumber(int value);
+    void writeNumber(unsigned value);
+
+    /**
+     * Writes the buffered data to the device. Returns whether all data so
+     * far could be written.
+     */
+    bool flush();
+
+    bool hasError() const { return mError; }
+
+private:
+    Q_DISABLE_COPY(BufferedWriter)
+
+    void writeUnbuffered(const char *data, int length);
+
+    QIODevice *mDevice;
+    QByteArray mBuffer;
+    char *mData;
+    int mCapacity;
+    int mSize;
+    bool mError;
+};
+
+inline void BufferedWriter::write(const char *data, int length)
+{
+    if (mSize + length <= mCapacity) {
+        std::memcpy(mData + mSize, data, length);
+        mSize += length;
+    } else {
+        writeUnbuffered(data, length);
+    }
+}
+
+inline void BufferedWriter::write(char c)
+{
+    if (mSize == mCapacity)
+        flush();
+    mData[mSize++] = c;
+}
+
+} // namespace Tiled
+
+#endif // BUFFEREDWRITER_H
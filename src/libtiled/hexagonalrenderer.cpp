@@ -33,6 +33,7 @@
 #include "tile.h"
 #include "tilelayer.h"
 #include "tileset.h"
+#include "tracing.h"
 
 #include <QVector2D>
 #include <QtCore/qmath.h>
@@ -253,6 +254,8 @@ void HexagonalRenderer::drawTileLayer(QPainter *painter,
                                       const TileLayer *layer,
                                       const QRectF &exposed) const
 {
+    TILED_TRACE("HexagonalRenderer::drawTileLayer");
+
     const RenderParams p(map());
 
     QRect rect = exposed.toAlignedRect();
@@ -0,0 +1,143 @@
+/*
+ * imagecache.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "imagecache.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+
+using namespace Tiled;
+
+static const qint64 defaultMaxBytes = 256 * 1024 * 1024;
+
+static int costForBytes(qint64 bytes)
+{
+    return static_cast<int>((bytes + 1023) / 1024);
+}
+
+qreal ImageCache::Statistics::hitRate() const
+{
+    const int requests = hits + misses;
+    return requests > 0 ? qreal(hits) / requests : 0;
+}
+
+ImageCache *ImageCache::instance()
+{
+    static ImageCache cache;
+    return &cache;
+}
+
+ImageCache::ImageCache()
+    : mImages(costForBytes(defaultMaxBytes))
+    , mHits(0)
+    , mMisses(0)
+{
+}
+
+QImage ImageCache::image(const QString &fileName)
+{
+    const QFileInfo fileInfo(fileName);
+    const QString key = cacheKey(fileName);
+    const QDateTime lastModified = fileInfo.lastModified();
+    const qint64 fileSize = fileInfo.size();
+
+    {
+        QMutexLocker locker(&mMutex);
+
+        const Entry *entry = mImages.object(key);
+        if (entry && entry->lastModified == lastModified
+                && entry->fileSize == fileSize) {
+            ++mHits;
+            return entry->image;
+        }
+
+        ++mMisses;
+    }
+
+    // The lock is not held while decoding, so that different images can be
+    // decoded by several threads at once
+    const QImage image(fileName);
+
+    QMutexLocker locker(&mMutex);
+
+    if (image.isNull()) {
+        mImages.remove(key);
+        return image;
+    }
+
+    Entry *entry = new Entry;
+    entry->image = image;
+    entry->lastModified = lastModified;
+    entry->fileSize = fileSize;
+    mImages.insert(key, entry, costForBytes(image.byteCount()));
+
+    return image;
+}
+
+void ImageCache::remove(const QString &fileName)
+{
+    QMutexLocker locker(&mMutex);
+    mImages.remove(cacheKey(fileName));
+}
+
+void ImageCache::clear()
+{
+    QMutexLocker locker(&mMutex);
+    mImages.clear();
+}
+
+void ImageCache::setMaxBytes(qint64 maxBytes)
+{
+    QMutexLocker locker(&mMutex);
+    mImages.setMaxCost(costForBytes(maxBytes));
+}
+
+qint64 ImageCache::maxBytes() const
+{
+    QMutexLocker locker(&mMutex);
+    return qint64(mImages.maxCost()) * 1024;
+}
+
+ImageCache::Statistics ImageCache::statistics() const
+{
+    QMutexLocker locker(&mMutex);
+
+    Statistics statistics;
+    statistics.hits = mHits;
+    statistics.misses = mMisses;
+    statistics.images = mImages.count();
+    statistics.bytes = qint64(mImages.totalCost()) * 1024;
+    return statistics;
+}
+
+void ImageCache::resetStatistics()
+{
+    QMutexLocker locker(&mMutex);
+    mHits = 0;
+    mMisses = 0;
+}
+
+QString ImageCache::cacheKey(const QString &fileName)
+{
+    const QFileInfo fileInfo(fileName);
+    const QString canonicalPath = fileInfo.canonicalFilePath();
+    return canonicalPath.isEmpty() ? fileInfo.absoluteFilePath()
+                                   : canonicalPath;
+}
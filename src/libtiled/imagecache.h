@@ -0,0 +1,121 @@
+/*
+ * imagecache.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef IMAGECACHE_H
+#define IMAGECACHE_H
+
+#include "tiled_global.h"
+
+#include <QCache>
+#include <QDateTime>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+namespace Tiled {
+
+/**
+ * A thread-safe, process-wide cache of decoded images, keyed by their
+ * canonical file name.
+ *
+ * Cached images are shared with the callers through the implicit sharing of
+ * QImage, so an image used by several maps is only decoded and stored once.
+ * An entry is decoded again when the modification time of its file changed.
+ *
+ * The least recently used images are dropped from the cache once the total
+ * size of the cached images exceeds maxBytes(). Images still in use elsewhere
+ * stay alive until their last copy is released.
+ */
+class TILEDSHARED_EXPORT ImageCache
+{
+public:
+    struct Statistics
+    {
+        Statistics()
+            : hits(0)
+            , misses(0)
+            , images(0)
+            , bytes(0)
+        {}
+
+        qreal hitRate() const;
+
+        int hits;
+        int misses;
+        int images;
+        qint64 bytes;       // Rounded up to whole kilobytes per image
+    };
+
+    /**
+     * Returns the process-wide image cache.
+     */
+    static ImageCache *instance();
+
+    ImageCache();
+
+    /**
+     * Returns the image stored in the file \a fileName, decoding it when it
+     * is not cached or when the file was modified since. Returns a null image
+     * when the file could not be read.
+     */
+    QImage image(const QString &fileName);
+
+    /**
+     * Removes the cached image for \a fileName, so that it is decoded again
+     * the next time it is requested.
+     */
+    void remove(const QString &fileName);
+
+    void clear();
+
+    /**
+     * Sets the total size of the decoded images that may be kept in the
+     * cache, in bytes.
+     */
+    void setMaxBytes(qint64 maxBytes);
+    qint64 maxBytes() const;
+
+    Statistics statistics() const;
+    void resetStatistics();
+
+private:
+    struct Entry
+    {
+        QImage image;
+        QDateTime lastModified;
+        qint64 fileSize;
+    };
+
+    static QString cacheKey(const QString &fileName);
+
+    mutable QMutex mMutex;
+
+    /**
+     * The cost of an entry is its size in kilobytes, since QCache counts
+     * costs in an int.
+     */
+    QCache<QString, Entry> mImages;
+    int mHits;
+    int mMisses;
+};
+
+} // namespace Tiled
+
+#endif // IMAGECACHE_H
@@ -33,6 +33,7 @@
 #include "tile.h"
 #include "tilelayer.h"
 #include "tileset.h"
+#include "tracing.h"
 
 #include <cmath>
 
@@ -170,6 +171,8 @@ void IsometricRenderer::drawTileLayer(QPainter *painter,
                                       const TileLayer *layer,
                                       const QRectF &exposed) const
 {
+    TILED_TRACE("IsometricRenderer::drawTileLayer");
+
     const int tileWidth = map()->tileWidth();
     const int tileHeight = map()->tileHeight();
 
@@ -27,8 +27,12 @@ DEFINES += QT_NO_CAST_FROM_ASCII \
 DEFINES += TILED_LIBRARY
 contains(QT_CONFIG, reduce_exports): CONFIG += hide_symbols
 
-SOURCES += compression.cpp \
+SOURCES += binarymapreader.cpp \
+    binarymapwriter.cpp \
+    bufferedwriter.cpp \
+    compression.cpp \
     gidmapper.cpp \
+    imagecache.cpp \
     imagelayer.cpp \
     isometricrenderer.cpp \
     layer.cpp \
@@ -44,11 +48,19 @@ SOURCES += compression.cpp \
     tile.cpp \
     tilelayer.cpp \
     tileset.cpp \
+    tilesetcache.cpp \
+    tracing.cpp \
     hexagonalrenderer.cpp \
     rtbmap.cpp \
-    rtbmapobject.cpp
-HEADERS += compression.h \
+    rtbmapobject.cpp \
+    rtbattributes.cpp
+HEADERS += binarymapformat.h \
+    binarymapreader.h \
+    binarymapwriter.h \
+    bufferedwriter.h \
+    compression.h \
     gidmapper.h \
+    imagecache.h \
     imagelayer.h \
     isometricrenderer.h \
     layer.h \
@@ -70,10 +82,13 @@ HEADERS += compression.h \
     tiled_global.h \
     tilelayer.h \
     tileset.h \
+    tilesetcache.h \
+    tracing.h \
     logginginterface.h \
     hexagonalrenderer.h \
     rtbmap.h \
-    rtbmapobject.h
+    rtbmapobject.h \
+    rtbattributes.h
 
 contains(INSTALL_HEADERS, yes) {
     headers.files = $${HEADERS}
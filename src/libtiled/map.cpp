@@ -71,13 +71,22 @@ Map::Map(const Map &map):
     mDrawMargins(map.mDrawMargins),
     mTilesets(map.mTilesets),
     mLayerDataFormat(map.mLayerDataFormat),
-    mNextObjectId(1),
+    mNextObjectId(map.mNextObjectId),
     mRTBMap(map.mRTBMap)
 {
     foreach (const Layer *layer, map.mLayers) {
         Layer *clone = layer->clone();
         clone->setMap(this);
         mLayers.append(clone);
+
+        // Cloned objects get no id, but the copy needs to keep them since
+        // objects refer to each other by id
+        if (layer->isObjectGroup()) {
+            const ObjectGroup *objectGroup = static_cast<const ObjectGroup*>(layer);
+            const QList<MapObject*> &objects = clone->asObjectGroup()->objects();
+            for (int i = 0; i < objects.size(); ++i)
+                objects.at(i)->setId(objectGroup->objectAt(i)->id());
+        }
     }
 }
 
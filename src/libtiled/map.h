@@ -120,6 +120,7 @@ public:
 
     /**
      * Copy constructor. Makes sure that a deep-copy of the layers is created.
+     * The objects of the copy keep their ids.
      */
     Map(const Map &map);
 
@@ -106,6 +106,7 @@ protected:
 
     /**
      * Called when an external image is encountered while a tileset is loaded.
+     * The default implementation reads it through the ImageCache.
      */
     virtual QImage readExternalImage(const QString &source);
 
@@ -33,6 +33,7 @@
 #include "tile.h"
 #include "tilelayer.h"
 #include "tileset.h"
+#include "tracing.h"
 
 #include <QtCore/qmath.h>
 
@@ -200,6 +201,8 @@ void OrthogonalRenderer::drawTileLayer(QPainter *painter,
                                        const TileLayer *layer,
                                        const QRectF &exposed) const
 {
+    TILED_TRACE("OrthogonalRenderer::drawTileLayer");
+
     const QTransform savedTransform = painter->transform();
 
     const int tileWidth = map()->tileWidth();
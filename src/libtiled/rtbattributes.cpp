@@ -0,0 +1,424 @@
+/*
+ * rtbattributes.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rtbattributes.h"
+
+#include "rtbmap.h"
+#include "rtbmapobject.h"
+
+namespace Tiled {
+namespace Internal {
+
+QXmlStreamAttributes rtbMapAttributes(const RTBMap *rtbMap)
+{
+    QXmlStreamAttributes atts;
+
+    atts.append(QLatin1String("haserror"), QString::number(rtbMap->hasError()));
+    atts.append(QLatin1String("customglowcolor"), rtbMap->customGlowColor().name());
+    atts.append(QLatin1String("custombackgroundcolor"), rtbMap->customBackgroundColor().name());
+    atts.append(QLatin1String("levelbrightness"), QString::number(rtbMap->levelBrightness()));
+    atts.append(QLatin1String("clouddensity"), QString::number(rtbMap->cloudDensity()));
+    atts.append(QLatin1String("cloudvelocity"), QString::number(rtbMap->cloudVelocity()));
+    atts.append(QLatin1String("cloudalpha"), QString::number(rtbMap->cloudAlpha()));
+    atts.append(QLatin1String("snowdensity"), QString::number(rtbMap->snowDensity()));
+    atts.append(QLatin1String("snowvelocity"), QString::number(rtbMap->snowVelocity()));
+    atts.append(QLatin1String("snowrisingvelocity"), QString::number(rtbMap->snowRisingVelocity()));
+    atts.append(QLatin1String("cameragrain"), QString::number(rtbMap->cameraGrain()));
+    atts.append(QLatin1String("cameracontrast"), QString::number(rtbMap->cameraContrast()));
+    atts.append(QLatin1String("camerasaturation"), QString::number(rtbMap->cameraSaturation()));
+    atts.append(QLatin1String("cameraglow"), QString::number(rtbMap->cameraGlow()));
+    atts.append(QLatin1String("haswalls"), QString::number(rtbMap->hasWall()));
+    atts.append(QLatin1String("levelname"), rtbMap->levelName());
+    atts.append(QLatin1String("leveldescription"), rtbMap->levelDescription());
+    atts.append(QLatin1String("backgroundcolorscheme"), QString::number(rtbMap->backgroundColorScheme()));
+    atts.append(QLatin1String("glowcolorscheme"), QString::number(rtbMap->glowColorScheme()));
+    atts.append(QLatin1String("chapter"), QString::number(rtbMap->chapter()));
+    atts.append(QLatin1String("hasstarfield"), QString::number(rtbMap->hasStarfield()));
+    atts.append(QLatin1String("difficulty"), QString::number(rtbMap->difficulty()));
+    atts.append(QLatin1String("playstyle"), QString::number(rtbMap->playStyle()));
+    atts.append(QLatin1String("workShopId"), QString::number(rtbMap->workShopId()));
+    atts.append(QLatin1String("previewimagepath"), rtbMap->previewImagePath());
+
+    return atts;
+}
+
+QXmlStreamAttributes rtbMapObjectAttributes(const RTBMapObject *rtbMapObject)
+{
+    QXmlStreamAttributes atts;
+    atts.append(QLatin1String("objecttype"), QString::number(rtbMapObject->objectType()));
+    atts.append(QLatin1String("originid"), QString::number(rtbMapObject->originID()));
+
+    switch (rtbMapObject->objectType()) {
+    case RTBMapObject::CustomFloorTrap:
+    {
+        const RTBCustomFloorTrap *mapObject = static_cast<const RTBCustomFloorTrap*>(rtbMapObject);
+        atts.append(QLatin1String("intervalspeed"), QString::number(mapObject->intervalSpeed()));
+        atts.append(QLatin1String("intervaloffset"), QString::number(mapObject->intervalOffset()));
+        break;
+    }
+    case RTBMapObject::MovingFloorTrapSpawner:
+    {
+        const RTBMovingFloorTrapSpawner *mapObject = static_cast<const RTBMovingFloorTrapSpawner*>(rtbMapObject);
+        atts.append(QLatin1String("spawnamount"), QString::number(mapObject->spawnAmount()));
+        atts.append(QLatin1String("intervalspeed"), QString::number(mapObject->intervalSpeed()));
+        atts.append(QLatin1String("randomizestart"), QString::number(mapObject->randomizeStart()));
+        break;
+    }
+    case RTBMapObject::Button:
+    {
+        const RTBButtonObject *mapObject = static_cast<const RTBButtonObject*>(rtbMapObject);
+        atts.append(QLatin1String("beatsactive"), QString::number(mapObject->beatsActive()));
+        atts.append(QLatin1String("laserbeamtargets"), mapObject->laserBeamTargets());
+        break;
+    }
+    case RTBMapObject::LaserBeam:
+    {
+        const RTBLaserBeam *mapObject = static_cast<const RTBLaserBeam*>(rtbMapObject);
+        atts.append(QLatin1String("beamtype"), QString::number(mapObject->beamType()));
+        atts.append(QLatin1String("activatedonstart"), QString::number(mapObject->activatedOnStart()));
+        atts.append(QLatin1String("directiondegrees"), QString::number(mapObject->directionDegrees()));
+        atts.append(QLatin1String("targetdirectiondegrees"), QString::number(mapObject->targetDirectionDegrees()));
+        atts.append(QLatin1String("intervaloffset"), QString::number(mapObject->intervalOffset()));
+        atts.append(QLatin1String("intervalspeed"), QString::number(mapObject->intervalSpeed()));
+        break;
+    }
+    case RTBMapObject::ProjectileTurret:
+    {
+        const RTBProjectileTurret *mapObject = static_cast<const RTBProjectileTurret*>(rtbMapObject);
+        atts.append(QLatin1String("intervalspeed"), QString::number(mapObject->intervalSpeed()));
+        atts.append(QLatin1String("intervaloffset"), QString::number(mapObject->intervalOffset()));
+        atts.append(QLatin1String("projectilespeed"), QString::number(mapObject->projectileSpeed()));
+        atts.append(QLatin1String("shotdirection"), QString::number(mapObject->shotDirection()));
+        break;
+    }
+    case RTBMapObject::Teleporter:
+    {
+        const RTBTeleporter *mapObject = static_cast<const RTBTeleporter*>(rtbMapObject);
+        atts.append(QLatin1String("teleportertarget"), mapObject->teleporterTarget());
+        break;
+    }
+    case RTBMapObject::Target:
+    {
+        return atts;
+    }
+    case RTBMapObject::FloorText:
+    {
+        const RTBFloorText *mapObject = static_cast<const RTBFloorText*>(rtbMapObject);
+        atts.append(QLatin1String("text"), mapObject->text());
+        atts.append(QLatin1String("maxcharacters"), QString::number(mapObject->maxCharacters()));
+        atts.append(QLatin1String("triggerzonewidth"), QString::number(mapObject->triggerZoneSize().width()));
+        atts.append(QLatin1String("triggerzoneheight"), QString::number(mapObject->triggerZoneSize().height()));
+        atts.append(QLatin1String("usetrigger"), QString::number(mapObject->useTrigger()));
+        atts.append(QLatin1String("scale"), QString::number(mapObject->scale()));
+        atts.append(QLatin1String("offsetx"), QString::number(mapObject->offsetX()));
+        atts.append(QLatin1String("offsety"), QString::number(mapObject->offsetY()));
+        break;
+    }
+    case RTBMapObject::CameraTrigger:
+    {
+        const RTBCameraTrigger *mapObject = static_cast<const RTBCameraTrigger*>(rtbMapObject);
+        atts.append(QLatin1String("cameratarget"), mapObject->target());
+        atts.append(QLatin1String("cameratriggerzonewidth"), QString::number(mapObject->triggerZoneSize().width()));
+        atts.append(QLatin1String("cameratriggerzoneheight"), QString::number(mapObject->triggerZoneSize().height()));
+        atts.append(QLatin1String("cameraheight"), QString::number(mapObject->cameraHeight()));
+        atts.append(QLatin1String("cameraangle"), QString::number(mapObject->cameraAngle()));
+        break;
+    }
+    case RTBMapObject::StartLocation:
+    {
+        return atts;
+    }
+    case RTBMapObject::FinishHole:
+    {
+        return atts;
+    }
+    case RTBMapObject::NPCBallSpawner:
+    {
+        const RTBNPCBallSpawner *mapObject = static_cast<const RTBNPCBallSpawner*>(rtbMapObject);
+        atts.append(QLatin1String("spawnclass"), QString::number(mapObject->spawnClass()));
+        atts.append(QLatin1String("size"), QString::number(mapObject->size()));
+        atts.append(QLatin1String("intervaloffset"), QString::number(mapObject->intervalOffset()));
+        atts.append(QLatin1String("spawnfrequency"), QString::number(mapObject->spawnFrequency()));
+        atts.append(QLatin1String("speed"), QString::number(mapObject->speed()));
+        atts.append(QLatin1String("direction"), QString::number(mapObject->direction()));
+        break;
+    }
+    default:
+
+        return atts;
+    }
+
+    return atts;
+}
+
+void readRTBMapAttributes(RTBMap *rtbMap, const QXmlStreamAttributes &atts)
+{
+    const bool error = atts.value(QLatin1String("haserror")).toString().toInt();
+    QStringRef customGlowColorString = atts.value(QLatin1String("customglowcolor"));
+    QStringRef customBackgroundColorString = atts.value(QLatin1String("custombackgroundcolor"));
+    const double levelBrightness = atts.value(QLatin1String("levelbrightness")).toString().toDouble();
+    const double cloudDensity = atts.value(QLatin1String("clouddensity")).toString().toDouble();
+    const double cloudVelocity = atts.value(QLatin1String("cloudvelocity")).toString().toDouble();
+    const double cloudAlpha = atts.value(QLatin1String("cloudalpha")).toString().toDouble();
+    const double snowDensity = atts.value(QLatin1String("snowdensity")).toString().toDouble();
+    const double snowVelocity = atts.value(QLatin1String("snowvelocity")).toString().toDouble();
+    const double snowRisingVelocity = atts.value(QLatin1String("snowrisingvelocity")).toString().toDouble();
+    const double cameraGrain = atts.value(QLatin1String("cameragrain")).toString().toDouble();
+    const double cameraContrast = atts.value(QLatin1String("cameracontrast")).toString().toDouble();
+    const double cameraSaturation = atts.value(QLatin1String("camerasaturation")).toString().toDouble();
+    const double cameraGlow = atts.value(QLatin1String("cameraglow")).toString().toDouble();
+    const bool hasWalls = atts.value(QLatin1String("haswalls")).toString().toInt();
+    const QString levelName = atts.value(QLatin1String("levelname")).toString();
+    const QString levelDescription = atts.value(QLatin1String("leveldescription")).toString();
+    const int backgroundColorScheme = atts.value(QLatin1String("backgroundcolorscheme")).toString().toInt();
+    const int glowColorScheme = atts.value(QLatin1String("glowcolorscheme")).toString().toInt();
+    const int chapter = atts.value(QLatin1String("chapter")).toString().toInt();
+    const bool hasStarfield = atts.value(QLatin1String("hasstarfield")).toString().toInt();
+    const int difficulty = atts.value(QLatin1String("difficulty")).toString().toInt();
+    const int playStyle = atts.value(QLatin1String("playstyle")).toString().toInt();
+    const int workShopId = atts.value(QLatin1String("workshopid")).toString().toInt();
+    const QString previewImagePath = atts.value(QLatin1String("previewimagepath")).toString();
+
+    rtbMap->setHasError(error);
+    if (!customGlowColorString.isEmpty())
+        rtbMap->setCustomGlowColor(QColor(customGlowColorString.toString()));
+    if (!customBackgroundColorString.isEmpty())
+        rtbMap->setCustomBackgroundColor(QColor(customBackgroundColorString.toString()));
+    rtbMap->setLevelBrightness(levelBrightness);
+    rtbMap->setCloudDensity(cloudDensity);
+    rtbMap->setCloudVelocity(cloudVelocity);
+    rtbMap->setCloudAlpha(cloudAlpha);
+    rtbMap->setSnowDensity(snowDensity);
+    rtbMap->setSnowVelocity(snowVelocity);
+    rtbMap->setSnowRisingVelocity(snowRisingVelocity);
+    rtbMap->setCameraGrain(cameraGrain);
+    rtbMap->setCameraContrast(cameraContrast);
+    rtbMap->setCameraSaturation(cameraSaturation);
+    rtbMap->setCameraGlow(cameraGlow);
+    rtbMap->setHasWall(hasWalls);
+    rtbMap->setLevelName(levelName);
+    rtbMap->setLevelDescription(levelDescription);
+    rtbMap->setBackgroundColorScheme(backgroundColorScheme);
+    rtbMap->setGlowColorScheme(glowColorScheme);
+    rtbMap->setChapter(chapter);
+    rtbMap->setHasStarfield(hasStarfield);
+    rtbMap->setDifficulty(difficulty);
+    rtbMap->setPlayStyle(playStyle);
+    rtbMap->setWorkShopId(workShopId);
+    rtbMap->setPreviewImagePath(previewImagePath);
+}
+
+RTBMapObject *rtbMapObjectFromAttributes(const QXmlStreamAttributes &atts)
+{
+    const int type = atts.value(QLatin1String("objecttype")).toString().toInt();
+    const int originID = atts.value(QLatin1String("originid")).toString().toInt();
+
+    switch (type) {
+    case RTBMapObject::CustomFloorTrap:
+    {
+        const int intervalSpeed = atts.value(QLatin1String("intervalspeed")).toString().toInt();
+        const int intervalOffset = atts.value(QLatin1String("intervaloffset")).toString().toInt();
+
+        RTBCustomFloorTrap *mapObject = new RTBCustomFloorTrap;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        mapObject->setIntervalSpeed(intervalSpeed);
+        mapObject->setIntervalOffset(intervalOffset);
+
+        return mapObject;
+    }
+    case RTBMapObject::MovingFloorTrapSpawner:
+    {
+        const int spawnAmount = atts.value(QLatin1String("spawnamount")).toString().toInt();
+        const int intervalSpeed = atts.value(QLatin1String("intervalspeed")).toString().toInt();
+        const int randomizeStart = atts.value(QLatin1String("randomizestart")).toString().toInt();
+
+        RTBMovingFloorTrapSpawner *mapObject = new RTBMovingFloorTrapSpawner;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        mapObject->setSpawnAmount(spawnAmount);
+        mapObject->setIntervalSpeed(intervalSpeed);
+        mapObject->setRandomizeStart(randomizeStart);
+
+        return mapObject;
+    }
+    case RTBMapObject::Button:
+    {
+        const int beatsActive = atts.value(QLatin1String("beatsactive")).toString().toInt();
+        const QString laserBeamTargets = atts.value(QLatin1String("laserbeamtargets")).toString();
+
+        RTBButtonObject *mapObject = new RTBButtonObject;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        mapObject->setBeatsActive(beatsActive);
+        mapObject->setLaserBeamTargets(laserBeamTargets);
+
+        return mapObject;
+    }
+    case RTBMapObject::LaserBeam:
+    {
+        const int beamType = atts.value(QLatin1String("beamtype")).toString().toInt();
+        const int activatedOnStart = atts.value(QLatin1String("activatedonstart")).toString().toInt();
+        const int directionDegrees = atts.value(QLatin1String("directiondegrees")).toString().toInt();
+        const int targetDirectionDegrees = atts.value(QLatin1String("targetdirectiondegrees")).toString().toInt();
+        const int intervalOffset = atts.value(QLatin1String("intervaloffset")).toString().toInt();
+        const int intervalSpeed = atts.value(QLatin1String("intervalspeed")).toString().toInt();
+
+        RTBLaserBeam *mapObject = new RTBLaserBeam;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        mapObject->setBeamType(beamType);
+        mapObject->setActivatedOnStart(activatedOnStart);
+        mapObject->setDirectionDegrees(directionDegrees);
+        mapObject->setTargetDirectionDegrees(targetDirectionDegrees);
+        mapObject->setIntervalOffset(intervalOffset);
+        mapObject->setIntervalSpeed(intervalSpeed);
+
+        return mapObject;
+    }
+    case RTBMapObject::ProjectileTurret:
+    {
+        const int intervalSpeed = atts.value(QLatin1String("intervalspeed")).toString().toInt();
+        const int intervalOffset = atts.value(QLatin1String("intervaloffset")).toString().toInt();
+        const int projectileSpeed = atts.value(QLatin1String("projectilespeed")).toString().toInt();
+        const int shotDirection = atts.value(QLatin1String("shotdirection")).toString().toInt();
+
+        RTBProjectileTurret *mapObject = new RTBProjectileTurret;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        mapObject->setIntervalSpeed(intervalSpeed);
+        mapObject->setIntervalOffset(intervalOffset);
+        mapObject->setProjectileSpeed(projectileSpeed);
+        mapObject->setShotDirection(shotDirection);
+
+        return mapObject;
+    }
+    case RTBMapObject::Teleporter:
+    {
+        const QString target = atts.value(QLatin1String("teleportertarget")).toString();
+
+        RTBTeleporter *mapObject = new RTBTeleporter;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        mapObject->setTeleporterTarget(target);
+
+        return mapObject;
+    }
+    case RTBMapObject::Target:
+    {
+        RTBTarget *mapObject = new RTBTarget;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        return mapObject;
+    }
+    case RTBMapObject::FloorText:
+    {
+        const QString text = atts.value(QLatin1String("text")).toString();
+        const int maxCharacters = atts.value(QLatin1String("maxcharacters")).toString().toInt();
+        const qreal triggerZoneWidth = atts.value(QLatin1String("triggerzonewidth")).toString().toDouble();
+        const qreal triggerZoneHeight = atts.value(QLatin1String("triggerzoneheight")).toString().toDouble();
+        const int useTrigger = atts.value(QLatin1String("usetrigger")).toString().toInt();
+        const double scale = atts.value(QLatin1String("scale")).toString().toDouble();
+        const double offsetX = atts.value(QLatin1String("offsetx")).toString().toDouble();
+        const double offsetY = atts.value(QLatin1String("offsety")).toString().toDouble();
+
+        RTBFloorText *mapObject = new RTBFloorText;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        mapObject->setText(text);
+        mapObject->setMaxCharacters(maxCharacters);
+        mapObject->setTriggerZoneSize(QSizeF(triggerZoneWidth, triggerZoneHeight));
+        mapObject->setUseTrigger(useTrigger);
+        mapObject->setScale(scale);
+        mapObject->setOffsetX(offsetX);
+        mapObject->setOffsetY(offsetY);
+
+        return mapObject;
+    }
+    case RTBMapObject::CameraTrigger:
+    {
+        const QString target = atts.value(QLatin1String("cameratarget")).toString();
+        const qreal triggerZoneWidth = atts.value(QLatin1String("cameratriggerzonewidth")).toString().toDouble();
+        const qreal triggerZoneHeight = atts.value(QLatin1String("cameratriggerzoneheight")).toString().toDouble();
+        const int cameraHeight = atts.value(QLatin1String("cameraheight")).toString().toInt();
+        const int cameraAngle = atts.value(QLatin1String("cameraangle")).toString().toInt();
+
+        RTBCameraTrigger *mapObject = new RTBCameraTrigger;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        mapObject->setTarget(target);
+        mapObject->setTriggerZoneSize(QSizeF(triggerZoneWidth, triggerZoneHeight));
+        mapObject->setCameraHeight(cameraHeight);
+        mapObject->setCameraAngle(cameraAngle);
+
+        return mapObject;
+    }
+    case RTBMapObject::StartLocation:
+    {
+        RTBStartLocation *mapObject = new RTBStartLocation;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        return mapObject;
+    }
+    case RTBMapObject::FinishHole:
+    {
+        RTBFinishHole *mapObject = new RTBFinishHole;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        return mapObject;
+    }
+    case RTBMapObject::NPCBallSpawner:
+    {
+        const int spawnClass = atts.value(QLatin1String("spawnclass")).toString().toInt();
+        const int size = atts.value(QLatin1String("size")).toString().toInt();
+        const int intervalOffset = atts.value(QLatin1String("intervaloffset")).toString().toInt();
+        const int spawnFrequency = atts.value(QLatin1String("spawnfrequency")).toString().toInt();
+        const int speed = atts.value(QLatin1String("speed")).toString().toInt();
+        const int direction = atts.value(QLatin1String("direction")).toString().toInt();
+
+        RTBNPCBallSpawner *mapObject = new RTBNPCBallSpawner;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        mapObject->setSpawnClass(spawnClass);
+        mapObject->setSize(size);
+        mapObject->setIntervalOffset(intervalOffset);
+        mapObject->setSpawnFrequency(spawnFrequency);
+        mapObject->setSpeed(speed);
+        mapObject->setDirection(direction);
+
+        return mapObject;
+    }
+
+    // ORBS
+    case RTBMapObject::Orb:
+    {
+        RTBOrb *mapObject = new RTBOrb;
+        mapObject->setObjectType(type);
+        mapObject->setOriginID(originID);
+        return mapObject;
+    }
+    default:
+
+        return 0;
+    }
+}
+
+} // namespace Internal
+} // namespace Tiled
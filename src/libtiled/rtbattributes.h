@@ -0,0 +1,47 @@
+/*
+ * rtbattributes.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RTBATTRIBUTES_H
+#define RTBATTRIBUTES_H
+
+#include <QXmlStreamAttributes>
+
+namespace Tiled {
+
+class RTBMap;
+class RTBMapObject;
+
+namespace Internal {
+
+/**
+ * The RTB map and object properties are stored as a set of named attributes.
+ * These functions convert between the properties and those attributes, so
+ * that the map formats store them consistently.
+ */
+QXmlStreamAttributes rtbMapAttributes(const RTBMap *rtbMap);
+void readRTBMapAttributes(RTBMap *rtbMap, const QXmlStreamAttributes &atts);
+
+QXmlStreamAttributes rtbMapObjectAttributes(const RTBMapObject *rtbMapObject);
+RTBMapObject *rtbMapObjectFromAttributes(const QXmlStreamAttributes &atts);
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // RTBATTRIBUTES_H
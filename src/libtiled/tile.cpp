@@ -118,6 +118,18 @@ void Tile::setTerrain(unsigned terrain)
     mTileset->markTerrainDistancesDirty();
 }
 
+/**
+ * Set the probability of this terrain type appearing while painting (0-100%).
+ */
+void Tile::setTerrainProbability(float probability)
+{
+    if (mTerrainProbability == probability)
+        return;
+
+    mTerrainProbability = probability;
+    mTileset->markTerrainIndexDirty();
+}
+
 /**
  * Sets \a objectGroup to be the group of objects associated with this tile.
  * The Tile takes ownership over the ObjectGroup and it can't also be part of
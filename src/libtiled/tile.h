@@ -233,14 +233,6 @@ inline float Tile::terrainProbability() const
     return mTerrainProbability;
 }
 
-/**
- * Set the probability of this terrain type appearing while painting (0-100%).
- */
-inline void Tile::setTerrainProbability(float probability)
-{
-    mTerrainProbability = probability;
-}
-
 /**
  * @return The group of objects associated with this tile. This is generally
  *         expected to be used for editing collision shapes.
@@ -32,12 +32,15 @@
 #include "map.h"
 #include "tile.h"
 
+#include <algorithm>
+
 using namespace Tiled;
 
 TileLayer::TileLayer(const QString &name, int x, int y, int width, int height):
     Layer(TileLayerType, name, x, y, width, height),
     mMaxTileSize(0, 0),
-    mGrid(width * height)
+    mGrid(width * height),
+    mTileIndexEnabled(false)
 {
     Q_ASSERT(width >= 0);
     Q_ASSERT(height >= 0);
@@ -119,7 +122,17 @@ void TileLayer::setCell(int x, int y, const Cell &cell)
             mMap->adjustDrawMargins(drawMargins());
     }
 
-    mGrid[x + y * mWidth] = cell;
+    const int index = x + y * mWidth;
+
+    if (mTileIndexEnabled) {
+        Tile *oldTile = mGrid.at(index).tile;
+        if (oldTile != cell.tile) {
+            removeOccurrence(oldTile, index);
+            addOccurrence(cell.tile, index);
+        }
+    }
+
+    mGrid[index] = cell;
 }
 
 TileLayer *TileLayer::copy(const QRegion &region) const
@@ -207,6 +220,7 @@ void TileLayer::flip(FlipDirection direction)
     }
 
     mGrid = newGrid;
+    rebuildTileIndex();
 }
 
 void TileLayer::rotate(RotateDirection direction)
@@ -250,6 +264,7 @@ void TileLayer::rotate(RotateDirection direction)
     mWidth = newWidth;
     mHeight = newHeight;
     mGrid = newGrid;
+    rebuildTileIndex();
 }
 
 
@@ -266,6 +281,15 @@ QSet<SharedTileset> TileLayer::usedTilesets() const
 
 bool TileLayer::referencesTileset(const Tileset *tileset) const
 {
+    if (mTileIndexEnabled) {
+        QHashIterator<Tile*, QSet<int> > it(mTileOccurrences);
+        while (it.hasNext()) {
+            if (it.next().key()->tileset() == tileset)
+                return true;
+        }
+        return false;
+    }
+
     for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
         const Tile *tile = mGrid.at(i).tile;
         if (tile && tile->tileset() == tileset)
@@ -276,6 +300,20 @@ bool TileLayer::referencesTileset(const Tileset *tileset) const
 
 void TileLayer::removeReferencesToTileset(Tileset *tileset)
 {
+    if (mTileIndexEnabled) {
+        QMutableHashIterator<Tile*, QSet<int> > it(mTileOccurrences);
+        while (it.hasNext()) {
+            it.next();
+            if (it.key()->tileset() != tileset)
+                continue;
+
+            foreach (int index, it.value())
+                mGrid.replace(index, Cell());
+            it.remove();
+        }
+        return;
+    }
+
     for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
         const Tile *tile = mGrid.at(i).tile;
         if (tile && tile->tileset() == tileset)
@@ -286,6 +324,32 @@ void TileLayer::removeReferencesToTileset(Tileset *tileset)
 void TileLayer::replaceReferencesToTileset(Tileset *oldTileset,
                                            Tileset *newTileset)
 {
+    if (mTileIndexEnabled) {
+        QHash<Tile*, QSet<int> > replaced;
+
+        QMutableHashIterator<Tile*, QSet<int> > it(mTileOccurrences);
+        while (it.hasNext()) {
+            it.next();
+            if (it.key()->tileset() != oldTileset)
+                continue;
+
+            Tile *newTile = newTileset->tileAt(it.key()->id());
+            foreach (int index, it.value())
+                mGrid[index].tile = newTile;
+
+            if (newTile)
+                replaced[newTile].unite(it.value());
+            it.remove();
+        }
+
+        QHashIterator<Tile*, QSet<int> > replacedIt(replaced);
+        while (replacedIt.hasNext()) {
+            replacedIt.next();
+            mTileOccurrences[replacedIt.key()].unite(replacedIt.value());
+        }
+        return;
+    }
+
     for (int i = 0, i_end = mGrid.size(); i < i_end; ++i) {
         const Tile *tile = mGrid.at(i).tile;
         if (tile && tile->tileset() == oldTileset)
@@ -293,6 +357,109 @@ void TileLayer::replaceReferencesToTileset(Tileset *oldTileset,
     }
 }
 
+void TileLayer::setTileIndexEnabled(bool enabled)
+{
+    if (mTileIndexEnabled == enabled)
+        return;
+
+    mTileIndexEnabled = enabled;
+
+    if (enabled)
+        rebuildTileIndex();
+    else
+        mTileOccurrences.clear();
+}
+
+namespace {
+
+class MatchesCell
+{
+public:
+    MatchesCell(const Cell &cell) : mCell(cell) {}
+
+    bool operator() (const Cell &cell) const { return cell == mCell; }
+
+private:
+    Cell mCell;
+};
+
+} // anonymous namespace
+
+QRegion TileLayer::cellRegion(const Cell &cell) const
+{
+    if (!mTileIndexEnabled || cell.isEmpty())
+        return region(MatchesCell(cell));
+
+    const QSet<int> occurrences = mTileOccurrences.value(cell.tile);
+    if (occurrences.isEmpty())
+        return QRegion();
+
+    QVector<int> indexes;
+    indexes.reserve(occurrences.size());
+    foreach (int index, occurrences)
+        if (mGrid.at(index) == cell)
+            indexes.append(index);
+
+    std::sort(indexes.begin(), indexes.end());
+
+    // Sorted cell indexes translate to y-x sorted spans of height 1, which
+    // allows setting up the region in one go.
+    QVector<QRect> rects;
+
+    for (int i = 0, i_end = indexes.size(); i < i_end; ++i) {
+        const int start = indexes.at(i);
+        const int y = start / mWidth;
+        const int rowEnd = (y + 1) * mWidth;
+
+        int end = start + 1;
+        while (i + 1 < i_end && indexes.at(i + 1) == end && end < rowEnd) {
+            ++end;
+            ++i;
+        }
+
+        rects.append(QRect(start - y * mWidth + mX, y + mY, end - start, 1));
+    }
+
+    QRegion region;
+    if (!rects.isEmpty())
+        region.setRects(rects.constData(), rects.size());
+    return region;
+}
+
+void TileLayer::addOccurrence(Tile *tile, int index)
+{
+    if (tile)
+        mTileOccurrences[tile].insert(index);
+}
+
+void TileLayer::removeOccurrence(Tile *tile, int index)
+{
+    if (!tile)
+        return;
+
+    QHash<Tile*, QSet<int> >::iterator it = mTileOccurrences.find(tile);
+    if (it == mTileOccurrences.end())
+        return;
+
+    it.value().remove(index);
+    if (it.value().isEmpty())
+        mTileOccurrences.erase(it);
+}
+
+/**
+ * Rebuilds the tile occurrence index, when enabled. Needs to be called after
+ * modifying the grid other than through setCell().
+ */
+void TileLayer::rebuildTileIndex()
+{
+    if (!mTileIndexEnabled)
+        return;
+
+    mTileOccurrences.clear();
+    for (int i = 0, i_end = mGrid.size(); i < i_end; ++i)
+        addOccurrence(mGrid.at(i).tile, i);
+}
+
 void TileLayer::resize(const QSize &size, const QPoint &offset)
 {
     if (this->size() == size && offset.isNull())
@@ -315,6 +482,7 @@ void TileLayer::resize(const QSize &size, const QPoint &offset)
 
     mGrid = newGrid;
     setSize(size);
+    rebuildTileIndex();
 }
 
 void TileLayer::offset(const QPoint &offset,
@@ -360,6 +528,7 @@ void TileLayer::offset(const QPoint &offset,
     }
 
     mGrid = newGrid;
+    rebuildTileIndex();
 }
 
 bool TileLayer::canMergeWith(Layer *other) const
@@ -383,7 +552,7 @@ Layer *TileLayer::mergedWith(Layer *other) const
 
 QRegion TileLayer::computeDiffRegion(const TileLayer *other) const
 {
-    QRegion ret;
+    QVector<QRect> rects;
 
     const int dx = other->x() - mX;
     const int dy = other->y() - mY;
@@ -399,11 +568,14 @@ QRegion TileLayer::computeDiffRegion(const TileLayer *other) const
                     ++x;
                 }
                 const int rangeEnd = x;
-                ret += QRect(rangeStart, y, rangeEnd - rangeStart, 1);
+                rects.append(QRect(rangeStart, y, rangeEnd - rangeStart, 1));
             }
         }
     }
 
+    QRegion ret;
+    if (!rects.isEmpty())
+        ret.setRects(rects.constData(), rects.size());
     return ret;
 }
 
@@ -35,7 +35,9 @@
 #include "layer.h"
 #include "tiled.h"
 
+#include <QHash>
 #include <QMargins>
+#include <QSet>
 #include <QString>
 #include <QVector>
 #include <QSharedPointer>
@@ -231,6 +233,28 @@ public:
      */
     void replaceReferencesToTileset(Tileset *oldTileset, Tileset *newTileset);
 
+    /**
+     * Enables or disables the tile occurrence index. While enabled, the layer
+     * keeps track of the cells referring to each tile, which makes
+     * cellRegion() and the tileset reference functions proportional to the
+     * number of occurrences instead of the size of the layer.
+     *
+     * The index is not copied along when the layer is cloned.
+     */
+    void setTileIndexEnabled(bool enabled);
+
+    bool isTileIndexEnabled() const { return mTileIndexEnabled; }
+
+    /**
+     * Returns the region of cells that are equal to the given \a cell. Like
+     * region(), the returned region takes into account the position of the
+     * layer.
+     *
+     * Uses the tile occurrence index when enabled, otherwise falls back to
+     * checking every cell.
+     */
+    QRegion cellRegion(const Cell &cell) const;
+
     /**
      * Resizes this tile layer to \a size, while shifting all tiles by
      * \a offset.
@@ -268,16 +292,25 @@ protected:
     TileLayer *initializeClone(TileLayer *clone) const;
 
 private:
+    void addOccurrence(Tile *tile, int index);
+    void removeOccurrence(Tile *tile, int index);
+    void rebuildTileIndex();
+
     QSize mMaxTileSize;
     QMargins mOffsetMargins;
     QVector<Cell> mGrid;
+
+    bool mTileIndexEnabled;
+    QHash<Tile*, QSet<int> > mTileOccurrences;
 };
 
 
 template<typename Condition>
 QRegion TileLayer::region(Condition condition) const
 {
-    QRegion region;
+    // The spans are collected in y-x order and never touch each other, so
+    // the region can be set up in one go.
+    QVector<QRect> rects;
 
     for (int y = 0; y < mHeight; ++y) {
         for (int x = 0; x < mWidth; ++x) {
@@ -286,8 +319,8 @@ QRegion TileLayer::region(Condition condition) const
                 for (++x; x <= mWidth; ++x) {
                     if (x == mWidth || !condition(cellAt(x, y))) {
                         const int rangeEnd = x;
-                        region += QRect(rangeStart + mX, y + mY,
-                                        rangeEnd - rangeStart, 1);
+                        rects.append(QRect(rangeStart + mX, y + mY,
+                                           rangeEnd - rangeStart, 1));
                         break;
                     }
                 }
@@ -295,6 +328,9 @@ QRegion TileLayer::region(Condition condition) const
         }
     }
 
+    QRegion region;
+    if (!rects.isEmpty())
+        region.setRects(rects.constData(), rects.size());
     return region;
 }
 
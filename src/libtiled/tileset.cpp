@@ -28,11 +28,16 @@
  */
 
 #include "tileset.h"
+
+#include "imagecache.h"
+#include "objectgroup.h"
 #include "tile.h"
 #include "terrain.h"
 
 #include <QBitmap>
 
+#include <climits>
+
 using namespace Tiled;
 
 Tileset::~Tileset()
@@ -93,6 +98,7 @@ bool Tileset::loadFromImage(const QImage &image,
                 mTiles.at(tileNum)->setImage(tilePixmap);
             } else {
                 mTiles.append(new Tile(tilePixmap, tileNum, this));
+                mTerrainIndexDirty = true;
             }
             ++tileNum;
         }
@@ -113,6 +119,15 @@ bool Tileset::loadFromImage(const QImage &image,
     return true;
 }
 
+/**
+ * Convenience override that loads the image through the process-wide
+ * ImageCache.
+ */
+bool Tileset::loadFromImage(const QString &fileName)
+{
+    return loadFromImage(ImageCache::instance()->image(fileName), fileName);
+}
+
 SharedTileset Tileset::findSimilarTileset(const QVector<SharedTileset> &tilesets) const
 {
     foreach (const SharedTileset &candidate, tilesets) {
@@ -128,6 +143,44 @@ SharedTileset Tileset::findSimilarTileset(const QVector<SharedTileset> &tilesets
     return SharedTileset();
 }
 
+SharedTileset Tileset::clone() const
+{
+    SharedTileset c = create(mName, mTileWidth, mTileHeight,
+                             mTileSpacing, mMargin);
+    c->setProperties(properties());
+    c->mFileName = mFileName;
+    c->mImageSource = mImageSource;
+    c->mTransparentColor = mTransparentColor;
+    c->mTileOffset = mTileOffset;
+    c->mImageWidth = mImageWidth;
+    c->mImageHeight = mImageHeight;
+    c->mColumnCount = mColumnCount;
+
+    foreach (const Terrain *terrain, mTerrainTypes) {
+        Terrain *terrainClone = new Terrain(terrain->id(), c.data(),
+                                            terrain->name(),
+                                            terrain->imageTileId());
+        terrainClone->setProperties(terrain->properties());
+        terrainClone->mTransitionDistance = terrain->mTransitionDistance;
+        c->mTerrainTypes.append(terrainClone);
+    }
+    c->mTerrainDistancesDirty = mTerrainDistancesDirty;
+
+    foreach (const Tile *tile, mTiles) {
+        Tile *tileClone = new Tile(tile->image(), tile->imageSource(),
+                                   tile->id(), c.data());
+        tileClone->setProperties(tile->properties());
+        tileClone->mTerrain = tile->mTerrain;
+        tileClone->mTerrainProbability = tile->mTerrainProbability;
+        tileClone->mFrames = tile->mFrames;
+        if (tile->objectGroup())
+            tileClone->mObjectGroup = static_cast<ObjectGroup*>(tile->objectGroup()->clone());
+        c->mTiles.append(tileClone);
+    }
+
+    return c;
+}
+
 int Tileset::columnCountForWidth(int width) const
 {
     Q_ASSERT(mTileWidth > 0);
@@ -169,6 +222,7 @@ void Tileset::insertTerrain(int index, Terrain *terrain)
     }
 
     mTerrainDistancesDirty = true;
+    mTerrainIndexDirty = true;
 }
 
 Terrain *Tileset::takeTerrainAt(int index)
@@ -191,6 +245,7 @@ Terrain *Tileset::takeTerrainAt(int index)
     }
 
     mTerrainDistancesDirty = true;
+    mTerrainIndexDirty = true;
 
     return terrain;
 }
@@ -213,6 +268,88 @@ int Tileset::terrainTransitionPenalty(int terrainType0, int terrainType1) const
     return mTerrainTypes.at(terrainType0)->transitionDistance(terrainType1);
 }
 
+const TerrainCandidates &Tileset::terrainCandidates(unsigned terrain,
+                                                    unsigned considerationMask) const
+{
+    if (mTerrainIndexDirty) {
+        mTilesByTerrain.clear();
+        mTerrainCandidates.clear();
+        mTerrainIndexDirty = false;
+    }
+
+    const quint64 key = (quint64(considerationMask) << 32) | terrain;
+
+    QHash<quint64, TerrainCandidates>::iterator it = mTerrainCandidates.find(key);
+    if (it != mTerrainCandidates.end())
+        return it.value();
+
+    QList<Tile*> matches;
+    int penalty = INT_MAX;
+
+    foreach (Tile *t, tilesMatchingTerrain(terrain & considerationMask,
+                                           considerationMask)) {
+        // calculate the tile transition penalty based on shortest distance to target terrain type
+        int tr = terrainTransitionPenalty(t->terrain() >> 24, terrain >> 24);
+        int tl = terrainTransitionPenalty((t->terrain() >> 16) & 0xFF, (terrain >> 16) & 0xFF);
+        int br = terrainTransitionPenalty((t->terrain() >> 8) & 0xFF, (terrain >> 8) & 0xFF);
+        int bl = terrainTransitionPenalty(t->terrain() & 0xFF, terrain & 0xFF);
+
+        // if there is no path to the destination terrain, this isn't a useful transition
+        if (tr < 0 || tl < 0 || br < 0 || bl < 0)
+            continue;
+
+        // add tile to the candidate list
+        int transitionPenalty = tr + tl + br + bl;
+        if (transitionPenalty <= penalty) {
+            if (transitionPenalty < penalty)
+                matches.clear();
+            penalty = transitionPenalty;
+
+            matches.append(t);
+        }
+    }
+
+    TerrainCandidates candidates;
+    float sum = 0.f;
+    foreach (Tile *t, matches) {
+        const float probability = t->terrainProbability();
+        if (probability > 0.f) {
+            sum += probability;
+            candidates.tiles.append(t);
+            candidates.cumulativeProbabilities.append(sum);
+        }
+    }
+
+    return mTerrainCandidates.insert(key, candidates).value();
+}
+
+/**
+ * Returns the tiles whose terrain, masked with \a considerationMask, equals
+ * \a maskedTerrain. The tiles are grouped by masked terrain once for each
+ * mask that is looked up.
+ */
+const QList<Tile*> &Tileset::tilesMatchingTerrain(unsigned maskedTerrain,
+                                                  unsigned considerationMask) const
+{
+    QHash<unsigned, QHash<unsigned, QList<Tile*> > >::iterator it =
+            mTilesByTerrain.find(considerationMask);
+
+    if (it == mTilesByTerrain.end()) {
+        QHash<unsigned, QList<Tile*> > tilesByTerrain;
+        foreach (Tile *tile, mTiles)
+            tilesByTerrain[tile->terrain() & considerationMask].append(tile);
+
+        it = mTilesByTerrain.insert(considerationMask, tilesByTerrain);
+    }
+
+    static const QList<Tile*> noTiles;
+
+    QHash<unsigned, QList<Tile*> >::const_iterator tilesIt =
+            it.value().constFind(maskedTerrain);
+
+    return tilesIt == it.value().constEnd() ? noTiles : tilesIt.value();
+}
+
 void Tileset::recalculateTerrainDistances()
 {
     // some fancy macros which can search for a value in each byte of a word simultaneously
@@ -305,6 +442,7 @@ Tile *Tileset::addTile(const QPixmap &image, const QString &source)
 {
     Tile *newTile = new Tile(image, source, tileCount(), this);
     mTiles.append(newTile);
+    mTerrainIndexDirty = true;
     if (mTileHeight < image.height())
         mTileHeight = image.height();
     if (mTileWidth < image.width())
@@ -322,6 +460,7 @@ void Tileset::insertTiles(int index, const QList<Tile *> &tiles)
     for (int i = index + count; i < mTiles.size(); ++i)
         mTiles.at(i)->mId += count;
 
+    mTerrainIndexDirty = true;
     updateTileSize();
 }
 
@@ -336,6 +475,7 @@ void Tileset::removeTiles(int index, int count)
     for (; last != mTiles.end(); ++last)
         (*last)->mId -= count;
 
+    mTerrainIndexDirty = true;
     updateTileSize();
 }
 
@@ -33,6 +33,7 @@
 #include "object.h"
 
 #include <QColor>
+#include <QHash>
 #include <QList>
 #include <QVector>
 #include <QPoint>
@@ -50,6 +51,18 @@ class Terrain;
 
 typedef QSharedPointer<Tileset> SharedTileset;
 
+/**
+ * The tiles that are the best match for a certain terrain, as looked up by
+ * Tileset::terrainCandidates(). Only tiles with a positive terrain
+ * probability are included, along with the running sum of their
+ * probabilities to allow for a quick weighted random pick.
+ */
+struct TerrainCandidates
+{
+    QVector<Tile*> tiles;
+    QVector<float> cumulativeProbabilities;
+};
+
 /**
  * A tileset, representing a set of tiles.
  *
@@ -99,7 +112,8 @@ private:
         mImageWidth(0),
         mImageHeight(0),
         mColumnCount(0),
-        mTerrainDistancesDirty(false)
+        mTerrainDistancesDirty(false),
+        mTerrainIndexDirty(true)
     {
         Q_ASSERT(tileSpacing >= 0);
         Q_ASSERT(margin >= 0);
@@ -226,6 +240,12 @@ public:
      */
     SharedTileset findSimilarTileset(const QVector<SharedTileset> &tilesets) const;
 
+    /**
+     * Returns a copy of this tileset, including its tiles and terrain types.
+     * The copy keeps the file name, so that it is saved the same way.
+     */
+    SharedTileset clone() const;
+
     /**
      * Returns the file name of the external image that contains the tiles in
      * this tileset. Is an empty string when this tileset doesn't have a
@@ -280,6 +300,17 @@ public:
      */
     int terrainTransitionPenalty(int terrainType0, int terrainType1) const;
 
+    /**
+     * Returns the tiles that match \a terrain in the corners selected by
+     * \a considerationMask, and have the lowest transition penalty towards
+     * \a terrain in all corners.
+     *
+     * The results are cached in a terrain index, which is built lazily and
+     * reset when the terrain information or the tiles of this tileset change.
+     */
+    const TerrainCandidates &terrainCandidates(unsigned terrain,
+                                               unsigned considerationMask) const;
+
     Tile *addTile(const QPixmap &image, const QString &source = QString());
 
     void insertTiles(int index, const QList<Tile*> &tiles);
@@ -294,7 +325,16 @@ public:
     /**
      * Used by the Tile class when its terrain information changes.
      */
-    void markTerrainDistancesDirty() { mTerrainDistancesDirty = true; }
+    void markTerrainDistancesDirty()
+    {
+        mTerrainDistancesDirty = true;
+        mTerrainIndexDirty = true;
+    }
+
+    /**
+     * Used by the Tile class when its terrain probability changes.
+     */
+    void markTerrainIndexDirty() { mTerrainIndexDirty = true; }
 
     SharedTileset sharedPointer() const;
 
@@ -309,6 +349,9 @@ private:
      */
     void recalculateTerrainDistances();
 
+    const QList<Tile*> &tilesMatchingTerrain(unsigned maskedTerrain,
+                                             unsigned considerationMask) const;
+
     QString mName;
     QString mFileName;
     QString mImageSource;
@@ -325,18 +368,15 @@ private:
     QList<Terrain*> mTerrainTypes;
     bool mTerrainDistancesDirty;
 
+    // Terrain index, mapping a consideration mask and a masked terrain to
+    // the tiles having that terrain, as well as caching looked up candidates
+    mutable bool mTerrainIndexDirty;
+    mutable QHash<unsigned, QHash<unsigned, QList<Tile*> > > mTilesByTerrain;
+    mutable QHash<quint64, TerrainCandidates> mTerrainCandidates;
+
     QWeakPointer<Tileset> mWeakPointer;
 };
 
-
-/**
- * Convenience override that loads the image using the QImage constructor.
- */
-inline bool Tileset::loadFromImage(const QString &fileName)
-{
-    return loadFromImage(QImage(fileName), fileName);
-}
-
 inline SharedTileset Tileset::sharedPointer() const
 {
     return SharedTileset(mWeakPointer);
@@ -0,0 +1,85 @@
+/*
+ * tilesetcache.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tilesetcache.h"
+
+#include <QFileInfo>
+#include <QMutexLocker>
+
+using namespace Tiled;
+
+TilesetCache::TilesetCache()
+{
+}
+
+SharedTileset TilesetCache::tileset(const QString &fileName, QString *error)
+{
+    const QString key = cacheKey(fileName);
+
+    // The lock is held while reading, so that a tileset requested by several
+    // threads at once is still only read once.
+    QMutexLocker locker(&mMutex);
+
+    SharedTileset tileset = mTilesets.value(key);
+    if (tileset)
+        return tileset;
+
+    MapReader reader;
+    tileset = reader.readTileset(fileName);
+
+    if (tileset)
+        mTilesets.insert(key, tileset);
+    else
+        *error = reader.errorString();
+
+    return tileset;
+}
+
+void TilesetCache::remove(const QString &fileName)
+{
+    QMutexLocker locker(&mMutex);
+    mTilesets.remove(cacheKey(fileName));
+}
+
+void TilesetCache::clear()
+{
+    QMutexLocker locker(&mMutex);
+    mTilesets.clear();
+}
+
+int TilesetCache::size() const
+{
+    QMutexLocker locker(&mMutex);
+    return mTilesets.size();
+}
+
+QString TilesetCache::cacheKey(const QString &fileName)
+{
+    const QFileInfo fileInfo(fileName);
+    const QString canonicalPath = fileInfo.canonicalFilePath();
+    return canonicalPath.isEmpty() ? fileInfo.absoluteFilePath()
+                                   : canonicalPath;
+}
+
+SharedTileset CachedMapReader::readExternalTileset(const QString &source,
+                                                   QString *error)
+{
+    return mCache->tileset(source, error);
+}
@@ -0,0 +1,92 @@
+/*
+ * tilesetcache.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TILESETCACHE_H
+#define TILESETCACHE_H
+
+#include "mapreader.h"
+#include "tiled_global.h"
+#include "tileset.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QString>
+
+namespace Tiled {
+
+/**
+ * A thread-safe cache of external tilesets, keyed by their file name.
+ *
+ * Useful when loading many maps that share the same tilesets, so that each
+ * tileset is only read once. The tilesets are not expected to be modified
+ * while they are shared between maps.
+ */
+class TILEDSHARED_EXPORT TilesetCache
+{
+public:
+    TilesetCache();
+
+    /**
+     * Returns the tileset stored in the file \a fileName, reading it when
+     * it is not cached yet.
+     *
+     * If an error occurred, the \a error parameter is set to the error
+     * message and a null tileset is returned.
+     */
+    SharedTileset tileset(const QString &fileName, QString *error);
+
+    /**
+     * Removes the cached tileset for \a fileName, so that it is read again
+     * the next time it is requested.
+     */
+    void remove(const QString &fileName);
+
+    void clear();
+
+    int size() const;
+
+private:
+    static QString cacheKey(const QString &fileName);
+
+    mutable QMutex mMutex;
+    QHash<QString, SharedTileset> mTilesets;
+};
+
+/**
+ * A MapReader that reads external tilesets through a TilesetCache.
+ */
+class TILEDSHARED_EXPORT CachedMapReader : public MapReader
+{
+public:
+    CachedMapReader(TilesetCache *cache)
+        : mCache(cache)
+    {}
+
+protected:
+    SharedTileset readExternalTileset(const QString &source,
+                                      QString *error) override;
+
+private:
+    TilesetCache *mCache;
+};
+
+} // namespace Tiled
+
+#endif // TILESETCACHE_H
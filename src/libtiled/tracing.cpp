@@ -0,0 +1,223 @@
+/*
+ * tracing.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tracing.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSharedPointer>
+#include <QTextStream>
+#include <QThread>
+#include <QThreadStorage>
+#include <QVector>
+
+using namespace Tiled;
+
+namespace {
+
+// Number of zones kept per thread, after which the oldest are overwritten
+const int bufferCapacity = 1 << 16;
+
+struct TraceEvent
+{
+    const char *name;
+    qint64 start;
+    qint64 end;
+};
+
+struct TraceBuffer
+{
+    TraceBuffer(int threadId, const QString &threadName)
+        : events(bufferCapacity)
+        , next(0)
+        , wrapped(false)
+        , threadId(threadId)
+        , threadName(threadName)
+    {}
+
+    // Only contended while the trace is written or cleared
+    QMutex mutex;
+    QVector<TraceEvent> events;
+    int next;
+    bool wrapped;
+    const int threadId;
+    const QString threadName;
+};
+
+typedef QSharedPointer<TraceBuffer> TraceBufferPointer;
+
+struct TraceRegistry
+{
+    TraceRegistry()
+        : nextThreadId(1)
+    { clock.start(); }
+
+    QElapsedTimer clock;
+    QMutex mutex;
+    QList<TraceBufferPointer> buffers;
+    int nextThreadId;
+};
+
+TraceRegistry &registry()
+{
+    static TraceRegistry registry;
+    return registry;
+}
+
+/**
+ * The buffers are shared with the registry, so that the zones of threads that
+ * finished in the meantime still end up in the trace.
+ */
+QThreadStorage<TraceBufferPointer> threadBuffers;
+
+TraceBuffer *currentThreadBuffer()
+{
+    TraceBufferPointer &buffer = threadBuffers.localData();
+    if (!buffer) {
+        TraceRegistry &r = registry();
+        QMutexLocker locker(&r.mutex);
+
+        const int threadId = r.nextThreadId++;
+
+        QThread *thread = QThread::currentThread();
+        QString threadName = thread->objectName();
+        if (QCoreApplication *app = QCoreApplication::instance())
+            if (thread == app->thread())
+                threadName = QLatin1String("Main thread");
+        if (threadName.isEmpty())
+            threadName = QString(QLatin1String("Thread %1")).arg(threadId);
+
+        buffer = TraceBufferPointer(new TraceBuffer(threadId, threadName));
+        r.buffers.append(buffer);
+    }
+    return buffer.data();
+}
+
+QString escaped(QString string)
+{
+    string.replace(QLatin1Char('\\'), QLatin1String("\\\\"));
+    string.replace(QLatin1Char('"'), QLatin1String("\\\""));
+    return string;
+}
+
+} // anonymous namespace
+
+bool Tracer::isAvailable()
+{
+#if defined(TILED_ENABLE_TRACING)
+    return true;
+#else
+    return false;
+#endif
+}
+
+qint64 Tracer::now()
+{
+    return registry().clock.nsecsElapsed();
+}
+
+void Tracer::record(const char *name, qint64 start, qint64 end)
+{
+    TraceBuffer *buffer = currentThreadBuffer();
+    QMutexLocker locker(&buffer->mutex);
+
+    TraceEvent &event = buffer->events[buffer->next];
+    event.name = name;
+    event.start = start;
+    event.end = end;
+
+    if (++buffer->next == bufferCapacity) {
+        buffer->next = 0;
+        buffer->wrapped = true;
+    }
+}
+
+bool Tracer::writeChromeTrace(const QString &fileName, QString *error)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    QList<TraceBufferPointer> buffers;
+    {
+        TraceRegistry &r = registry();
+        QMutexLocker locker(&r.mutex);
+        buffers = r.buffers;
+    }
+
+    QTextStream out(&file);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+
+    bool first = true;
+    const qint64 pid = QCoreApplication::applicationPid();
+
+    foreach (const TraceBufferPointer &buffer, buffers) {
+        QMutexLocker locker(&buffer->mutex);
+
+        out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\""
+            << ",\"pid\":" << pid << ",\"tid\":" << buffer->threadId
+            << ",\"args\":{\"name\":\"" << escaped(buffer->threadName) << "\"}}";
+        first = false;
+
+        // Write the zones from the oldest to the most recent one
+        const int count = buffer->wrapped ? bufferCapacity : buffer->next;
+        const int begin = buffer->wrapped ? buffer->next : 0;
+
+        for (int i = 0; i < count; ++i) {
+            const TraceEvent &event = buffer->events.at((begin + i) % bufferCapacity);
+
+            // Timestamps are in microseconds
+            out << ",\n{\"name\":\"" << escaped(QString::fromLatin1(event.name)) << "\",\"ph\":\"X\""
+                << ",\"ts\":" << QString::number(event.start / 1000.0, 'f', 3)
+                << ",\"dur\":" << QString::number((event.end - event.start) / 1000.0, 'f', 3)
+                << ",\"pid\":" << pid << ",\"tid\":" << buffer->threadId << "}";
+        }
+    }
+
+    out << "\n]}\n";
+    out.flush();
+
+    if (file.error() != QFile::NoError) {
+        if (error)
+            *error = file.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+void Tracer::clear()
+{
+    TraceRegistry &r = registry();
+    QMutexLocker locker(&r.mutex);
+
+    foreach (const TraceBufferPointer &buffer, r.buffers) {
+        QMutexLocker bufferLocker(&buffer->mutex);
+        buffer->next = 0;
+        buffer->wrapped = false;
+    }
+}
@@ -0,0 +1,100 @@
+/*
+ * tracing.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACING_H
+#define TRACING_H
+
+#include "tiled_global.h"
+
+#include <QString>
+
+namespace Tiled {
+
+/**
+ * Collects timed zones into a fixed-size ring buffer per thread, and writes
+ * them out in the Chrome trace event format, to be opened in
+ * chrome://tracing or similar viewers.
+ *
+ * Zones are only recorded when the code is compiled with
+ * TILED_ENABLE_TRACING defined (qmake CONFIG+=tracing). Otherwise the
+ * TILED_TRACE macro expands to nothing and the trace stays empty.
+ */
+class TILEDSHARED_EXPORT Tracer
+{
+public:
+    /**
+     * Returns whether zones are compiled into this build.
+     */
+    static bool isAvailable();
+
+    /**
+     * Returns the number of nanoseconds passed since the tracer was first
+     * used.
+     */
+    static qint64 now();
+
+    /**
+     * Records a zone named \a name on the current thread. The name is not
+     * copied, so it should be a string literal.
+     */
+    static void record(const char *name, qint64 start, qint64 end);
+
+    /**
+     * Writes the recorded zones of all threads to \a fileName. Returns
+     * whether the file was written, setting \a error otherwise.
+     */
+    static bool writeChromeTrace(const QString &fileName, QString *error = 0);
+
+    static void clear();
+};
+
+/**
+ * Records the time between its construction and destruction as a zone.
+ */
+class TraceZone
+{
+public:
+    explicit TraceZone(const char *name)
+        : mName(name)
+        , mStart(Tracer::now())
+    {}
+
+    ~TraceZone()
+    { Tracer::record(mName, mStart, Tracer::now()); }
+
+private:
+    Q_DISABLE_COPY(TraceZone)
+
+    const char *mName;
+    qint64 mStart;
+};
+
+} // namespace Tiled
+
+#if defined(TILED_ENABLE_TRACING)
+#define TILED_TRACE_CONCAT_(a, b) a##b
+#define TILED_TRACE_CONCAT(a, b) TILED_TRACE_CONCAT_(a, b)
+#define TILED_TRACE(name) \
+    Tiled::TraceZone TILED_TRACE_CONCAT(tiledTraceZone, __LINE__)(name)
+#else
+#define TILED_TRACE(name) do {} while (false)
+#endif
+
+#endif // TRACING_H
@@ -20,6 +20,7 @@
 
 #include "csvplugin.h"
 
+#include "bufferedwriter.h"
 #include "map.h"
 #include "tile.h"
 #include "tilelayer.h"
@@ -27,6 +28,8 @@
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
+#include <QVector>
 
 #if QT_VERSION >= 0x050100
 #define HAS_QSAVEFILE_SUPPORT
@@ -39,6 +42,63 @@
 using namespace Tiled;
 using namespace Csv;
 
+namespace {
+
+/**
+ * Remembers the text written for each tile, which is its name when it has
+ * one and its ID otherwise. The text is looked up once per tileset rather
+ * than once per cell.
+ */
+class TileNames
+{
+public:
+    TileNames()
+        : mLastTileset(0)
+        , mLastNames(0)
+    {}
+
+    const QByteArray &tileName(const Tile *tile)
+    {
+        const Tileset *tileset = tile->tileset();
+
+        // Subsequent cells are likely to use the same tileset
+        if (tileset != mLastTileset) {
+            QVector<QByteArray> &names = mNames[tileset];
+            if (names.isEmpty())
+                names = namesFor(tileset);
+
+            mLastTileset = tileset;
+            mLastNames = &names;
+        }
+
+        return mLastNames->at(tile->id());
+    }
+
+private:
+    static QVector<QByteArray> namesFor(const Tileset *tileset)
+    {
+        const QString nameProperty = QLatin1String("name");
+
+        QVector<QByteArray> names;
+        names.reserve(tileset->tileCount());
+
+        foreach (const Tile *tile, tileset->tiles()) {
+            if (tile->hasProperty(nameProperty))
+                names.append(tile->property(nameProperty).toUtf8());
+            else
+                names.append(QByteArray::number(tile->id()));
+        }
+
+        return names;
+    }
+
+    QHash<const Tileset*, QVector<QByteArray> > mNames;
+    const Tileset *mLastTileset;
+    const QVector<QByteArray> *mLastNames;
+};
+
+} // anonymous namespace
+
 CsvPlugin::CsvPlugin()
 {
 }
@@ -48,6 +108,8 @@ bool CsvPlugin::write(const Map *map, const QString &fileName)
     // Get file paths for each layer
     QStringList layerPaths = outputFiles(map, fileName);
 
+    TileNames names;
+
     // Traverse all tile layers
     uint currentLayer = 0u;
     foreach (const Layer *layer, map->layers()) {
@@ -66,25 +128,26 @@ bool CsvPlugin::write(const Map *map, const QString &fileName)
             return false;
         }
 
+        BufferedWriter out(&file);
+
         // Write out tiles either by ID or their name, if given. -1 is "empty"
         for (int y = 0; y < tileLayer->height(); ++y) {
             for (int x = 0; x < tileLayer->width(); ++x) {
                 if (x > 0)
-                    file.write(",", 1);
-    
-                const Cell &cell = tileLayer->cellAt(x, y);
-                const Tile *tile = cell.tile;
-                if (tile && tile->hasProperty(QLatin1String("name"))) {
-                    file.write(tile->property(QLatin1String("name")).toUtf8());
-                } else {
-                    const int id = tile ? tile->id() : -1;
-                    file.write(QByteArray::number(id));
-                }
+                    out.write(',');
+
+                const Tile *tile = tileLayer->cellAt(x, y).tile;
+                if (tile)
+                    out.write(names.tileName(tile));
+                else
+                    out.write("-1", 2);
             }
-    
-            file.write("\n", 1);
+
+            out.write('\n');
         }
-    
+
+        out.flush();
+
         if (file.error() != QFile::NoError) {
             mError = file.errorString();
             return false;
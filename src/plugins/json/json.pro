@@ -5,10 +5,16 @@ DEFINES += JSON_LIBRARY
 SOURCES += jsonplugin.cpp \
     qjsonparser/json.cpp \
     varianttomapconverter.cpp \
-    maptovariantconverter.cpp
+    jsonmapreader.cpp \
+    jsonstreamreader.cpp \
+    jsonstreamwriter.cpp \
+    maptojsonwriter.cpp
 
 HEADERS += jsonplugin.h \
     json_global.h \
     qjsonparser/json.h \
     varianttomapconverter.h \
-    maptovariantconverter.h
+    jsonmapreader.h \
+    jsonstreamreader.h \
+    jsonstreamwriter.h \
+    maptojsonwriter.h
@@ -0,0 +1,131 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonmapreader.h"
+
+#include "jsonstreamreader.h"
+#include "varianttomapconverter.h"
+
+#include "map.h"
+
+using namespace Tiled;
+using namespace Json;
+
+Map *JsonMapReader::read(const QByteArray &data, const QDir &mapDir)
+{
+    mError.clear();
+
+    JsonStreamReader reader(data);
+    QVariantMap mapVariant;
+
+    if (reader.readStartObject()) {
+        QString key;
+        while (reader.readNextKey(key)) {
+            if (key == QLatin1String("layers"))
+                mapVariant.insert(key, readLayers(reader));
+            else
+                mapVariant.insert(key, reader.readValue());
+        }
+    }
+
+    if (reader.hasError() || !mError.isEmpty()) {
+        if (mError.isEmpty())
+            mError = reader.errorString();
+        return 0;
+    }
+
+    if (!reader.atEnd()) {
+        mError = tr("Unexpected data after the end of the map");
+        return 0;
+    }
+
+    VariantToMapConverter converter;
+    Map *map = converter.toMap(mapVariant, mapDir);
+
+    if (!map)
+        mError = converter.errorString();
+
+    return map;
+}
+
+QVariant JsonMapReader::readLayers(JsonStreamReader &reader)
+{
+    if (reader.peek() != '[')
+        return reader.readValue();
+
+    QVariantList layerVariants;
+
+    reader.readStartArray();
+    while (reader.readNextElement())
+        layerVariants.append(readLayer(reader));
+
+    return layerVariants;
+}
+
+QVariant JsonMapReader::readLayer(JsonStreamReader &reader)
+{
+    if (reader.peek() != '{')
+        return reader.readValue();
+
+    QVariantMap layerVariant;
+
+    reader.readStartObject();
+
+    QString key;
+    while (reader.readNextKey(key)) {
+        if (key == QLatin1String("data") && reader.peek() == '[') {
+            // The size is only known when it was written before the data
+            const int size = layerVariant.value(QLatin1String("width")).toInt() *
+                    layerVariant.value(QLatin1String("height")).toInt();
+            layerVariant.insert(key, readLayerData(reader, size));
+        } else {
+            layerVariant.insert(key, reader.readValue());
+        }
+    }
+
+    return layerVariant;
+}
+
+/**
+ * Reads an array of global tile IDs, without creating a QVariant for each
+ * of them. The IDs are mapped to cells later on, since the tilesets may be
+ * stored after the layers.
+ */
+QVariant JsonMapReader::readLayerData(JsonStreamReader &reader, int size)
+{
+    GidList gidList;
+    if (size > 0)
+        gidList.gids.reserve(size);
+
+    reader.readStartArray();
+    while (reader.readNextElement()) {
+        unsigned gid;
+        if (!reader.readUnsigned(gid)) {
+            if (mError.isEmpty() && !reader.hasError()) {
+                mError = tr("Unable to parse tile %1 of layer data")
+                        .arg(gidList.gids.size());
+            }
+            return QVariant();
+        }
+        gidList.gids.append(gid);
+    }
+
+    return QVariant::fromValue(gidList);
+}
@@ -0,0 +1,75 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONMAPREADER_H
+#define JSONMAPREADER_H
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QVariant>
+
+namespace Tiled {
+class Map;
+}
+
+namespace Json {
+
+class JsonStreamReader;
+
+/**
+ * Reads a map from a JSON document using JsonStreamReader.
+ *
+ * The tile layer data is read straight into arrays of global tile IDs,
+ * while the rest of the map, which is small in comparison, is read as
+ * variants and passed on to VariantToMapConverter.
+ */
+class JsonMapReader
+{
+    // Using the MapReader context since the messages are the same
+    Q_DECLARE_TR_FUNCTIONS(MapReader)
+
+public:
+    JsonMapReader() {}
+
+    /**
+     * Reads the map from the UTF-8 encoded JSON \a data. The \a mapDir is
+     * used to resolve any relative references to external images.
+     *
+     * Returns 0 in case of an error. The error can be obtained using
+     * errorString().
+     */
+    Tiled::Map *read(const QByteArray &data, const QDir &mapDir);
+
+    /**
+     * Returns the last error, if any.
+     */
+    QString errorString() const { return mError; }
+
+private:
+    QVariant readLayers(JsonStreamReader &reader);
+    QVariant readLayer(JsonStreamReader &reader);
+    QVariant readLayerData(JsonStreamReader &reader, int size);
+
+    QString mError;
+};
+
+} // namespace Json
+
+#endif // JSONMAPREADER_H
@@ -21,14 +21,15 @@
 
 #include "jsonplugin.h"
 
-#include "maptovariantconverter.h"
+#include "jsonmapreader.h"
+#include "jsonstreamwriter.h"
+#include "maptojsonwriter.h"
 #include "varianttomapconverter.h"
 
 #include "qjsonparser/json.h"
 
 #include <QFile>
 #include <QFileInfo>
-#include <QTextStream>
 
 #if QT_VERSION >= 0x050100
 #define HAS_QSAVEFILE_SUPPORT
@@ -52,7 +53,6 @@ Tiled::Map *JsonPlugin::read(const QString &fileName)
         return 0;
     }
 
-    JsonReader reader;
     QByteArray contents = file.readAll();
     if (fileName.endsWith(".js") && contents.size() > 0 && contents[0] != '{') {
         // Scan past JSONP prefix; look for an open curly at the start of the line
@@ -64,6 +64,18 @@ Tiled::Map *JsonPlugin::read(const QString &fileName)
             if (contents.endsWith(')')) contents.chop(1);
         }
     }
+
+    // Documents written by Tiled are always UTF-8, which is read by the
+    // faster JsonMapReader. Other encodings are left to JsonReader.
+    if (!contents.left(4).contains('\0')) {
+        JsonMapReader mapReader;
+        Tiled::Map *map = mapReader.read(contents, QFileInfo(fileName).dir());
+        if (!map)
+            mError = mapReader.errorString();
+        return map;
+    }
+
+    JsonReader reader;
     reader.parse(contents);
 
     const QVariant variant = reader.result();
@@ -94,39 +106,29 @@ bool JsonPlugin::write(const Tiled::Map *map, const QString &fileName)
         return false;
     }
 
-    MapToVariantConverter converter;
-    QVariant variant = converter.toVariant(map, QFileInfo(fileName).dir());
-
-    JsonWriter writer;
-    writer.setAutoFormatting(true);
+    JsonStreamWriter writer(&file);
 
-    if (!writer.stringify(variant)) {
-        // This can only happen due to coding error
-        mError = writer.errorString();
-        return false;
-    }
-
-    QTextStream out(&file);
     bool isJsFile = fileName.endsWith(".js");
     if (isJsFile) {
-        // Trim and escape name
-        JsonWriter nameWriter;
-        QString baseName = QFileInfo(fileName).baseName();
-        nameWriter.stringify(baseName);
-        out << "(function(name,data){\n if(typeof onTileMapLoaded === 'undefined') {\n";
-        out << "  if(typeof TileMaps === 'undefined') TileMaps = {};\n";
-        out << "  TileMaps[name] = data;\n";
-        out << " } else {\n";
-        out << "  onTileMapLoaded(name,data);\n";
-        out << " }})(" << nameWriter.result() << ",\n";
+        const QString baseName = QFileInfo(fileName).baseName();
+        writer.writeRaw("(function(name,data){\n if(typeof onTileMapLoaded === 'undefined') {\n");
+        writer.writeRaw("  if(typeof TileMaps === 'undefined') TileMaps = {};\n");
+        writer.writeRaw("  TileMaps[name] = data;\n");
+        writer.writeRaw(" } else {\n");
+        writer.writeRaw("  onTileMapLoaded(name,data);\n");
+        writer.writeRaw(" }})(");
+        writer.writeRaw(JsonStreamWriter::quote(baseName));
+        writer.writeRaw(",\n");
     }
-    out << writer.result();
+
+    MapToJsonWriter mapWriter;
+    mapWriter.write(writer, map, QFileInfo(fileName).dir());
+
     if (isJsFile) {
-        out << ");";
+        writer.writeRaw(");");
     }
-    out.flush();
 
-    if (file.error() != QFile::NoError) {
+    if (!writer.flush() || file.error() != QFile::NoError) {
         mError = tr("Error while writing file:\n%1").arg(file.errorString());
         return false;
     }
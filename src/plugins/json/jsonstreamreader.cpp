@@ -0,0 +1,419 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonstreamreader.h"
+
+#include <climits>
+#include <cstring>
+
+namespace Json {
+
+static inline bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F')
+        return c - 'A' + 10;
+    return -1;
+}
+
+JsonStreamReader::JsonStreamReader(const QByteArray &data)
+    : mBegin(data.constData())
+    , mPos(data.constData())
+    , mEnd(data.constData() + data.size())
+{
+    // Skip the UTF-8 byte order mark
+    if (mEnd - mPos >= 3 && std::memcmp(mPos, "\xEF\xBB\xBF", 3) == 0)
+        mPos += 3;
+}
+
+char JsonStreamReader::peek()
+{
+    skipWhitespace();
+    return mPos < mEnd ? *mPos : 0;
+}
+
+/**
+ * Reads the start of an object. Afterwards, the members of the object can
+ * be iterated with readNextKey().
+ */
+bool JsonStreamReader::readStartObject()
+{
+    skipWhitespace();
+    if (!expect('{'))
+        return false;
+
+    mFirstMember.append(true);
+    return true;
+}
+
+/**
+ * Reads the key of the next member of the current object, after which the
+ * value should be read. Returns false when the end of the object has been
+ * reached or an error occurred.
+ */
+bool JsonStreamReader::readNextKey(QString &key)
+{
+    Q_ASSERT(!mFirstMember.isEmpty());
+
+    if (hasError())
+        return false;
+
+    skipWhitespace();
+    if (mPos < mEnd && *mPos == '}') {
+        ++mPos;
+        mFirstMember.removeLast();
+        return false;
+    }
+
+    if (mFirstMember.last()) {
+        mFirstMember.last() = false;
+    } else {
+        if (!expect(','))
+            return false;
+        skipWhitespace();
+    }
+
+    if (!readString(key))
+        return false;
+
+    skipWhitespace();
+    return expect(':');
+}
+
+/**
+ * Reads the start of an array. Afterwards, the elements of the array can
+ * be iterated with readNextElement().
+ */
+bool JsonStreamReader::readStartArray()
+{
+    skipWhitespace();
+    if (!expect('['))
+        return false;
+
+    mFirstMember.append(true);
+    return true;
+}
+
+/**
+ * Prepares for reading the next element of the current array. Returns false
+ * when the end of the array has been reached or an error occurred.
+ */
+bool JsonStreamReader::readNextElement()
+{
+    Q_ASSERT(!mFirstMember.isEmpty());
+
+    if (hasError())
+        return false;
+
+    skipWhitespace();
+    if (mPos < mEnd && *mPos == ']') {
+        ++mPos;
+        mFirstMember.removeLast();
+        return false;
+    }
+
+    if (mFirstMember.last())
+        mFirstMember.last() = false;
+    else if (!expect(','))
+        return false;
+
+    return true;
+}
+
+/**
+ * Reads the next value, including any nested objects or arrays, as a
+ * QVariant. Objects are returned as QVariantMap and arrays as QVariantList.
+ */
+QVariant JsonStreamReader::readValue()
+{
+    skipWhitespace();
+    if (mPos >= mEnd) {
+        setError(tr("Unexpected end of file"));
+        return QVariant();
+    }
+
+    switch (*mPos) {
+    case '{': {
+        readStartObject();
+        QVariantMap variantMap;
+        QString key;
+        while (readNextKey(key)) {
+            const QVariant value = readValue();
+            if (hasError())
+                break;
+            variantMap.insert(key, value);
+        }
+        if (hasError())
+            return QVariant();
+        return variantMap;
+    }
+    case '[': {
+        readStartArray();
+        QVariantList variantList;
+        while (readNextElement()) {
+            const QVariant value = readValue();
+            if (hasError())
+                break;
+            variantList.append(value);
+        }
+        if (hasError())
+            return QVariant();
+        return variantList;
+    }
+    case '"': {
+        QString string;
+        if (!readString(string))
+            return QVariant();
+        return string;
+    }
+    case 't':
+    case 'f':
+    case 'n':
+        return readLiteral();
+    default:
+        if (*mPos == '-' || isDigit(*mPos))
+            return readNumber();
+
+        setError(tr("Unexpected character '%1'").arg(QLatin1Char(*mPos)));
+        return QVariant();
+    }
+}
+
+/**
+ * Reads the next value as an unsigned number. Non-negative integers are
+ * read without any intermediate conversion. Returns false when the value is
+ * not a valid unsigned number.
+ */
+bool JsonStreamReader::readUnsigned(unsigned &value)
+{
+    skipWhitespace();
+
+    const char *pos = mPos;
+    quint64 number = 0;
+    while (pos < mEnd && isDigit(*pos) && number <= 0xFFFFFFFFu) {
+        number = number * 10 + (*pos - '0');
+        ++pos;
+    }
+
+    const bool isPlainInteger = pos != mPos && number <= 0xFFFFFFFFu &&
+            (pos == mEnd || !(isDigit(*pos) || *pos == '.' ||
+                              *pos == 'e' || *pos == 'E'));
+
+    if (isPlainInteger) {
+        value = static_cast<unsigned>(number);
+        mPos = pos;
+        return true;
+    }
+
+    // Fall back to the general case for anything else
+    bool ok;
+    value = readValue().toUInt(&ok);
+    return ok && !hasError();
+}
+
+/**
+ * Returns whether the end of the document has been reached, skipping any
+ * trailing whitespace.
+ */
+bool JsonStreamReader::atEnd()
+{
+    skipWhitespace();
+    return mPos >= mEnd;
+}
+
+void JsonStreamReader::skipWhitespace()
+{
+    while (mPos < mEnd) {
+        switch (*mPos) {
+        case ' ':
+        case '\t':
+        case '\n':
+        case '\r':
+            ++mPos;
+            break;
+        default:
+            return;
+        }
+    }
+}
+
+bool JsonStreamReader::expect(char c)
+{
+    if (mPos < mEnd && *mPos == c) {
+        ++mPos;
+        return true;
+    }
+
+    if (mPos < mEnd)
+        setError(tr("Expected '%1'").arg(QLatin1Char(c)));
+    else
+        setError(tr("Unexpected end of file"));
+    return false;
+}
+
+bool JsonStreamReader::readString(QString &string)
+{
+    if (!expect('"'))
+        return false;
+
+    // Fast path for strings without escape sequences
+    const char *pos = mPos;
+    while (pos < mEnd && *pos != '"' && *pos != '\\')
+        ++pos;
+
+    if (pos < mEnd && *pos == '"') {
+        string = QString::fromUtf8(mPos, pos - mPos);
+        mPos = pos + 1;
+        return true;
+    }
+
+    string = QString::fromUtf8(mPos, pos - mPos);
+    mPos = pos;
+
+    while (mPos < mEnd) {
+        const char c = *mPos++;
+
+        if (c == '"')
+            return true;
+
+        if (c != '\\') {
+            const char *start = mPos - 1;
+            while (mPos < mEnd && *mPos != '"' && *mPos != '\\')
+                ++mPos;
+            string.append(QString::fromUtf8(start, mPos - start));
+            continue;
+        }
+
+        if (mPos >= mEnd)
+            break;
+
+        switch (*mPos++) {
+        case '"':   string.append(QLatin1Char('"'));   break;
+        case '\\':  string.append(QLatin1Char('\\'));  break;
+        case '/':   string.append(QLatin1Char('/'));   break;
+        case 'b':   string.append(QLatin1Char('\b'));  break;
+        case 'f':   string.append(QLatin1Char('\f'));  break;
+        case 'n':   string.append(QLatin1Char('\n'));  break;
+        case 'r':   string.append(QLatin1Char('\r'));  break;
+        case 't':   string.append(QLatin1Char('\t'));  break;
+        case 'u': {
+            if (mEnd - mPos < 4) {
+                setError(tr("Invalid escape sequence"));
+                return false;
+            }
+            ushort unicode = 0;
+            for (int i = 0; i < 4; ++i) {
+                const int digit = hexValue(*mPos++);
+                if (digit < 0) {
+                    setError(tr("Invalid escape sequence"));
+                    return false;
+                }
+                unicode = (unicode << 4) | digit;
+            }
+            // Surrogate pairs end up combined in the UTF-16 string
+            string.append(QChar(unicode));
+            break;
+        }
+        default:
+            setError(tr("Invalid escape sequence"));
+            return false;
+        }
+    }
+
+    setError(tr("Unterminated string"));
+    return false;
+}
+
+QVariant JsonStreamReader::readNumber()
+{
+    const char *start = mPos;
+    bool isInteger = true;
+
+    while (mPos < mEnd) {
+        const char c = *mPos;
+        if (c == '.' || c == 'e' || c == 'E')
+            isInteger = false;
+        else if (!isDigit(c) && c != '-' && c != '+')
+            break;
+        ++mPos;
+    }
+
+    const QByteArray bytes = QByteArray::fromRawData(start, mPos - start);
+    bool ok;
+
+    if (isInteger) {
+        const qlonglong number = bytes.toLongLong(&ok);
+        if (ok) {
+            if (number >= INT_MIN && number <= INT_MAX)
+                return int(number);
+            return number;
+        }
+    }
+
+    const double number = bytes.toDouble(&ok);
+    if (!ok) {
+        mPos = start;
+        setError(tr("Invalid number"));
+        return QVariant();
+    }
+
+    return number;
+}
+
+QVariant JsonStreamReader::readLiteral()
+{
+    const int remaining = mEnd - mPos;
+
+    if (remaining >= 4 && std::strncmp(mPos, "true", 4) == 0) {
+        mPos += 4;
+        return true;
+    }
+    if (remaining >= 5 && std::strncmp(mPos, "false", 5) == 0) {
+        mPos += 5;
+        return false;
+    }
+    if (remaining >= 4 && std::strncmp(mPos, "null", 4) == 0) {
+        mPos += 4;
+        return QVariant();
+    }
+
+    setError(tr("Unexpected character '%1'").arg(QLatin1Char(*mPos)));
+    return QVariant();
+}
+
+void JsonStreamReader::setError(const QString &message)
+{
+    // Only the first error is of interest
+    if (hasError())
+        return;
+
+    const int line = QByteArray::fromRawData(mBegin, mPos - mBegin).count('\n') + 1;
+    mError = tr("%1 on line %2").arg(message).arg(line);
+}
+
+} // namespace Json
@@ -0,0 +1,86 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONSTREAMREADER_H
+#define JSONSTREAMREADER_H
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QString>
+#include <QVariant>
+#include <QVector>
+
+namespace Json {
+
+/**
+ * A pull parser for UTF-8 encoded JSON documents.
+ *
+ * Instead of turning the whole document into a QVariant, the caller walks
+ * through objects and arrays and decides per value how to read it. This
+ * allows large arrays of numbers to be read without creating a QVariant
+ * for each element.
+ *
+ * The data passed to the reader needs to stay alive while reading.
+ */
+class JsonStreamReader
+{
+    Q_DECLARE_TR_FUNCTIONS(JsonStreamReader)
+
+public:
+    JsonStreamReader(const QByteArray &data);
+
+    /**
+     * Returns the first character of the next value, or 0 at the end of
+     * the document.
+     */
+    char peek();
+
+    bool readStartObject();
+    bool readNextKey(QString &key);
+
+    bool readStartArray();
+    bool readNextElement();
+
+    QVariant readValue();
+    bool readUnsigned(unsigned &value);
+
+    bool atEnd();
+
+    bool hasError() const { return !mError.isEmpty(); }
+    QString errorString() const { return mError; }
+
+private:
+    void skipWhitespace();
+    bool expect(char c);
+    bool readString(QString &string);
+    QVariant readNumber();
+    QVariant readLiteral();
+    void setError(const QString &message);
+
+    const char *mBegin;
+    const char *mPos;
+    const char *mEnd;
+    QVector<bool> mFirstMember;
+    QString mError;
+};
+
+} // namespace Json
+
+#endif // JSONSTREAMREADER_H
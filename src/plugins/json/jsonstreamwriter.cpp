@@ -0,0 +1,279 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "jsonstreamwriter.h"
+
+#include <QIODevice>
+
+#include <cmath>
+
+namespace Json {
+
+// The amount of output collected before it is written to the device
+static const int BufferSize = 64 * 1024;
+
+JsonStreamWriter::JsonStreamWriter(QIODevice *device)
+    : mDevice(device)
+    , mError(false)
+{
+    mBuffer.reserve(BufferSize);
+}
+
+JsonStreamWriter::~JsonStreamWriter()
+{
+    flush();
+}
+
+void JsonStreamWriter::writeStartObject()
+{
+    prepareValue(true);
+    startScope('{', false);
+}
+
+void JsonStreamWriter::writeStartObject(const char *key)
+{
+    prepareKey(quote(QByteArray(key)));
+    startScope('{', false);
+}
+
+void JsonStreamWriter::writeStartObject(const QString &key)
+{
+    prepareKey(quote(key));
+    startScope('{', false);
+}
+
+void JsonStreamWriter::writeEndObject()
+{
+    Q_ASSERT(!mScopes.isEmpty() && !mScopes.last().isArray);
+    endScope('}');
+}
+
+void JsonStreamWriter::writeStartArray()
+{
+    prepareValue(true);
+    startScope('[', true);
+}
+
+void JsonStreamWriter::writeStartArray(const char *key)
+{
+    prepareKey(quote(QByteArray(key)));
+    startScope('[', true);
+}
+
+void JsonStreamWriter::writeEndArray()
+{
+    Q_ASSERT(!mScopes.isEmpty() && mScopes.last().isArray);
+    endScope(']');
+}
+
+void JsonStreamWriter::writeValue(double value)
+{
+    // JSON has no representation for infinity and NaN
+    if (std::isfinite(value))
+        writeUnquotedValue(QByteArray::number(value, 'g', 15));
+    else
+        writeUnquotedValue("null");
+}
+
+void JsonStreamWriter::writeKeyAndValue(const char *key, int value)
+{
+    prepareKey(quote(QByteArray(key)));
+    write(QByteArray::number(value));
+}
+
+void JsonStreamWriter::writeKeyAndValue(const char *key, unsigned value)
+{
+    prepareKey(quote(QByteArray(key)));
+    write(QByteArray::number(value));
+}
+
+void JsonStreamWriter::writeKeyAndValue(const char *key, double value)
+{
+    prepareKey(quote(QByteArray(key)));
+    if (std::isfinite(value))
+        write(QByteArray::number(value, 'g', 15));
+    else
+        write("null");
+}
+
+void JsonStreamWriter::writeKeyAndValue(const char *key, bool value)
+{
+    prepareKey(quote(QByteArray(key)));
+    write(value ? "true" : "false");
+}
+
+void JsonStreamWriter::writeKeyAndValue(const char *key, const char *value)
+{
+    prepareKey(quote(QByteArray(key)));
+    write(quote(QByteArray(value)));
+}
+
+/**
+ * Writes a string \a value that is already encoded as UTF-8.
+ */
+void JsonStreamWriter::writeKeyAndValue(const char *key, const QByteArray &value)
+{
+    prepareKey(quote(QByteArray(key)));
+    write(quote(value));
+}
+
+void JsonStreamWriter::writeKeyAndValue(const char *key, const QString &value)
+{
+    prepareKey(quote(QByteArray(key)));
+    write(quote(value));
+}
+
+void JsonStreamWriter::writeKeyAndValue(const QString &key,
+                                        const QString &value)
+{
+    prepareKey(quote(key));
+    write(quote(value));
+}
+
+/**
+ * Writes any buffered output to the device. Returns whether all output
+ * written so far was successfully passed on to the device.
+ */
+bool JsonStreamWriter::flush()
+{
+    if (!mBuffer.isEmpty()) {
+        if (mDevice->write(mBuffer) != mBuffer.size())
+            mError = true;
+        mBuffer.resize(0);
+    }
+    return !mError;
+}
+
+/**
+ * Quotes the given UTF-8 encoded string, escaping special characters as
+ * necessary.
+ */
+QByteArray JsonStreamWriter::quote(const QByteArray &utf8)
+{
+    QByteArray quoted;
+    quoted.reserve(utf8.size() + 2);
+    quoted.append('"');
+
+    for (int i = 0; i < utf8.size(); ++i) {
+        const char c = utf8.at(i);
+
+        switch (c) {
+        case '\\':  quoted.append("\\\\");  break;
+        case '"':   quoted.append("\\\"");  break;
+        case '\b':  quoted.append("\\b");   break;
+        case '\f':  quoted.append("\\f");   break;
+        case '\n':  quoted.append("\\n");   break;
+        case '\r':  quoted.append("\\r");   break;
+        case '\t':  quoted.append("\\t");   break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                quoted.append("\\u00");
+                quoted.append("0123456789abcdef"[(c >> 4) & 0xf]);
+                quoted.append("0123456789abcdef"[c & 0xf]);
+            } else {
+                quoted.append(c);
+            }
+        }
+    }
+
+    quoted.append('"');
+    return quoted;
+}
+
+void JsonStreamWriter::prepareKey(const QByteArray &quotedKey)
+{
+    Q_ASSERT(!mScopes.isEmpty() && !mScopes.last().isArray);
+
+    Scope &scope = mScopes.last();
+    if (!scope.isEmpty)
+        write(',');
+    scope.isEmpty = false;
+
+    writeNewline();
+    write(quotedKey);
+    write(": ");
+}
+
+void JsonStreamWriter::prepareValue(bool isContainer)
+{
+    if (mScopes.isEmpty())
+        return;
+
+    Q_ASSERT(mScopes.last().isArray);
+
+    Scope &scope = mScopes.last();
+    if (!scope.isEmpty)
+        write(',');
+
+    // Scalar values are kept on a single line, but nested objects and
+    // arrays each start on their own line.
+    if (isContainer) {
+        scope.isMultiLine = true;
+        writeNewline();
+    } else if (!scope.isEmpty) {
+        write(' ');
+    }
+
+    scope.isEmpty = false;
+}
+
+void JsonStreamWriter::startScope(char open, bool isArray)
+{
+    write(open);
+
+    Scope scope;
+    scope.isArray = isArray;
+    scope.isEmpty = true;
+    scope.isMultiLine = false;
+    mScopes.append(scope);
+}
+
+void JsonStreamWriter::endScope(char close)
+{
+    const Scope scope = mScopes.last();
+    mScopes.removeLast();
+
+    if (scope.isArray ? scope.isMultiLine : !scope.isEmpty)
+        writeNewline();
+
+    write(close);
+}
+
+void JsonStreamWriter::writeUnquotedValue(const QByteArray &value)
+{
+    prepareValue(false);
+    write(value);
+}
+
+void JsonStreamWriter::writeNewline()
+{
+    write('\n');
+    for (int level = mScopes.size(); level; --level)
+        write("  ");
+}
+
+void JsonStreamWriter::write(const char *bytes, int length)
+{
+    mBuffer.append(bytes, length);
+    if (mBuffer.size() >= BufferSize)
+        flush();
+}
+
+} // namespace Json
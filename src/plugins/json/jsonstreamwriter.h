@@ -0,0 +1,141 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef JSONSTREAMWRITER_H
+#define JSONSTREAMWRITER_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+
+class QIODevice;
+
+namespace Json {
+
+/**
+ * Writes a well formatted JSON document directly to a device, encoded as
+ * UTF-8.
+ *
+ * The output is collected in a buffer of limited size, which is flushed to
+ * the device whenever it fills up. This way the memory used while writing
+ * does not depend on the size of the document.
+ */
+class JsonStreamWriter
+{
+public:
+    JsonStreamWriter(QIODevice *device);
+    ~JsonStreamWriter();
+
+    void writeStartObject();
+    void writeStartObject(const char *key);
+    void writeStartObject(const QString &key);
+    void writeEndObject();
+
+    void writeStartArray();
+    void writeStartArray(const char *key);
+    void writeEndArray();
+
+    void writeValue(int value);
+    void writeValue(unsigned value);
+    void writeValue(double value);
+    void writeValue(bool value);
+    void writeValue(const char *value);
+    void writeValue(const QString &value);
+
+    void writeKeyAndValue(const char *key, int value);
+    void writeKeyAndValue(const char *key, unsigned value);
+    void writeKeyAndValue(const char *key, double value);
+    void writeKeyAndValue(const char *key, bool value);
+    void writeKeyAndValue(const char *key, const char *value);
+    void writeKeyAndValue(const char *key, const QByteArray &value);
+    void writeKeyAndValue(const char *key, const QString &value);
+    void writeKeyAndValue(const QString &key, const QString &value);
+
+    void writeRaw(const char *bytes);
+    void writeRaw(const QByteArray &bytes);
+
+    bool flush();
+
+    bool hasError() const { return mError; }
+
+    static QByteArray quote(const QByteArray &utf8);
+    static QByteArray quote(const QString &str);
+
+private:
+    struct Scope {
+        bool isArray;
+        bool isEmpty;
+        bool isMultiLine;
+    };
+
+    void prepareKey(const QByteArray &quotedKey);
+    void prepareValue(bool isContainer);
+    void startScope(char open, bool isArray);
+    void endScope(char close);
+    void writeUnquotedValue(const QByteArray &value);
+    void writeNewline();
+
+    void write(const char *bytes, int length);
+    void write(const char *bytes);
+    void write(const QByteArray &bytes);
+    void write(char c);
+
+    QIODevice *mDevice;
+    QByteArray mBuffer;
+    QVector<Scope> mScopes;
+    bool mError;
+};
+
+inline void JsonStreamWriter::writeValue(int value)
+{ writeUnquotedValue(QByteArray::number(value)); }
+
+inline void JsonStreamWriter::writeValue(unsigned value)
+{ writeUnquotedValue(QByteArray::number(value)); }
+
+inline void JsonStreamWriter::writeValue(bool value)
+{ writeUnquotedValue(value ? "true" : "false"); }
+
+inline void JsonStreamWriter::writeValue(const char *value)
+{ writeUnquotedValue(quote(QByteArray(value))); }
+
+inline void JsonStreamWriter::writeValue(const QString &value)
+{ writeUnquotedValue(quote(value)); }
+
+inline QByteArray JsonStreamWriter::quote(const QString &str)
+{ return quote(str.toUtf8()); }
+
+inline void JsonStreamWriter::writeRaw(const char *bytes)
+{ write(bytes); }
+
+inline void JsonStreamWriter::writeRaw(const QByteArray &bytes)
+{ write(bytes); }
+
+inline void JsonStreamWriter::write(const char *bytes)
+{ write(bytes, qstrlen(bytes)); }
+
+inline void JsonStreamWriter::write(const QByteArray &bytes)
+{ write(bytes.constData(), bytes.length()); }
+
+inline void JsonStreamWriter::write(char c)
+{ write(&c, 1); }
+
+} // namespace Json
+
+#endif // JSONSTREAMWRITER_H
@@ -0,0 +1,541 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2011, Porfírio José Pereira Ribeiro <porfirioribeiro@gmail.com>
+ * Copyright 2011, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "maptojsonwriter.h"
+
+#include "jsonstreamwriter.h"
+
+#include "compression.h"
+#include "imagelayer.h"
+#include "map.h"
+#include "mapobject.h"
+#include "objectgroup.h"
+#include "properties.h"
+#include "tile.h"
+#include "tilelayer.h"
+#include "tileset.h"
+#include "terrain.h"
+
+using namespace Tiled;
+using namespace Json;
+
+void MapToJsonWriter::write(JsonStreamWriter &writer, const Map *map,
+                            const QDir &mapDir)
+{
+    mMapDir = mapDir;
+    mGidMapper.clear();
+    mLayerDataFormat = map->layerDataFormat();
+
+    writer.writeStartObject();
+
+    writer.writeKeyAndValue("version", 1.0);
+    writer.writeKeyAndValue("orientation", orientationToString(map->orientation()));
+    writer.writeKeyAndValue("renderorder", renderOrderToString(map->renderOrder()));
+    writer.writeKeyAndValue("width", map->width());
+    writer.writeKeyAndValue("height", map->height());
+    writer.writeKeyAndValue("tilewidth", map->tileWidth());
+    writer.writeKeyAndValue("tileheight", map->tileHeight());
+    writeProperties(writer, map->properties());
+    writer.writeKeyAndValue("nextobjectid", map->nextObjectId());
+
+    if (map->orientation() == Map::Hexagonal) {
+        writer.writeKeyAndValue("hexsidelength", map->hexSideLength());
+    }
+
+    if (map->orientation() == Map::Hexagonal || map->orientation() == Map::Staggered) {
+        writer.writeKeyAndValue("staggeraxis", staggerAxisToString(map->staggerAxis()));
+        writer.writeKeyAndValue("staggerindex", staggerIndexToString(map->staggerIndex()));
+    }
+
+    const QColor bgColor = map->backgroundColor();
+    if (bgColor.isValid())
+        writer.writeKeyAndValue("backgroundcolor", bgColor.name());
+
+    // RTB
+    addRTBMapAttributes(writer, map->rtbMap());
+
+    writer.writeStartArray("tilesets");
+    unsigned firstGid = 1;
+    foreach (const SharedTileset &tileset, map->tilesets()) {
+        writeTileset(writer, tileset.data(), firstGid);
+        mGidMapper.insert(firstGid, tileset.data());
+        firstGid += tileset->tileCount();
+    }
+    writer.writeEndArray();
+
+    writer.writeStartArray("layers");
+    foreach (const Layer *layer, map->layers()) {
+        switch (layer->layerType()) {
+        case Layer::TileLayerType:
+            writeTileLayer(writer, static_cast<const TileLayer*>(layer));
+            break;
+        case Layer::ObjectGroupType:
+            writeObjectGroup(writer, static_cast<const ObjectGroup*>(layer));
+            break;
+        case Layer::ImageLayerType:
+            writeImageLayer(writer, static_cast<const ImageLayer*>(layer));
+            break;
+        }
+    }
+    writer.writeEndArray();
+
+    writer.writeEndObject();
+}
+
+void MapToJsonWriter::writeTileset(JsonStreamWriter &writer,
+                                   const Tileset *tileset,
+                                   unsigned firstGid) const
+{
+    writer.writeStartObject();
+
+    writer.writeKeyAndValue("firstgid", firstGid);
+    writer.writeKeyAndValue("name", tileset->name());
+    writer.writeKeyAndValue("tilewidth", tileset->tileWidth());
+    writer.writeKeyAndValue("tileheight", tileset->tileHeight());
+    writer.writeKeyAndValue("spacing", tileset->tileSpacing());
+    writer.writeKeyAndValue("margin", tileset->margin());
+    writer.writeKeyAndValue("tilecount", tileset->tileCount());
+    writeProperties(writer, tileset->properties());
+
+    const QPoint offset = tileset->tileOffset();
+    if (!offset.isNull()) {
+        writer.writeStartObject("tileoffset");
+        writer.writeKeyAndValue("x", offset.x());
+        writer.writeKeyAndValue("y", offset.y());
+        writer.writeEndObject();
+    }
+
+    // Write the image element
+    const QString &imageSource = tileset->imageSource();
+    if (!imageSource.isEmpty()) {
+        const QString rel = mMapDir.relativeFilePath(tileset->imageSource());
+
+        writer.writeKeyAndValue("image", rel);
+
+        const QColor transColor = tileset->transparentColor();
+        if (transColor.isValid())
+            writer.writeKeyAndValue("transparentcolor", transColor.name());
+
+        writer.writeKeyAndValue("imagewidth", tileset->imageWidth());
+        writer.writeKeyAndValue("imageheight", tileset->imageHeight());
+    }
+
+    // Write the properties of those tiles that have them
+    bool hasTileProperties = false;
+    for (int i = 0; i < tileset->tileCount(); ++i) {
+        const Properties &properties = tileset->tileAt(i)->properties();
+        if (properties.isEmpty())
+            continue;
+
+        if (!hasTileProperties) {
+            writer.writeStartObject("tileproperties");
+            hasTileProperties = true;
+        }
+
+        writer.writeStartObject(QString::number(i));
+        Properties::const_iterator it = properties.constBegin();
+        Properties::const_iterator it_end = properties.constEnd();
+        for (; it != it_end; ++it)
+            writer.writeKeyAndValue(it.key(), it.value());
+        writer.writeEndObject();
+    }
+    if (hasTileProperties)
+        writer.writeEndObject();
+
+    // Write the terrain, external image, object group and animation for
+    // those tiles that have them.
+    bool hasTiles = false;
+    for (int i = 0; i < tileset->tileCount(); ++i) {
+        const Tile *tile = tileset->tileAt(i);
+
+        const bool hasTerrain = tile->terrain() != 0xFFFFFFFF;
+        const bool hasProbability = tile->terrainProbability() != 1.f;
+        const bool hasImage = !tile->imageSource().isEmpty();
+
+        if (!hasTerrain && !hasProbability && !hasImage &&
+                !tile->objectGroup() && !tile->isAnimated())
+            continue;
+
+        if (!hasTiles) {
+            writer.writeStartObject("tiles");
+            hasTiles = true;
+        }
+
+        writer.writeStartObject(QString::number(i));
+        if (hasTerrain) {
+            writer.writeStartArray("terrain");
+            for (int j = 0; j < 4; ++j)
+                writer.writeValue(tile->cornerTerrainId(j));
+            writer.writeEndArray();
+        }
+        if (hasProbability)
+            writer.writeKeyAndValue("probability", tile->terrainProbability());
+        if (hasImage) {
+            const QString rel = mMapDir.relativeFilePath(tile->imageSource());
+            writer.writeKeyAndValue("image", rel);
+        }
+        if (tile->objectGroup())
+            writeObjectGroup(writer, tile->objectGroup(), "objectgroup");
+        if (tile->isAnimated()) {
+            writer.writeStartArray("animation");
+            foreach (const Frame &frame, tile->frames()) {
+                writer.writeStartObject();
+                writer.writeKeyAndValue("tileid", frame.tileId);
+                writer.writeKeyAndValue("duration", frame.duration);
+                writer.writeEndObject();
+            }
+            writer.writeEndArray();
+        }
+        writer.writeEndObject();
+    }
+    if (hasTiles)
+        writer.writeEndObject();
+
+    // Write terrains
+    if (tileset->terrainCount() > 0) {
+        writer.writeStartArray("terrains");
+        for (int i = 0; i < tileset->terrainCount(); ++i) {
+            Terrain *terrain = tileset->terrain(i);
+            const Properties &properties = terrain->properties();
+            writer.writeStartObject();
+            writer.writeKeyAndValue("name", terrain->name());
+            if (!properties.isEmpty())
+                writeProperties(writer, properties);
+            writer.writeKeyAndValue("tile", terrain->imageTileId());
+            writer.writeEndObject();
+        }
+        writer.writeEndArray();
+    }
+
+    writer.writeEndObject();
+}
+
+void MapToJsonWriter::writeProperties(JsonStreamWriter &writer,
+                                      const Properties &properties) const
+{
+    writer.writeStartObject("properties");
+
+    Properties::const_iterator it = properties.constBegin();
+    Properties::const_iterator it_end = properties.constEnd();
+    for (; it != it_end; ++it)
+        writer.writeKeyAndValue(it.key(), it.value());
+
+    writer.writeEndObject();
+}
+
+void MapToJsonWriter::writeTileLayer(JsonStreamWriter &writer,
+                                     const TileLayer *tileLayer) const
+{
+    writer.writeStartObject();
+    writer.writeKeyAndValue("type", "tilelayer");
+
+    writeLayerAttributes(writer, tileLayer);
+
+    switch (mLayerDataFormat) {
+    case Map::XML:
+    case Map::CSV:
+        writer.writeStartArray("data");
+        for (int y = 0; y < tileLayer->height(); ++y)
+            for (int x = 0; x < tileLayer->width(); ++x)
+                writer.writeValue(mGidMapper.cellToGid(tileLayer->cellAt(x, y)));
+        writer.writeEndArray();
+        break;
+
+    case Map::Base64:
+    case Map::Base64Zlib:
+    case Map::Base64Gzip: {
+        writer.writeKeyAndValue("encoding", "base64");
+
+        QByteArray tileData;
+        tileData.reserve(tileLayer->height() * tileLayer->width() * 4);
+
+        for (int y = 0; y < tileLayer->height(); ++y) {
+            for (int x = 0; x < tileLayer->width(); ++x) {
+                const unsigned gid = mGidMapper.cellToGid(tileLayer->cellAt(x, y));
+                tileData.append((char) (gid));
+                tileData.append((char) (gid >> 8));
+                tileData.append((char) (gid >> 16));
+                tileData.append((char) (gid >> 24));
+            }
+        }
+
+        if (mLayerDataFormat == Map::Base64Zlib) {
+            writer.writeKeyAndValue("compression", "zlib");
+            tileData = compress(tileData, Zlib);
+        } else if (mLayerDataFormat == Map::Base64Gzip) {
+            writer.writeKeyAndValue("compression", "gzip");
+            tileData = compress(tileData, Gzip);
+        }
+
+        writer.writeKeyAndValue("data", tileData.toBase64());
+        break;
+    }
+    }
+
+    writer.writeEndObject();
+}
+
+void MapToJsonWriter::writeObjectGroup(JsonStreamWriter &writer,
+                                       const ObjectGroup *objectGroup,
+                                       const char *key) const
+{
+    if (key)
+        writer.writeStartObject(key);
+    else
+        writer.writeStartObject();
+
+    writer.writeKeyAndValue("type", "objectgroup");
+
+    if (objectGroup->color().isValid())
+        writer.writeKeyAndValue("color", objectGroup->color().name());
+
+    writer.writeKeyAndValue("draworder", drawOrderToString(objectGroup->drawOrder()));
+
+    writeLayerAttributes(writer, objectGroup);
+
+    writer.writeStartArray("objects");
+    foreach (const MapObject *object, objectGroup->objects())
+        writeMapObject(writer, object);
+    writer.writeEndArray();
+
+    writer.writeEndObject();
+}
+
+void MapToJsonWriter::writeMapObject(JsonStreamWriter &writer,
+                                     const MapObject *object) const
+{
+    writer.writeStartObject();
+
+    writeProperties(writer, object->properties());
+    writer.writeKeyAndValue("id", object->id());
+    writer.writeKeyAndValue("name", object->name());
+    writer.writeKeyAndValue("type", object->type());
+    if (!object->cell().isEmpty())
+        writer.writeKeyAndValue("gid", mGidMapper.cellToGid(object->cell()));
+
+    writer.writeKeyAndValue("x", object->x());
+    writer.writeKeyAndValue("y", object->y());
+    writer.writeKeyAndValue("width", object->width());
+    writer.writeKeyAndValue("height", object->height());
+    writer.writeKeyAndValue("rotation", object->rotation());
+
+    writer.writeKeyAndValue("visible", object->isVisible());
+
+    /* Polygons are stored in this format:
+     *
+     *   "polygon/polyline": [
+     *       { "x": 0, "y": 0 },
+     *       { "x": 1, "y": 1 },
+     *       ...
+     *   ]
+     */
+    const QPolygonF &polygon = object->polygon();
+    if (!polygon.isEmpty()) {
+        if (object->shape() == MapObject::Polygon)
+            writer.writeStartArray("polygon");
+        else
+            writer.writeStartArray("polyline");
+
+        foreach (const QPointF &point, polygon) {
+            writer.writeStartObject();
+            writer.writeKeyAndValue("x", point.x());
+            writer.writeKeyAndValue("y", point.y());
+            writer.writeEndObject();
+        }
+
+        writer.writeEndArray();
+    }
+
+    if (object->shape() == MapObject::Ellipse)
+        writer.writeKeyAndValue("ellipse", true);
+
+    // RTB
+    addRTBMapObjectAttributes(writer, object->rtbMapObject());
+
+    writer.writeEndObject();
+}
+
+void MapToJsonWriter::writeImageLayer(JsonStreamWriter &writer,
+                                      const ImageLayer *imageLayer) const
+{
+    writer.writeStartObject();
+    writer.writeKeyAndValue("type", "imagelayer");
+
+    writeLayerAttributes(writer, imageLayer);
+
+    const QString rel = mMapDir.relativeFilePath(imageLayer->imageSource());
+    writer.writeKeyAndValue("image", rel);
+
+    const QColor transColor = imageLayer->transparentColor();
+    if (transColor.isValid())
+        writer.writeKeyAndValue("transparentcolor", transColor.name());
+
+    writer.writeEndObject();
+}
+
+void MapToJsonWriter::writeLayerAttributes(JsonStreamWriter &writer,
+                                           const Layer *layer) const
+{
+    writer.writeKeyAndValue("name", layer->name());
+    writer.writeKeyAndValue("width", layer->width());
+    writer.writeKeyAndValue("height", layer->height());
+    writer.writeKeyAndValue("x", layer->x());
+    writer.writeKeyAndValue("y", layer->y());
+    writer.writeKeyAndValue("visible", layer->isVisible());
+    writer.writeKeyAndValue("opacity", layer->opacity());
+
+    const Properties &properties = layer->properties();
+    if (!properties.isEmpty())
+        writeProperties(writer, properties);
+}
+
+void MapToJsonWriter::addRTBMapAttributes(JsonStreamWriter &writer,
+                                          const RTBMap *rtbMap) const
+{
+    writer.writeKeyAndValue("haserror", rtbMap->hasError());
+    writer.writeKeyAndValue("customglowcolor", rtbMap->customGlowColor().name());
+    writer.writeKeyAndValue("custombackgroundcolor", rtbMap->customBackgroundColor().name());
+    writer.writeKeyAndValue("levelbrightness", rtbMap->levelBrightness());
+    writer.writeKeyAndValue("clouddensity", rtbMap->cloudDensity());
+    writer.writeKeyAndValue("cloudvelocity", rtbMap->cloudVelocity());
+    writer.writeKeyAndValue("cloudalpha", rtbMap->cloudAlpha());
+    writer.writeKeyAndValue("snowdensity", rtbMap->snowDensity());
+    writer.writeKeyAndValue("snowvelocity", rtbMap->snowVelocity());
+    writer.writeKeyAndValue("snowrisingvelocity", rtbMap->snowRisingVelocity());
+    writer.writeKeyAndValue("cameragrain", rtbMap->cameraGrain());
+    writer.writeKeyAndValue("cameracontrast", rtbMap->cameraContrast());
+    writer.writeKeyAndValue("camerasaturation", rtbMap->cameraSaturation());
+    writer.writeKeyAndValue("cameraglow", rtbMap->cameraGlow());
+    writer.writeKeyAndValue("haswalls", rtbMap->hasWall());
+    writer.writeKeyAndValue("levelname", rtbMap->levelName());
+    writer.writeKeyAndValue("leveldescription", rtbMap->levelDescription());
+    writer.writeKeyAndValue("backgroundcolorscheme", rtbMap->backgroundColorScheme());
+    writer.writeKeyAndValue("glowcolorscheme", rtbMap->glowColorScheme());
+    writer.writeKeyAndValue("chapter", rtbMap->chapter());
+    writer.writeKeyAndValue("hasstarfield", rtbMap->hasStarfield());
+    writer.writeKeyAndValue("difficulty", rtbMap->difficulty());
+    writer.writeKeyAndValue("playstyle", rtbMap->playStyle());
+    writer.writeKeyAndValue("workshopid", rtbMap->workShopId());
+    writer.writeKeyAndValue("previewimagepath", rtbMap->previewImagePath());
+}
+
+void MapToJsonWriter::addRTBMapObjectAttributes(JsonStreamWriter &writer,
+                                                const RTBMapObject *rtbMapObject) const
+{
+    writer.writeKeyAndValue("objecttype", rtbMapObject->objectType());
+
+    switch (rtbMapObject->objectType()) {
+    case RTBMapObject::CustomFloorTrap:
+    {
+        const RTBCustomFloorTrap *mapObject = static_cast<const RTBCustomFloorTrap*>(rtbMapObject);
+        writer.writeKeyAndValue("intervalspeed", mapObject->intervalSpeed());
+        writer.writeKeyAndValue("intervaloffset", mapObject->intervalOffset());
+        break;
+    }
+    case RTBMapObject::MovingFloorTrapSpawner:
+    {
+        const RTBMovingFloorTrapSpawner *mapObject = static_cast<const RTBMovingFloorTrapSpawner*>(rtbMapObject);
+        writer.writeKeyAndValue("spawnamount", mapObject->spawnAmount());
+        writer.writeKeyAndValue("intervalspeed", mapObject->intervalSpeed());
+        writer.writeKeyAndValue("randomizestart", mapObject->randomizeStart());
+        break;
+    }
+    case RTBMapObject::Button:
+    {
+        const RTBButtonObject *mapObject = static_cast<const RTBButtonObject*>(rtbMapObject);
+        writer.writeKeyAndValue("beatsactive", mapObject->beatsActive());
+        writer.writeKeyAndValue("laserbeamtargets", mapObject->laserBeamTargets());
+        break;
+    }
+    case RTBMapObject::LaserBeam:
+    {
+        const RTBLaserBeam *mapObject = static_cast<const RTBLaserBeam*>(rtbMapObject);
+        writer.writeKeyAndValue("beamtype", mapObject->beamType());
+        writer.writeKeyAndValue("activatedonstart", mapObject->activatedOnStart());
+        writer.writeKeyAndValue("directiondegrees", mapObject->directionDegrees());
+        writer.writeKeyAndValue("targetdirectiondegrees", mapObject->targetDirectionDegrees());
+        writer.writeKeyAndValue("intervaloffset", mapObject->intervalOffset());
+        writer.writeKeyAndValue("intervalspeed", mapObject->intervalSpeed());
+        break;
+    }
+    case RTBMapObject::ProjectileTurret:
+    {
+        const RTBProjectileTurret *mapObject = static_cast<const RTBProjectileTurret*>(rtbMapObject);
+        writer.writeKeyAndValue("intervalspeed", mapObject->intervalSpeed());
+        writer.writeKeyAndValue("intervaloffset", mapObject->intervalOffset());
+        writer.writeKeyAndValue("projectilespeed", mapObject->projectileSpeed());
+        writer.writeKeyAndValue("shotdirection", mapObject->shotDirection());
+        break;
+    }
+    case RTBMapObject::Teleporter:
+    {
+        const RTBTeleporter *mapObject = static_cast<const RTBTeleporter*>(rtbMapObject);
+        writer.writeKeyAndValue("teleportertarget", mapObject->teleporterTarget().toInt());
+        break;
+    }
+    case RTBMapObject::Target:
+    {
+        return;
+    }
+    case RTBMapObject::FloorText:
+    {
+        const RTBFloorText *mapObject = static_cast<const RTBFloorText*>(rtbMapObject);
+        writer.writeKeyAndValue("text", mapObject->text());
+        writer.writeKeyAndValue("maxcharacters", mapObject->maxCharacters());
+        writer.writeKeyAndValue("triggerzonewidth", mapObject->triggerZoneSize().width());
+        writer.writeKeyAndValue("triggerzoneheight", mapObject->triggerZoneSize().height());
+        writer.writeKeyAndValue("usetrigger", mapObject->useTrigger());
+        writer.writeKeyAndValue("scale", mapObject->scale());
+        writer.writeKeyAndValue("offsetx", mapObject->offsetX());
+        writer.writeKeyAndValue("offsety", mapObject->offsetY());
+        break;
+    }
+    case RTBMapObject::CameraTrigger:
+    {
+        const RTBCameraTrigger *mapObject = static_cast<const RTBCameraTrigger*>(rtbMapObject);
+        writer.writeKeyAndValue("cameratarget", mapObject->target().toInt());
+        writer.writeKeyAndValue("cameratriggerzonewidth", mapObject->triggerZoneSize().width());
+        writer.writeKeyAndValue("cameratriggerzoneheight", mapObject->triggerZoneSize().height());
+        writer.writeKeyAndValue("cameraheight", mapObject->cameraHeight());
+        writer.writeKeyAndValue("cameraangle", mapObject->cameraAngle());
+        break;
+    }
+    case RTBMapObject::StartLocation:
+    case RTBMapObject::FinishHole:
+    {
+        return;
+    }
+    case RTBMapObject::NPCBallSpawner:
+    {
+        const RTBNPCBallSpawner *mapObject = static_cast<const RTBNPCBallSpawner*>(rtbMapObject);
+        writer.writeKeyAndValue("spawnclass", mapObject->spawnClass());
+        writer.writeKeyAndValue("size", mapObject->size());
+        writer.writeKeyAndValue("intervaloffset", mapObject->intervalOffset());
+        writer.writeKeyAndValue("spawnfrequency", mapObject->spawnFrequency());
+        writer.writeKeyAndValue("speed", mapObject->speed());
+        writer.writeKeyAndValue("direction", mapObject->direction());
+        break;
+    }
+    default:
+
+        return;
+    }
+}
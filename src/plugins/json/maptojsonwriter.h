@@ -0,0 +1,82 @@
+/*
+ * JSON Tiled Plugin
+ * Copyright 2011, Porfírio José Pereira Ribeiro <porfirioribeiro@gmail.com>
+ * Copyright 2011, Thorbjørn Lindeijer <thorbjorn@lindeijer.nl>
+ *
+ * This file is part of Tiled.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MAPTOJSONWRITER_H
+#define MAPTOJSONWRITER_H
+
+#include <QDir>
+
+#include "gidmapper.h"
+#include "map.h"
+
+#include "rtbmap.h"
+#include "rtbmapobject.h"
+
+namespace Json {
+
+class JsonStreamWriter;
+
+/**
+ * Writes Map instances as JSON. The document is streamed to a
+ * JsonStreamWriter while the map is traversed, without first building an
+ * intermediate QVariant tree.
+ */
+class MapToJsonWriter
+{
+public:
+    MapToJsonWriter() : mLayerDataFormat(Tiled::Map::CSV) {}
+
+    /**
+     * Writes the given \a map to \a writer. The \a mapDir is used to
+     * construct relative paths to external resources.
+     */
+    void write(JsonStreamWriter &writer, const Tiled::Map *map,
+               const QDir &mapDir);
+
+private:
+    void writeTileset(JsonStreamWriter &writer,
+                      const Tiled::Tileset *tileset, unsigned firstGid) const;
+    void writeProperties(JsonStreamWriter &writer,
+                         const Tiled::Properties &properties) const;
+    void writeTileLayer(JsonStreamWriter &writer,
+                        const Tiled::TileLayer *tileLayer) const;
+    void writeObjectGroup(JsonStreamWriter &writer,
+                          const Tiled::ObjectGroup *objectGroup,
+                          const char *key = 0) const;
+    void writeImageLayer(JsonStreamWriter &writer,
+                         const Tiled::ImageLayer *imageLayer) const;
+    void writeMapObject(JsonStreamWriter &writer,
+                        const Tiled::MapObject *mapObject) const;
+
+    void writeLayerAttributes(JsonStreamWriter &writer,
+                              const Tiled::Layer *layer) const;
+
+    void addRTBMapAttributes(JsonStreamWriter &writer, const Tiled::RTBMap *rtbMap) const;
+    void addRTBMapObjectAttributes(JsonStreamWriter &writer, const Tiled::RTBMapObject *rtbMapObject) const;
+
+    QDir mMapDir;
+    Tiled::GidMapper mGidMapper;
+    Tiled::Map::LayerDataFormat mLayerDataFormat;
+};
+
+} // namespace Json
+
+#endif // MAPTOJSONWRITER_H
@@ -21,6 +21,8 @@
 
 #include "varianttomapconverter.h"
 
+#include "compression.h"
+#include "imagecache.h"
 #include "imagelayer.h"
 #include "map.h"
 #include "mapobject.h"
@@ -32,6 +34,8 @@
 
 #include <QScopedPointer>
 
+#include <climits>
+
 using namespace Tiled;
 using namespace Json;
 
@@ -219,7 +223,9 @@ SharedTileset VariantToMapConverter::toTileset(const QVariant &variant)
             imageVariant = tileVar["image"];
             if (!imageVariant.isNull()) {
                 QString imagePath = resolvePath(mMapDir, imageVariant);
-                tileset->setTileImage(tileIndex, QPixmap(imagePath), imagePath);
+                const QImage image = ImageCache::instance()->image(imagePath);
+                tileset->setTileImage(tileIndex, QPixmap::fromImage(image),
+                                      imagePath);
             }
             QVariantMap objectGroupVariant = tileVar["objectgroup"].toMap();
             if (!objectGroupVariant.isEmpty())
@@ -277,18 +283,14 @@ TileLayer *VariantToMapConverter::toTileLayer(const QVariantMap &variantMap)
     const QString name = variantMap["name"].toString();
     const int width = variantMap["width"].toInt();
     const int height = variantMap["height"].toInt();
-    const QVariantList dataVariantList = variantMap["data"].toList();
-
-    if (dataVariantList.size() != width * height) {
-        mError = tr("Corrupt layer data for layer '%1'").arg(name);
-        return 0;
-    }
+    const QVariant dataVariant = variantMap["data"];
 
+    // The cells are only allocated once the data is known to contain them
     typedef QScopedPointer<TileLayer> TileLayerPtr;
     TileLayerPtr tileLayer(new TileLayer(name,
                                          variantMap["x"].toInt(),
                                          variantMap["y"].toInt(),
-                                         width, height));
+                                         0, 0));
 
     const qreal opacity = variantMap["opacity"].toReal();
     const bool visible = variantMap["visible"].toBool();
@@ -296,16 +298,84 @@ TileLayer *VariantToMapConverter::toTileLayer(const QVariantMap &variantMap)
     tileLayer->setOpacity(opacity);
     tileLayer->setVisible(visible);
 
+    // The size of the layer data needs to fit in a QByteArray
+    if (width < 0 || height < 0 ||
+            qint64(width) * qint64(height) * 4 > INT_MAX) {
+        mError = tr("Corrupt layer data for layer '%1'").arg(name);
+        return 0;
+    }
+
+    const QSize size(width, height);
+    const QString encoding = variantMap["encoding"].toString();
+    const QString compression = variantMap["compression"].toString();
+
+    if (encoding.isEmpty()) {
+        mMap->setLayerDataFormat(Map::CSV);
+
+        if (!readPlainLayerData(tileLayer.data(), size, dataVariant))
+            return 0;
+    } else if (encoding == QLatin1String("base64")) {
+        if (compression.isEmpty())
+            mMap->setLayerDataFormat(Map::Base64);
+        else if (compression == QLatin1String("gzip"))
+            mMap->setLayerDataFormat(Map::Base64Gzip);
+        else if (compression == QLatin1String("zlib"))
+            mMap->setLayerDataFormat(Map::Base64Zlib);
+
+        if (!readBase64LayerData(tileLayer.data(), size, dataVariant,
+                                 compression))
+            return 0;
+    } else {
+        mError = tr("Unknown encoding: %1").arg(encoding);
+        return 0;
+    }
+
+    return tileLayer.take();
+}
+
+bool VariantToMapConverter::readPlainLayerData(TileLayer *tileLayer,
+                                               const QSize &size,
+                                               const QVariant &dataVariant)
+{
+    const int width = size.width();
+    const int height = size.height();
+
+    // The layer data was either read as a plain list of global tile IDs,
+    // or as a list of variants.
+    const bool isGidList = dataVariant.userType() == qMetaTypeId<GidList>();
+    const QVector<unsigned> gids = isGidList ? dataVariant.value<GidList>().gids
+                                             : QVector<unsigned>();
+    const QVariantList dataVariantList = isGidList ? QVariantList()
+                                                   : dataVariant.toList();
+    const int dataSize = isGidList ? gids.size() : dataVariantList.size();
+
+    if (dataSize != width * height) {
+        mError = tr("Corrupt layer data for layer '%1'").arg(tileLayer->name());
+        return false;
+    }
+
+    tileLayer->resize(size, QPoint());
+
+    bool ok;
+
+    if (isGidList) {
+        const unsigned *gid = gids.constData();
+        for (int y = 0; y < height; ++y)
+            for (int x = 0; x < width; ++x)
+                tileLayer->setCell(x, y, mGidMapper.gidToCell(*gid++, ok));
+
+        return true;
+    }
+
     int x = 0;
     int y = 0;
-    bool ok;
 
     foreach (const QVariant &gidVariant, dataVariantList) {
         const unsigned gid = gidVariant.toUInt(&ok);
         if (!ok) {
             mError = tr("Unable to parse tile at (%1,%2) on layer '%3'")
                     .arg(x).arg(y).arg(tileLayer->name());
-            return 0;
+            return false;
         }
 
         const Cell cell = mGidMapper.gidToCell(gid, ok);
@@ -319,7 +389,63 @@ TileLayer *VariantToMapConverter::toTileLayer(const QVariantMap &variantMap)
         }
     }
 
-    return tileLayer.take();
+    return true;
+}
+
+bool VariantToMapConverter::readBase64LayerData(TileLayer *tileLayer,
+                                                const QSize &layerSize,
+                                                const QVariant &dataVariant,
+                                                const QString &compression)
+{
+    QByteArray tileData = QByteArray::fromBase64(dataVariant.toString().toLatin1());
+
+    // Checked by toTileLayer() to fit in an int
+    const int size = int(qint64(layerSize.width()) * layerSize.height() * 4);
+
+    if (compression == QLatin1String("zlib")
+        || compression == QLatin1String("gzip")) {
+        // Deflate compresses by at most 1032:1, so anything that claims more
+        // is corrupt and should not make us allocate the claimed size
+        if (size / 1032 > tileData.length()) {
+            mError = tr("Corrupt layer data for layer '%1'").arg(tileLayer->name());
+            return false;
+        }
+
+        tileData = decompress(tileData, size);
+    } else if (!compression.isEmpty()) {
+        mError = tr("Compression method '%1' not supported").arg(compression);
+        return false;
+    }
+
+    if (size != tileData.length()) {
+        mError = tr("Corrupt layer data for layer '%1'").arg(tileLayer->name());
+        return false;
+    }
+
+    tileLayer->resize(layerSize, QPoint());
+
+    const unsigned char *data =
+            reinterpret_cast<const unsigned char*>(tileData.constData());
+    int x = 0;
+    int y = 0;
+    bool ok;
+
+    for (int i = 0; i < size - 3; i += 4) {
+        const unsigned gid = data[i] |
+                             data[i + 1] << 8 |
+                             data[i + 2] << 16 |
+                             data[i + 3] << 24;
+
+        tileLayer->setCell(x, y, mGidMapper.gidToCell(gid, ok));
+
+        x++;
+        if (x == tileLayer->width()) {
+            x = 0;
+            y++;
+        }
+    }
+
+    return true;
 }
 
 ObjectGroup *VariantToMapConverter::toObjectGroup(const QVariantMap &variantMap)
@@ -433,7 +559,7 @@ ImageLayer *VariantToMapConverter::toImageLayer(const QVariantMap &variantMap)
 
     if (!imageVariant.isNull()) {
         QString imagePath = resolvePath(mMapDir, imageVariant);
-        if (!imageLayer->loadFromImage(QImage(imagePath), imagePath)) {
+        if (!imageLayer->loadFromImage(ImageCache::instance()->image(imagePath), imagePath)) {
             mError = tr("Error loading image:\n'%1'").arg(imagePath);
             return 0;
         }
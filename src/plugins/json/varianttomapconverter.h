@@ -27,6 +27,7 @@
 #include <QCoreApplication>
 #include <QDir>
 #include <QVariant>
+#include <QVector>
 
 namespace Tiled {
 class Layer;
@@ -40,6 +41,16 @@ class RTBMapObject;
 
 namespace Json {
 
+/**
+ * Tile layer data that has already been read as a list of global tile IDs.
+ * It can be stored as the "data" of a tile layer variant instead of a list
+ * of numbers, to avoid storing a QVariant for each tile.
+ */
+struct GidList
+{
+    QVector<unsigned> gids;
+};
+
 /**
  * Converts a QVariant to a Map instance. Meant to be used together with
  * JsonReader.
@@ -71,6 +82,13 @@ private:
     Tiled::SharedTileset toTileset(const QVariant &variant);
     Tiled::Layer *toLayer(const QVariant &variant);
     Tiled::TileLayer *toTileLayer(const QVariantMap &variantMap);
+    bool readPlainLayerData(Tiled::TileLayer *tileLayer,
+                            const QSize &size,
+                            const QVariant &dataVariant);
+    bool readBase64LayerData(Tiled::TileLayer *tileLayer,
+                             const QSize &size,
+                             const QVariant &dataVariant,
+                             const QString &compression);
     Tiled::ObjectGroup *toObjectGroup(const QVariantMap &variantMap);
     Tiled::ImageLayer *toImageLayer(const QVariantMap &variantMap);
 
@@ -87,4 +105,6 @@ private:
 
 } // namespace Json
 
+Q_DECLARE_METATYPE(Json::GidList)
+
 #endif // VARIANTTOMAPCONVERTER_H
@@ -22,6 +22,7 @@
 
 #include "luatablewriter.h"
 
+#include "compression.h"
 #include "imagelayer.h"
 #include "map.h"
 #include "mapobject.h"
@@ -337,16 +338,50 @@ void LuaPlugin::writeTileLayer(LuaTableWriter &writer,
     writer.writeKeyAndValue("opacity", tileLayer->opacity());
     writeProperties(writer, tileLayer->properties());
 
-    writer.writeKeyAndValue("encoding", "lua");
-    writer.writeStartTable("data");
-    for (int y = 0; y < tileLayer->height(); ++y) {
-        if (y > 0)
-            writer.prepareNewLine();
+    // The layer data is written base64 encoded when the map asks for it
+    const Map::LayerDataFormat format = tileLayer->map()->layerDataFormat();
+
+    if (format == Map::Base64
+            || format == Map::Base64Gzip
+            || format == Map::Base64Zlib) {
+        writer.writeKeyAndValue("encoding", "base64");
+
+        if (format == Map::Base64Gzip)
+            writer.writeKeyAndValue("compression", "gzip");
+        else if (format == Map::Base64Zlib)
+            writer.writeKeyAndValue("compression", "zlib");
+
+        QByteArray tileData(tileLayer->width() * tileLayer->height() * 4, '\0');
+        uchar *bytes = reinterpret_cast<uchar*>(tileData.data());
+
+        for (int y = 0; y < tileLayer->height(); ++y) {
+            for (int x = 0; x < tileLayer->width(); ++x) {
+                const unsigned gid = mGidMapper.cellToGid(tileLayer->cellAt(x, y));
+                *bytes++ = uchar(gid);
+                *bytes++ = uchar(gid >> 8);
+                *bytes++ = uchar(gid >> 16);
+                *bytes++ = uchar(gid >> 24);
+            }
+        }
 
-        for (int x = 0; x < tileLayer->width(); ++x)
-            writer.writeValue(mGidMapper.cellToGid(tileLayer->cellAt(x, y)));
+        if (format == Map::Base64Gzip)
+            tileData = compress(tileData, Gzip);
+        else if (format == Map::Base64Zlib)
+            tileData = compress(tileData, Zlib);
+
+        writer.writeKeyAndValue("data", tileData.toBase64());
+    } else {
+        writer.writeKeyAndValue("encoding", "lua");
+        writer.writeStartTable("data");
+        for (int y = 0; y < tileLayer->height(); ++y) {
+            if (y > 0)
+                writer.prepareNewLine();
+
+            for (int x = 0; x < tileLayer->width(); ++x)
+                writer.writeValue(mGidMapper.cellToGid(tileLayer->cellAt(x, y)));
+        }
+        writer.writeEndTable();
     }
-    writer.writeEndTable();
 
     writer.writeEndTable();
 }
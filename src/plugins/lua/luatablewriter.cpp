@@ -20,18 +20,15 @@
 
 #include "luatablewriter.h"
 
-#include <QIODevice>
-
 namespace Lua {
 
 LuaTableWriter::LuaTableWriter(QIODevice *device)
-    : m_device(device)
+    : m_out(device)
     , m_indent(0)
     , m_valueSeparator(',')
     , m_suppressNewlines(false)
     , m_newLine(true)
     , m_valueWritten(false)
-    , m_error(false)
 {
 }
 
@@ -44,6 +41,12 @@ void LuaTableWriter::writeEndDocument()
 {
     Q_ASSERT(m_indent == 0);
     write('\n');
+    flush();
+}
+
+bool LuaTableWriter::flush()
+{
+    return m_out.flush();
 }
 
 void LuaTableWriter::writeStartTable()
@@ -67,7 +70,8 @@ void LuaTableWriter::writeStartReturnTable()
 void LuaTableWriter::writeStartTable(const QByteArray &name)
 {
     prepareNewLine();
-    write(name + " = {");
+    write(name);
+    write(" = {");
     ++m_indent;
     m_newLine = false;
     m_valueWritten = false;
@@ -93,10 +97,10 @@ void LuaTableWriter::writeValue(const QByteArray &value)
     m_valueWritten = true;
 }
 
-void LuaTableWriter::writeUnquotedValue(const QByteArray &value)
+void LuaTableWriter::writeUnquotedValue(const char *value, int length)
 {
     prepareNewValue();
-    write(value);
+    write(value, length);
     m_newLine = false;
     m_valueWritten = true;
 }
@@ -137,6 +141,26 @@ void LuaTableWriter::writeQuotedKeyAndValue(const QString &key,
     m_valueWritten = true;
 }
 
+void LuaTableWriter::writeKeyAndValue(const QByteArray &key, int value)
+{
+    prepareNewLine();
+    write(key);
+    write(" = ");
+    m_out.writeNumber(value);
+    m_newLine = false;
+    m_valueWritten = true;
+}
+
+void LuaTableWriter::writeKeyAndValue(const QByteArray &key, unsigned value)
+{
+    prepareNewLine();
+    write(key);
+    write(" = ");
+    m_out.writeNumber(value);
+    m_newLine = false;
+    m_valueWritten = true;
+}
+
 void LuaTableWriter::writeKeyAndUnquotedValue(const QByteArray &key,
                                               const QByteArray &value)
 {
@@ -208,10 +232,4 @@ void LuaTableWriter::writeNewline()
     }
 }
 
-void LuaTableWriter::write(const char *bytes, unsigned length)
-{
-    if (m_device->write(bytes, length) != length)
-        m_error = true;
-}
-
 } // namespace Lua
@@ -21,6 +21,8 @@
 #ifndef LUATABLEWRITER_H
 #define LUATABLEWRITER_H
 
+#include "bufferedwriter.h"
+
 #include <QByteArray>
 #include <QString>
 
@@ -50,6 +52,7 @@ public:
     void writeValue(const QString &value);
 
     void writeUnquotedValue(const QByteArray &value);
+    void writeUnquotedValue(const char *value, int length);
 
     void writeKeyAndValue(const QByteArray &key, int value);
     void writeKeyAndValue(const QByteArray &key, unsigned value);
@@ -68,7 +71,12 @@ public:
 
     void prepareNewLine();
 
-    bool hasError() const { return m_error; }
+    /**
+     * Writes any buffered output to the device. Called by writeEndDocument().
+     */
+    bool flush();
+
+    bool hasError() const { return m_out.hasError(); }
 
     static QString quote(const QString &str);
 
@@ -82,29 +90,35 @@ private:
     void write(const QByteArray &bytes);
     void write(char c);
 
-    QIODevice *m_device;
+    Tiled::BufferedWriter m_out;
     int m_indent;
     char m_valueSeparator;
     bool m_suppressNewlines;
     bool m_newLine;
     bool m_valueWritten;
-    bool m_error;
 };
 
 inline void LuaTableWriter::writeValue(int value)
-{ writeUnquotedValue(QByteArray::number(value)); }
+{
+    prepareNewValue();
+    m_out.writeNumber(value);
+    m_newLine = false;
+    m_valueWritten = true;
+}
 
 inline void LuaTableWriter::writeValue(unsigned value)
-{ writeUnquotedValue(QByteArray::number(value)); }
+{
+    prepareNewValue();
+    m_out.writeNumber(value);
+    m_newLine = false;
+    m_valueWritten = true;
+}
 
 inline void LuaTableWriter::writeValue(const QString &value)
 { writeUnquotedValue(quote(value).toUtf8()); }
 
-inline void LuaTableWriter::writeKeyAndValue(const QByteArray &key, int value)
-{ writeKeyAndUnquotedValue(key, QByteArray::number(value)); }
-
-inline void LuaTableWriter::writeKeyAndValue(const QByteArray &key, unsigned value)
-{ writeKeyAndUnquotedValue(key, QByteArray::number(value)); }
+inline void LuaTableWriter::writeUnquotedValue(const QByteArray &value)
+{ writeUnquotedValue(value.constData(), value.length()); }
 
 inline void LuaTableWriter::writeKeyAndValue(const QByteArray &key, double value)
 { writeKeyAndUnquotedValue(key, QByteArray::number(value)); }
@@ -115,14 +129,17 @@ inline void LuaTableWriter::writeKeyAndValue(const QByteArray &key, bool value)
 inline void LuaTableWriter::writeKeyAndValue(const QByteArray &key, const QString &value)
 { writeKeyAndUnquotedValue(key, quote(value).toUtf8()); }
 
+inline void LuaTableWriter::write(const char *bytes, unsigned length)
+{ m_out.write(bytes, length); }
+
 inline void LuaTableWriter::write(const char *bytes)
-{ write(bytes, qstrlen(bytes)); }
+{ m_out.write(bytes); }
 
 inline void LuaTableWriter::write(const QByteArray &bytes)
-{ write(bytes.constData(), bytes.length()); }
+{ m_out.write(bytes); }
 
 inline void LuaTableWriter::write(char c)
-{ write(&c, 1); }
+{ m_out.write(c); }
 
 /**
  * Sets whether newlines should be suppressed. While newlines are suppressed,
@@ -28,6 +28,10 @@
 #include "rtbchangemapobjectproperties.h"
 
 #include <QCoreApplication>
+#include <QHash>
+#include <QSet>
+
+#include <algorithm>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
@@ -243,3 +247,165 @@ RemoveMapObject::RemoveMapObject(MapDocument *mapDocument,
 {
     setText(QCoreApplication::translate("Undo Commands", "Remove Object"));
 }
+
+
+namespace {
+
+/**
+ * The position of an object that is added or removed.
+ */
+struct ObjectPosition
+{
+    ObjectGroup *group;
+    int index;
+    MapObject *object;
+};
+
+/**
+ * Orders by object group and index, with objects to append (index -1) at the
+ * end of their group.
+ */
+bool ascending(const ObjectPosition &a, const ObjectPosition &b)
+{
+    if (a.group != b.group)
+        return a.group < b.group;
+    const uint indexA = a.index;    // -1 becomes the largest index
+    const uint indexB = b.index;
+    return indexA < indexB;
+}
+
+bool descending(const ObjectPosition &a, const ObjectPosition &b)
+{
+    if (a.group != b.group)
+        return a.group < b.group;
+    return a.index > b.index;
+}
+
+} // anonymous namespace
+
+AddRemoveMapObjects::AddRemoveMapObjects(MapDocument *mapDocument,
+                                         QUndoCommand *parent)
+    : QUndoCommand(parent)
+    , mMapDocument(mapDocument)
+{
+}
+
+void AddRemoveMapObjects::addObjects()
+{
+    QList<ObjectPosition> positions;
+    positions.reserve(mCommands.size());
+    foreach (AddRemoveMapObject *command, mCommands) {
+        ObjectPosition position = { command->mObjectGroup,
+                                    command->mIndex,
+                                    command->mMapObject };
+        positions.append(position);
+    }
+
+    // Inserting in order of increasing index puts each object back at its
+    // original index. Consecutive indexes are inserted as a single range.
+    std::stable_sort(positions.begin(), positions.end(), ascending);
+
+    MapObjectModel *model = mMapDocument->mapObjectModel();
+
+    int first = 0;
+    while (first < positions.size()) {
+        const ObjectPosition &start = positions.at(first);
+        QList<MapObject*> objects;
+        objects.append(start.object);
+
+        int next = first + 1;
+        for (; next < positions.size(); ++next) {
+            const ObjectPosition &position = positions.at(next);
+            if (position.group != start.group)
+                break;
+            if (start.index != -1 && position.index != start.index + next - first)
+                break;
+            objects.append(position.object);
+        }
+
+        model->insertObjects(start.group, start.index, objects);
+        first = next;
+    }
+
+    foreach (AddRemoveMapObject *command, mCommands) {
+        command->mOwnsObject = false;
+        command->updateRelatedObjectsAdd();
+    }
+}
+
+void AddRemoveMapObjects::removeObjects()
+{
+    QHash<MapObject*, int> indexes;
+    QSet<ObjectGroup*> indexedGroups;
+
+    QList<ObjectPosition> positions;
+    positions.reserve(mCommands.size());
+    foreach (AddRemoveMapObject *command, mCommands) {
+        ObjectGroup *objectGroup = command->mObjectGroup;
+        if (!indexedGroups.contains(objectGroup)) {
+            const QList<MapObject*> &objects = objectGroup->objects();
+            for (int i = 0; i < objects.size(); ++i)
+                indexes.insert(objects.at(i), i);
+            indexedGroups.insert(objectGroup);
+        }
+
+        command->mIndex = indexes.value(command->mMapObject);
+
+        ObjectPosition position = { objectGroup,
+                                    command->mIndex,
+                                    command->mMapObject };
+        positions.append(position);
+    }
+
+    // Removing in order of decreasing index keeps the remaining indexes
+    // valid. Consecutive indexes are removed as a single range.
+    std::sort(positions.begin(), positions.end(), descending);
+
+    MapObjectModel *model = mMapDocument->mapObjectModel();
+
+    int first = 0;
+    while (first < positions.size()) {
+        const ObjectPosition &start = positions.at(first);
+
+        int next = first + 1;
+        for (; next < positions.size(); ++next) {
+            const ObjectPosition &position = positions.at(next);
+            if (position.group != start.group ||
+                    position.index != start.index - (next - first))
+                break;
+        }
+
+        const int count = next - first;
+        model->removeObjects(start.group, start.index - count + 1, count);
+        first = next;
+    }
+
+    foreach (AddRemoveMapObject *command, mCommands) {
+        command->mOwnsObject = true;
+        command->updateRelatedObjectsRemove();
+    }
+}
+
+AddMapObjects::AddMapObjects(MapDocument *mapDocument,
+                             ObjectGroup *objectGroup,
+                             const QList<MapObject*> &mapObjects,
+                             QUndoCommand *parent)
+    : AddRemoveMapObjects(mapDocument, parent)
+{
+    foreach (MapObject *mapObject, mapObjects)
+        mCommands.append(new AddMapObject(mapDocument, objectGroup,
+                                          mapObject, this));
+
+    setText(QCoreApplication::translate("Undo Commands", "Add Objects"));
+}
+
+RemoveMapObjects::RemoveMapObjects(MapDocument *mapDocument,
+                                   const QList<MapObject*> &mapObjects,
+                                   QUndoCommand *parent)
+    : AddRemoveMapObjects(mapDocument, parent)
+{
+    foreach (MapObject *mapObject, mapObjects)
+        mCommands.append(new RemoveMapObject(mapDocument, mapObject, this));
+
+    setText(QCoreApplication::translate("Undo Commands", "Remove Objects"));
+}
@@ -50,6 +50,8 @@ protected:
     void removeObject();
 
 private:
+    friend class AddRemoveMapObjects;
+
     /**
      * remove the target properties of the related objects
      */
@@ -101,6 +103,63 @@ public:
     { removeObject(); }
 };
 
+/**
+ * Abstract base class for AddMapObjects and RemoveMapObjects. Adds or removes
+ * a number of objects at once, so that the map object model can report
+ * consecutive objects as a single range of rows.
+ */
+class AddRemoveMapObjects : public QUndoCommand
+{
+public:
+    AddRemoveMapObjects(MapDocument *mapDocument, QUndoCommand *parent = 0);
+
+protected:
+    void addObjects();
+    void removeObjects();
+
+    MapDocument *mMapDocument;
+
+    /**
+     * The commands for the individual objects, which are owned as children
+     * but never executed through QUndoCommand::redo or undo.
+     */
+    QList<AddRemoveMapObject*> mCommands;
+};
+
+/**
+ * Undo command that adds a number of objects to an object group.
+ */
+class AddMapObjects : public AddRemoveMapObjects
+{
+public:
+    AddMapObjects(MapDocument *mapDocument, ObjectGroup *objectGroup,
+                  const QList<MapObject*> &mapObjects,
+                  QUndoCommand *parent = 0);
+
+    void undo()
+    { removeObjects(); }
+
+    void redo()
+    { addObjects(); }
+};
+
+/**
+ * Undo command that removes a number of objects from their object groups.
+ */
+class RemoveMapObjects : public AddRemoveMapObjects
+{
+public:
+    RemoveMapObjects(MapDocument *mapDocument,
+                     const QList<MapObject*> &mapObjects,
+                     QUndoCommand *parent = 0);
+
+    void undo()
+    { addObjects(); }
+
+    void redo()
+    { removeObjects(); }
+};
+
 } // namespace Internal
 } // namespace Tiled
 
@@ -36,6 +36,7 @@
 #include "tile.h"
 #include "tilelayer.h"
 #include "tilesetmanager.h"
+#include "tracing.h"
 
 #include <QDebug>
 
@@ -443,6 +444,8 @@ bool AutoMapper::setupTilesets(Map *src, Map *dst)
 
 void AutoMapper::autoMap(QRegion *where)
 {
+    TILED_TRACE("AutoMapper::autoMap");
+
     Q_ASSERT(mRulesInput.size() == mRulesOutput.size());
     // first resize the active area
     if (mAutoMappingRadius) {
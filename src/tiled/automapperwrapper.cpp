@@ -46,26 +46,28 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
             autoMapper.remove(index);
         }
     }
+    QVector<TileLayer*> layersBefore;
     foreach (const QString &layerName, touchedLayers) {
         const int layerindex = map->indexOfLayer(layerName);
         Q_ASSERT(layerindex != -1);
-        mLayersBefore << static_cast<TileLayer*>(map->layerAt(layerindex)->clone());
+        layersBefore << static_cast<TileLayer*>(map->layerAt(layerindex)->clone());
     }
 
     foreach (AutoMapper *a, autoMapper)
         a->autoMap(where);
 
+    QVector<TileLayer*> layersAfter;
     foreach (const QString &layerName, touchedLayers) {
         const int layerindex = map->indexOfLayer(layerName);
         // layer index exists, because AutoMapper is still alive, don't check
         Q_ASSERT(layerindex != -1);
-        mLayersAfter << static_cast<TileLayer*>(map->layerAt(layerindex)->clone());
+        layersAfter << static_cast<TileLayer*>(map->layerAt(layerindex)->clone());
     }
     // reduce memory usage by saving only diffs
-    Q_ASSERT(mLayersAfter.size() == mLayersBefore.size());
-    for (int i = 0; i < mLayersAfter.size(); ++i) {
-        TileLayer *before = mLayersBefore.at(i);
-        TileLayer *after = mLayersAfter.at(i);
+    Q_ASSERT(layersAfter.size() == layersBefore.size());
+    for (int i = 0; i < layersAfter.size(); ++i) {
+        TileLayer *before = layersBefore.at(i);
+        TileLayer *after = layersAfter.at(i);
         QRect diffRegion = before->computeDiffRegion(after).boundingRect();
 
         TileLayer *before1 = before->copy(diffRegion);
@@ -75,8 +77,8 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
         after1->setPosition(diffRegion.topLeft());
         before1->setName(before->name());
         after1->setName(after->name());
-        mLayersBefore.replace(i, before1);
-        mLayersAfter.replace(i, after1);
+        mLayersBefore.append(new CompressedTileLayer(before1));
+        mLayersAfter.append(new CompressedTileLayer(after1));
 
         delete before;
         delete after;
@@ -89,34 +91,30 @@ AutoMapperWrapper::AutoMapperWrapper(MapDocument *mapDocument,
 
 AutoMapperWrapper::~AutoMapperWrapper()
 {
-    QVector<TileLayer*>::iterator i;
-    for (i = mLayersAfter.begin(); i != mLayersAfter.end(); ++i)
-        delete *i;
-    for (i = mLayersBefore.begin(); i != mLayersBefore.end(); ++i)
-        delete *i;
+    qDeleteAll(mLayersAfter);
+    qDeleteAll(mLayersBefore);
 }
 
 void AutoMapperWrapper::undo()
 {
     Map *map = mMapDocument->map();
-    QVector<TileLayer*>::iterator i;
-    for (i = mLayersBefore.begin(); i != mLayersBefore.end(); ++i) {
-        const int layerindex = map->indexOfLayer((*i)->name());
+    foreach (CompressedTileLayer *layerBefore, mLayersBefore) {
+        TileLayer *layer = layerBefore->layer();
+        const int layerindex = map->indexOfLayer(layer->name());
         if (layerindex != -1)
-            patchLayer(layerindex, *i);
+            patchLayer(layerindex, layer);
     }
 }
 
 void AutoMapperWrapper::redo()
 {
     Map *map = mMapDocument->map();
-    QVector<TileLayer*>::iterator i;
-    for (i = mLayersAfter.begin(); i != mLayersAfter.end(); ++i) {
-        const int layerindex = (map->indexOfLayer((*i)->name()));
+    foreach (CompressedTileLayer *layerAfter, mLayersAfter) {
+        TileLayer *layer = layerAfter->layer();
+        const int layerindex = map->indexOfLayer(layer->name());
         if (layerindex != -1)
-            patchLayer(layerindex, *i);
+            patchLayer(layerindex, layer);
     }
-
 }
 
 void AutoMapperWrapper::patchLayer(int layerIndex, TileLayer *layer)
@@ -131,3 +129,21 @@ void AutoMapperWrapper::patchLayer(int layerIndex, TileLayer *layer)
                 b.translated(-t->position()));
     mMapDocument->emitRegionChanged(b);
 }
+
+void AutoMapperWrapper::compressPayload()
+{
+    foreach (CompressedTileLayer *layer, mLayersBefore)
+        layer->compress();
+    foreach (CompressedTileLayer *layer, mLayersAfter)
+        layer->compress();
+}
+
+qint64 AutoMapperWrapper::payloadSize() const
+{
+    qint64 size = 0;
+    foreach (const CompressedTileLayer *layer, mLayersBefore)
+        size += layer->memoryUsage();
+    foreach (const CompressedTileLayer *layer, mLayersAfter)
+        size += layer->memoryUsage();
+    return size;
+}
@@ -22,6 +22,7 @@
 #define AUTOMAPPERWRAPPER_H
 
 #include "automapper.h"
+#include "compressedtilelayer.h"
 
 #include <QUndoCommand>
 #include <QVector>
@@ -39,7 +40,7 @@ class MapDocument;
  * This class will take a snapshot of the layers before and after the
  * automapping is done. In between instances of AutoMapper are doing the work.
  */
-class AutoMapperWrapper : public QUndoCommand
+class AutoMapperWrapper : public QUndoCommand, public CompressibleCommand
 {
 public:
     AutoMapperWrapper(MapDocument *mapDocument, QVector<AutoMapper*> autoMapper,
@@ -49,12 +50,15 @@ public:
     void undo();
     void redo();
 
+    void compressPayload();
+    qint64 payloadSize() const;
+
 private:
     void patchLayer(int layerIndex, TileLayer *layer);
 
     MapDocument *mMapDocument;
-    QVector<TileLayer*> mLayersAfter;
-    QVector<TileLayer*> mLayersBefore;
+    QVector<CompressedTileLayer*> mLayersAfter;
+    QVector<CompressedTileLayer*> mLayersBefore;
 };
 
 } // namespace Internal
@@ -61,6 +61,18 @@ void BrushItem::setTileLayer(const SharedTileLayer &tileLayer)
     update();
 }
 
+void BrushItem::tileLayerChanged(const QRegion &changedRegion)
+{
+    if (!mTileLayer || !mMapDocument || changedRegion.isEmpty())
+        return;
+
+    mRegion = mTileLayer->region();
+    updateBoundingRect();
+
+    foreach (const QRect &rect, changedRegion.rects())
+        update(tilesBoundingRect(rect));
+}
+
 void BrushItem::setTileLayerPosition(const QPoint &pos)
 {
     if (!mTileLayer)
@@ -83,6 +95,7 @@ void BrushItem::setTileRegion(const QRegion &region)
 
     mRegion = region;
     updateBoundingRect();
+    update();
 }
 
 QRectF BrushItem::boundingRect() const
@@ -122,15 +135,25 @@ void BrushItem::paint(QPainter *painter,
 
 void BrushItem::updateBoundingRect()
 {
-    prepareGeometryChange();
+    QRectF boundingRect;
+    if (mMapDocument)
+        boundingRect = tilesBoundingRect(mRegion.boundingRect());
 
-    if (!mMapDocument) {
-        mBoundingRect = QRectF();
+    // Avoid invalidating the whole item when only its contents changed
+    if (boundingRect == mBoundingRect)
         return;
-    }
 
-    const QRect bounds = mRegion.boundingRect();
-    mBoundingRect = mMapDocument->renderer()->boundingRect(bounds);
+    prepareGeometryChange();
+    mBoundingRect = boundingRect;
+}
+
+/**
+ * Returns the area in pixels covered by the tiles in \a tileRect, taking
+ * into account the amount of pixels the tiles extend outside of their cells.
+ */
+QRectF BrushItem::tilesBoundingRect(const QRect &tileRect) const
+{
+    QRectF boundingRect = mMapDocument->renderer()->boundingRect(tileRect);
 
     // Adjust for amount of pixels tiles extend at the top and to the right
     if (mTileLayer) {
@@ -142,9 +165,11 @@ void BrushItem::updateBoundingRect()
 
         // Since we're also drawing a tile selection, we should not apply
         // negative margins
-        mBoundingRect.adjust(qMin(0, -drawMargins.left()),
-                             qMin(0, -drawMargins.top()),
-                             qMax(0, drawMargins.right()),
-                             qMax(0, drawMargins.bottom()));
+        boundingRect.adjust(qMin(0, -drawMargins.left()),
+                            qMin(0, -drawMargins.top()),
+                            qMax(0, drawMargins.right()),
+                            qMax(0, drawMargins.bottom()));
     }
+
+    return boundingRect;
 }
@@ -64,6 +64,12 @@ public:
      */
     const SharedTileLayer &tileLayer() const { return mTileLayer; }
 
+    /**
+     * Notifies the brush item that the cells in \a changedRegion of its tile
+     * layer have been changed in place. Only the changed area is repainted.
+     */
+    void tileLayerChanged(const QRegion &changedRegion);
+
     /**
      * Changes the position of the tile layer, if one is set.
      */
@@ -88,6 +94,7 @@ public:
 
 private:
     void updateBoundingRect();
+    QRectF tilesBoundingRect(const QRect &tileRect) const;
 
     MapDocument *mMapDocument;
     SharedTileLayer mTileLayer;
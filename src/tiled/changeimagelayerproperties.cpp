@@ -23,6 +23,7 @@
 #include "changeimagelayerproperties.h"
 
 #include "mapdocument.h"
+#include "imagecache.h"
 #include "imagelayer.h"
 
 #include <QCoreApplication>
@@ -54,7 +55,7 @@ void ChangeImageLayerProperties::redo()
     if (mRedoPath.isEmpty())
         mImageLayer->resetImage();
     else
-        mImageLayer->loadFromImage(QImage(mRedoPath), mRedoPath);
+        mImageLayer->loadFromImage(ImageCache::instance()->image(mRedoPath), mRedoPath);
 
     mMapDocument->emitImageLayerChanged(mImageLayer);
 }
@@ -66,7 +67,7 @@ void ChangeImageLayerProperties::undo()
     if (mUndoPath.isEmpty())
         mImageLayer->resetImage();
     else
-        mImageLayer->loadFromImage(QImage(mUndoPath), mUndoPath);
+        mImageLayer->loadFromImage(ImageCache::instance()->image(mUndoPath), mUndoPath);
 
     mMapDocument->emitImageLayerChanged(mImageLayer);
 }
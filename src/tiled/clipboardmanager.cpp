@@ -246,14 +246,17 @@ void ClipboardManager::pasteObjectGroup(const ObjectGroup *objectGroup,
             MapObject *objectClone = mapObject->clone();
             objectClone->setPosition(newPosition);
             pastedObjects.append(objectClone);
-            undoStack->push(new AddMapObject(mapDocument,
-                                             currentObjectGroup,
-                                             objectClone));
-
             mPastedObjects.append(objectClone);
         }
     }
 
+    // Adding the objects at once avoids updating the views for each object
+    if (!pastedObjects.isEmpty()) {
+        undoStack->push(new AddMapObjects(mapDocument,
+                                          currentObjectGroup,
+                                          pastedObjects));
+    }
+
     restoreConnections(mapDocument);
 
     undoStack->endMacro();
@@ -0,0 +1,181 @@
+/*
+ * compressedtilelayer.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "compressedtilelayer.h"
+
+#include "compression.h"
+#include "tilelayer.h"
+
+#include <QHash>
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+// Same flags as used for the global tile IDs when saving a map
+static const unsigned FlippedHorizontallyFlag   = 0x80000000;
+static const unsigned FlippedVerticallyFlag     = 0x40000000;
+static const unsigned FlippedAntiDiagonallyFlag = 0x20000000;
+
+CompressedTileLayer::CompressedTileLayer(TileLayer *layer)
+    : mLayer(layer)
+    , mCompressed(false)
+{
+}
+
+CompressedTileLayer::~CompressedTileLayer()
+{
+    delete mLayer;
+}
+
+TileLayer *CompressedTileLayer::layer() const
+{
+    if (mCompressed)
+        decompress();
+
+    return mLayer;
+}
+
+void CompressedTileLayer::setLayer(TileLayer *layer)
+{
+    if (mLayer == layer)
+        return;
+
+    delete mLayer;
+    mLayer = layer;
+    mCompressed = false;
+    mTiles.clear();
+    mData.clear();
+}
+
+TileLayer *CompressedTileLayer::takeLayer()
+{
+    TileLayer *layer = this->layer();
+    mLayer = 0;
+    return layer;
+}
+
+void CompressedTileLayer::compress()
+{
+    if (mCompressed || !mLayer)
+        return;
+
+    const int width = mLayer->width();
+    const int height = mLayer->height();
+
+    QHash<Tile*, unsigned> tileIndexes;
+    QByteArray data;
+    data.resize(width * height * 4);
+    uchar *out = reinterpret_cast<uchar*>(data.data());
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const Cell &cell = mLayer->cellAt(x, y);
+            unsigned value = 0;
+
+            if (cell.tile) {
+                QHash<Tile*, unsigned>::iterator it = tileIndexes.find(cell.tile);
+                if (it == tileIndexes.end()) {
+                    mTiles.append(cell.tile);
+                    it = tileIndexes.insert(cell.tile, mTiles.size());
+                }
+
+                value = it.value();
+                if (cell.flippedHorizontally)
+                    value |= FlippedHorizontallyFlag;
+                if (cell.flippedVertically)
+                    value |= FlippedVerticallyFlag;
+                if (cell.flippedAntiDiagonally)
+                    value |= FlippedAntiDiagonallyFlag;
+            }
+
+            *out++ = (uchar) (value);
+            *out++ = (uchar) (value >> 8);
+            *out++ = (uchar) (value >> 16);
+            *out++ = (uchar) (value >> 24);
+        }
+    }
+
+    mData = Tiled::compress(data, Zlib);
+    if (mData.isNull()) {
+        mTiles.clear();
+        return;
+    }
+
+    // Drop the cells, keeping all the other layer attributes
+    mSize = QSize(width, height);
+    mLayer->resize(QSize(0, 0), QPoint());
+    mCompressed = true;
+}
+
+void CompressedTileLayer::decompress() const
+{
+    const int width = mSize.width();
+    const int height = mSize.height();
+
+    const QByteArray data = Tiled::decompress(mData, width * height * 4);
+    Q_ASSERT(data.size() == width * height * 4);
+
+    mLayer->resize(mSize, QPoint());
+
+    const uchar *in = reinterpret_cast<const uchar*>(data.constData());
+
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const unsigned value = in[0] |
+                                   in[1] << 8 |
+                                   in[2] << 16 |
+                                   unsigned(in[3]) << 24;
+            in += 4;
+
+            const unsigned index = value & ~(FlippedHorizontallyFlag |
+                                             FlippedVerticallyFlag |
+                                             FlippedAntiDiagonallyFlag);
+            if (index == 0)
+                continue;
+
+            Cell cell(mTiles.at(index - 1));
+            cell.flippedHorizontally = value & FlippedHorizontallyFlag;
+            cell.flippedVertically = value & FlippedVerticallyFlag;
+            cell.flippedAntiDiagonally = value & FlippedAntiDiagonallyFlag;
+            mLayer->setCell(x, y, cell);
+        }
+    }
+
+    mCompressed = false;
+    mTiles.clear();
+    mData.clear();
+}
+
+qint64 CompressedTileLayer::memoryUsage() const
+{
+    if (mCompressed)
+        return mData.size() + mTiles.size() * sizeof(Tile*);
+
+    return uncompressedMemoryUsage();
+}
+
+qint64 CompressedTileLayer::uncompressedMemoryUsage() const
+{
+    if (mCompressed)
+        return qint64(mSize.width()) * mSize.height() * sizeof(Cell);
+    if (mLayer)
+        return qint64(mLayer->width()) * mLayer->height() * sizeof(Cell);
+    return 0;
+}
@@ -0,0 +1,114 @@
+/*
+ * compressedtilelayer.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COMPRESSEDTILELAYER_H
+#define COMPRESSEDTILELAYER_H
+
+#include <QByteArray>
+#include <QSize>
+#include <QVector>
+
+namespace Tiled {
+
+class Tile;
+class TileLayer;
+
+namespace Internal {
+
+/**
+ * Owns a tile layer kept around by an undo command, and allows its cells to
+ * be stored in compressed form while the command is not likely to be used.
+ *
+ * When compressed, the cells are encoded as indexes into a table of the used
+ * tiles combined with the flipping flags, and the result is zlib compressed.
+ * The layer itself is kept, but without any cells. The cells are restored
+ * when the layer is accessed.
+ */
+class CompressedTileLayer
+{
+public:
+    explicit CompressedTileLayer(TileLayer *layer = 0);
+    ~CompressedTileLayer();
+
+    /**
+     * Returns the tile layer, decompressing its cells when necessary.
+     */
+    TileLayer *layer() const;
+
+    /**
+     * Replaces the tile layer, deleting the previous one.
+     */
+    void setLayer(TileLayer *layer);
+
+    /**
+     * Returns the tile layer and gives up its ownership.
+     */
+    TileLayer *takeLayer();
+
+    /**
+     * Compresses the cells of the tile layer.
+     */
+    void compress();
+
+    bool isCompressed() const { return mCompressed; }
+
+    /**
+     * Returns the approximate amount of memory used by the cells, in bytes.
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * Returns the approximate amount of memory used by the cells when they
+     * are not compressed, in bytes.
+     */
+    qint64 uncompressedMemoryUsage() const;
+
+private:
+    Q_DISABLE_COPY(CompressedTileLayer)
+
+    void decompress() const;
+
+    mutable TileLayer *mLayer;
+    mutable bool mCompressed;
+    mutable QSize mSize;
+    mutable QVector<Tile*> mTiles;
+    mutable QByteArray mData;
+};
+
+/**
+ * Interface for undo commands that can compress the tile layers they keep.
+ * The MapDocument compresses the payload of these commands when they are
+ * not at the top of the undo stack and the undo memory budget has been used
+ * up by the commands closer to the current index. The payload is
+ * decompressed again on demand when the command is undone or redone.
+ */
+class CompressibleCommand
+{
+public:
+    virtual ~CompressibleCommand() {}
+
+    virtual void compressPayload() = 0;
+    virtual qint64 payloadSize() const = 0;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // COMPRESSEDTILELAYER_H
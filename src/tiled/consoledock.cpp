@@ -49,19 +49,29 @@ ConsoleDock::ConsoleDock(QWidget *parent)
 
     layout->addWidget(plainTextEdit);
 
+    // Plugins are loaded on demand, so connect to them as they get loaded
     PluginManager *pm = PluginManager::instance();
 
-    foreach (LoggingInterface *plg, pm->interfaces<LoggingInterface>()) {
+    foreach (const Plugin *plugin, pm->plugins())
+        if (plugin->isLoaded() && plugin->instance())
+            pluginLoaded(plugin->instance());
 
-        connect(pm->plugin(plg)->instance, SIGNAL(info(QString)),
-                this, SLOT(appendInfo(QString)));
+    connect(pm, SIGNAL(pluginLoaded(QObject*)),
+            this, SLOT(pluginLoaded(QObject*)));
 
-        connect(pm->plugin(plg)->instance, SIGNAL(error(QString)),
-                this, SLOT(appendError(QString)));
+    setWidget(widget);
+}
 
-    }
+void ConsoleDock::pluginLoaded(QObject *instance)
+{
+    if (!qobject_cast<LoggingInterface*>(instance))
+        return;
 
-    setWidget(widget);
+    connect(instance, SIGNAL(info(QString)),
+            this, SLOT(appendInfo(QString)));
+
+    connect(instance, SIGNAL(error(QString)),
+            this, SLOT(appendError(QString)));
 }
 
 void ConsoleDock::appendInfo(QString str)
@@ -82,31 +82,100 @@ private:
     QDialogButtonBox *mButtons;
 };
 
-class MapViewContainer : public QWidget
+/**
+ * Shown in place of the map view for a session document that is not loaded
+ * yet.
+ */
+class SessionPlaceholder : public QWidget
 {
     Q_OBJECT
 
 public:
-    MapViewContainer(MapView *mapView, QWidget *parent = 0)
+    SessionPlaceholder(const SessionDocument &document, QWidget *parent = 0)
         : QWidget(parent)
-        , mMapView(mapView)
-        , mWarning(new FileChangedWarning)
+        , mThumbnailLabel(new QLabel(this))
+        , mTextLabel(new QLabel(this))
     {
-        mWarning->setVisible(false);
+        if (!document.thumbnail.isNull())
+            mThumbnailLabel->setPixmap(QPixmap::fromImage(document.thumbnail));
+        mThumbnailLabel->setAlignment(Qt::AlignCenter);
+        mTextLabel->setAlignment(Qt::AlignCenter);
+
+        QString text = QFileInfo(document.fileName).fileName();
+        if (!document.mapSize.isEmpty()) {
+            text += QLatin1Char('\n');
+            text += tr("%1 x %2 tiles").arg(document.mapSize.width())
+                                       .arg(document.mapSize.height());
+        }
+        mTextLabel->setText(text);
 
         QVBoxLayout *layout = new QVBoxLayout;
-        layout->setMargin(0);
-        layout->setSpacing(0);
-        layout->addWidget(mapView);
-        layout->addWidget(mWarning);
+        layout->addStretch(1);
+        layout->addWidget(mThumbnailLabel);
+        layout->addWidget(mTextLabel);
+        layout->addStretch(1);
         setLayout(layout);
+    }
 
-        connect(mWarning, SIGNAL(reload()), SIGNAL(reload()));
-        connect(mWarning, SIGNAL(ignore()), mWarning, SLOT(hide()));
+    void setError(const QString &error)
+    { mTextLabel->setText(error); }
+
+private:
+    QLabel *mThumbnailLabel;
+    QLabel *mTextLabel;
+};
+
+class MapViewContainer : public QWidget
+{
+    Q_OBJECT
+
+public:
+    MapViewContainer(QWidget *parent = 0)
+        : QWidget(parent)
+        , mMapView(0)
+        , mPlaceholder(0)
+        , mWarning(new FileChangedWarning)
+    {
+        initialize();
+    }
+
+    /**
+     * Creates a container that shows a placeholder for the given session
+     * \a document, until setMapView() is called.
+     */
+    MapViewContainer(const SessionDocument &document, QWidget *parent = 0)
+        : QWidget(parent)
+        , mMapView(0)
+        , mPlaceholder(new SessionPlaceholder(document))
+        , mSessionDocument(document)
+        , mWarning(new FileChangedWarning)
+    {
+        initialize();
+        static_cast<QVBoxLayout*>(layout())->insertWidget(0, mPlaceholder);
     }
 
     MapView *mapView() const { return mMapView; }
 
+    void setMapView(MapView *mapView)
+    {
+        Q_ASSERT(!mMapView);
+
+        mMapView = mapView;
+        static_cast<QVBoxLayout*>(layout())->insertWidget(0, mapView);
+
+        delete mPlaceholder;
+        mPlaceholder = 0;
+    }
+
+    const SessionDocument &sessionDocument() const
+    { return mSessionDocument; }
+
+    void setSessionError(const QString &error)
+    {
+        if (mPlaceholder)
+            mPlaceholder->setError(error);
+    }
+
     void setFileChangedWarningVisible(bool visible)
     { mWarning->setVisible(visible); }
 
@@ -114,7 +183,23 @@ signals:
     void reload();
 
 private:
+    void initialize()
+    {
+        mWarning->setVisible(false);
+
+        QVBoxLayout *layout = new QVBoxLayout;
+        layout->setMargin(0);
+        layout->setSpacing(0);
+        layout->addWidget(mWarning);
+        setLayout(layout);
+
+        connect(mWarning, SIGNAL(reload()), SIGNAL(reload()));
+        connect(mWarning, SIGNAL(ignore()), mWarning, SLOT(hide()));
+    }
+
     MapView *mMapView;
+    SessionPlaceholder *mPlaceholder;
+    SessionDocument mSessionDocument;
     FileChangedWarning *mWarning;
 };
 
@@ -143,6 +228,8 @@ DocumentManager::DocumentManager(QObject *parent)
     , mSelectedTool(0)
     , mSceneWithTool(0)
     , mFileSystemWatcher(new FileSystemWatcher(this))
+    , mRestoringSession(false)
+    , mClosingDocuments(false)
 {
     mTabWidget->setDocumentMode(true);
     mTabWidget->setTabsClosable(true);
@@ -187,6 +274,25 @@ MapView *DocumentManager::currentMapView() const
     return 0;
 }
 
+QList<MapDocument*> DocumentManager::documents() const
+{
+    QList<MapDocument*> documents;
+    foreach (MapDocument *mapDocument, mDocuments)
+        if (mapDocument)
+            documents.append(mapDocument);
+    return documents;
+}
+
+SessionDocument DocumentManager::sessionDocumentAt(int index) const
+{
+    return containerAt(index)->sessionDocument();
+}
+
+MapViewContainer *DocumentManager::containerAt(int index) const
+{
+    return static_cast<MapViewContainer*>(mTabWidget->widget(index));
+}
+
 MapScene *DocumentManager::currentMapScene() const
 {
     if (MapView *mapView = currentMapView())
@@ -201,7 +307,7 @@ MapView *DocumentManager::viewForDocument(MapDocument *mapDocument) const
     if (index == -1)
         return 0;
 
-    return static_cast<MapViewContainer*>(mTabWidget->widget(index))->mapView();
+    return containerAt(index)->mapView();
 }
 
 int DocumentManager::findDocument(const QString &fileName) const
@@ -211,7 +317,9 @@ int DocumentManager::findDocument(const QString &fileName) const
         return -1;
 
     for (int i = 0; i < mDocuments.size(); ++i) {
-        QFileInfo fileInfo(mDocuments.at(i)->fileName());
+        const MapDocument *mapDocument = mDocuments.at(i);
+        QFileInfo fileInfo(mapDocument ? mapDocument->fileName()
+                                       : sessionDocumentAt(i).fileName);
         if (fileInfo.canonicalFilePath() == canonicalFilePath)
             return i;
     }
@@ -257,6 +365,63 @@ void DocumentManager::addDocument(MapDocument *mapDocument)
     Q_ASSERT(!mDocuments.contains(mapDocument));
 
     mDocuments.append(mapDocument);
+
+    MapViewContainer *container = new MapViewContainer(mTabWidget);
+    setupDocumentView(mapDocument, container);
+
+    const int documentIndex = mDocuments.size() - 1;
+
+    mTabWidget->addTab(container, mapDocument->displayName());
+    mTabWidget->setTabToolTip(documentIndex, mapDocument->fileName());
+
+    switchToDocument(documentIndex);
+    centerViewOn(0, 0);
+}
+
+void DocumentManager::restoreSession(const QList<SessionDocument> &documents,
+                                     int currentIndex)
+{
+    if (documents.isEmpty())
+        return;
+
+    const int firstIndex = mDocuments.size();
+
+    // Avoid loading the documents as their tabs are added
+    mRestoringSession = true;
+
+    foreach (const SessionDocument &document, documents) {
+        MapViewContainer *container = new MapViewContainer(document,
+                                                           mTabWidget);
+        mDocuments.append(0);
+
+        const int index = mTabWidget->addTab(container,
+                                             QFileInfo(document.fileName).fileName());
+        mTabWidget->setTabToolTip(index, document.fileName);
+
+        connect(container, SIGNAL(reload()), SLOT(reloadRequested()));
+    }
+
+    mRestoringSession = false;
+
+    if (currentIndex >= 0 && currentIndex < documents.size()) {
+        const int index = firstIndex + currentIndex;
+        if (mTabWidget->currentIndex() != index) {
+            switchToDocument(index);
+            return;
+        }
+    }
+
+    // The current tab may not have changed while its document was pending
+    currentIndexChanged();
+}
+
+/**
+ * Creates the map view and scene for the given \a mapDocument, displayed in
+ * the given \a container.
+ */
+void DocumentManager::setupDocumentView(MapDocument *mapDocument,
+                                        MapViewContainer *container)
+{
     mUndoGroup->addStack(mapDocument->undoStack());
 
     if (!mapDocument->fileName().isEmpty())
@@ -264,24 +429,57 @@ void DocumentManager::addDocument(MapDocument *mapDocument)
 
     MapView *view = new MapView;
     MapScene *scene = new MapScene(view); // scene is owned by the view
-    MapViewContainer *container = new MapViewContainer(view, mTabWidget);
 
     scene->setMapDocument(mapDocument);
     view->setScene(scene);
+    container->setMapView(view);
 
-    const int documentIndex = mDocuments.size() - 1;
-
-    mTabWidget->addTab(container, mapDocument->displayName());
-    mTabWidget->setTabToolTip(documentIndex, mapDocument->fileName());
     connect(mapDocument, SIGNAL(fileNameChanged(QString,QString)),
             SLOT(fileNameChanged(QString,QString)));
     connect(mapDocument, SIGNAL(modifiedChanged()), SLOT(updateDocumentTab()));
     connect(mapDocument, SIGNAL(saved()), SLOT(documentSaved()));
+    connect(mapDocument, SIGNAL(saveFailed(QString)),
+            SLOT(documentSaveFailed(QString)));
 
-    connect(container, SIGNAL(reload()), SLOT(reloadRequested()));
+    connect(container, SIGNAL(reload()), SLOT(reloadRequested()),
+            Qt::UniqueConnection);
+}
 
-    switchToDocument(documentIndex);
-    centerViewOn(0, 0);
+/**
+ * Loads the session document shown at the given \a index and restores its
+ * view state. Returns the loaded document, or 0 when loading failed.
+ */
+MapDocument *DocumentManager::loadSessionDocument(int index)
+{
+    Q_ASSERT(!mDocuments.at(index));
+
+    MapViewContainer *container = containerAt(index);
+    const SessionDocument session = container->sessionDocument();
+
+    QString error;
+    MapDocument *mapDocument = MapDocument::load(session.fileName, 0, &error);
+    if (!mapDocument) {
+        // Keep the tab, so that the user can see what went wrong
+        container->setSessionError(error);
+        return 0;
+    }
+
+    mDocuments[index] = mapDocument;
+    setupDocumentView(mapDocument, container);
+    mTabWidget->setTabText(index, mapDocument->displayName());
+    mTabWidget->setTabToolTip(index, mapDocument->fileName());
+
+    MapView *mapView = container->mapView();
+    if (session.scale > 0)
+        mapView->zoomable()->setScale(session.scale);
+    mapView->horizontalScrollBar()->setSliderPosition(session.scrollX);
+    mapView->verticalScrollBar()->setSliderPosition(session.scrollY);
+
+    const int layerIndex = session.currentLayerIndex;
+    if (layerIndex > 0 && layerIndex < mapDocument->map()->layerCount())
+        mapDocument->setCurrentLayerIndex(layerIndex);
+
+    return mapDocument;
 }
 
 void DocumentManager::closeCurrentDocument()
@@ -296,13 +494,18 @@ void DocumentManager::closeCurrentDocument()
 void DocumentManager::closeDocumentAt(int index)
 {
     MapDocument *mapDocument = mDocuments.at(index);
-    emit documentAboutToClose(mapDocument);
+    if (mapDocument)
+        emit documentAboutToClose(mapDocument);
 
     QWidget *mapViewContainer = mTabWidget->widget(index);
     mDocuments.removeAt(index);
     mTabWidget->removeTab(index);
     delete mapViewContainer;
 
+    // Session documents that were never loaded are not watched
+    if (!mapDocument)
+        return;
+
     if (!mapDocument->fileName().isEmpty())
         mFileSystemWatcher->removePath(mapDocument->fileName());
 
@@ -322,13 +525,17 @@ bool DocumentManager::reloadDocumentAt(int index)
 {
     MapDocument *oldDocument = mDocuments.at(index);
 
+    // Session documents are read from disk when they are first shown anyway
+    if (!oldDocument)
+        return true;
+
     // Try to find the interface that was used for reading this map
     QString readerPluginName = oldDocument->readerPluginFileName();
     MapReaderInterface *reader = 0;
     if (!readerPluginName.isEmpty()) {
         PluginManager *pm = PluginManager::instance();
         if (const Plugin *plugin = pm->pluginByFileName(readerPluginName))
-            reader = qobject_cast<MapReaderInterface*>(plugin->instance);
+            reader = qobject_cast<MapReaderInterface*>(plugin->instance());
     }
 
     QString error;
@@ -364,8 +571,13 @@ bool DocumentManager::reloadDocumentAt(int index)
 
 void DocumentManager::closeAllDocuments()
 {
+    // Avoid loading the session documents that become current on the way
+    mClosingDocuments = true;
+
     while (!mDocuments.isEmpty())
         closeCurrentDocument();
+
+    mClosingDocuments = false;
 }
 
 void DocumentManager::currentIndexChanged()
@@ -375,6 +587,16 @@ void DocumentManager::currentIndexChanged()
         mSceneWithTool = 0;
     }
 
+    if (mRestoringSession)
+        return;
+
+    // Session documents are loaded when their tab is first activated, but
+    // not when it only becomes current because all tabs are being closed
+    MapDocument *loadedDocument = 0;
+    const int index = mTabWidget->currentIndex();
+    if (index != -1 && !mDocuments.at(index) && !mClosingDocuments)
+        loadedDocument = loadSessionDocument(index);
+
     MapDocument *mapDocument = currentDocument();
 
     if (mapDocument)
@@ -387,6 +609,9 @@ void DocumentManager::currentIndexChanged()
         mapScene->enableSelectedTool();
         mSceneWithTool = mapScene;
     }
+
+    if (loadedDocument)
+        emit sessionDocumentLoaded(loadedDocument);
 }
 
 void DocumentManager::setSelectedTool(AbstractTool *tool)
@@ -441,6 +666,14 @@ void DocumentManager::documentSaved()
     container->setFileChangedWarningVisible(false);
 }
 
+void DocumentManager::documentSaveFailed(const QString &error)
+{
+    MapDocument *document = static_cast<MapDocument*>(sender());
+    switchToDocument(document);
+
+    emit saveError(error);
+}
+
 void DocumentManager::documentTabMoved(int from, int to)
 {
     mDocuments.move(from, to);
@@ -456,7 +689,13 @@ void DocumentManager::fileChanged(const QString &fileName)
 
     MapDocument *document = mDocuments.at(index);
 
+    // Session documents will read the new version when they are loaded
+    if (!document)
+        return;
+
     // Ignore change event when it seems to be our own save
+    if (document->isSaving())
+        return;
     if (QFileInfo(fileName).lastModified() == document->lastSaved())
         return;
 
@@ -22,10 +22,13 @@
 #ifndef DOCUMENT_MANAGER_H
 #define DOCUMENT_MANAGER_H
 
+#include <QImage>
 #include <QList>
 #include <QObject>
 #include <QPair>
 #include <QPointF>
+#include <QSize>
+#include <QString>
 
 class QUndoGroup;
 
@@ -40,8 +43,33 @@ class FileSystemWatcher;
 class MapDocument;
 class MapScene;
 class MapView;
+class MapViewContainer;
 class MovableTabWidget;
 
+/**
+ * A map that was open in a previous session. It is shown as a placeholder tab
+ * until the tab is first activated, at which point the map is loaded.
+ */
+struct SessionDocument
+{
+    SessionDocument()
+        : scale(0)
+        , scrollX(0)
+        , scrollY(0)
+        , currentLayerIndex(0)
+    {}
+
+    QString fileName;
+    QSize mapSize;
+    QImage thumbnail;
+
+    // The view state to restore once the map is loaded
+    qreal scale;
+    int scrollX;
+    int scrollY;
+    int currentLayerIndex;
+};
+
 /**
  * This class controls the open documents.
  */
@@ -89,10 +117,23 @@ public:
     MapView *viewForDocument(MapDocument *mapDocument) const;
 
     /**
-     * Returns the number of map documents.
+     * Returns the number of map documents, including the ones restored from
+     * the previous session that are not loaded yet.
      */
     int documentCount() const { return mDocuments.size(); }
 
+    /**
+     * Returns the map document at the given \a index, or 0 when it is a
+     * session document that is not loaded yet.
+     */
+    MapDocument *documentAt(int index) const { return mDocuments.at(index); }
+
+    /**
+     * Returns the session document shown at the given \a index. Only valid
+     * while documentAt() returns 0 for this index.
+     */
+    SessionDocument sessionDocumentAt(int index) const;
+
     /**
      * Searches for a document with the given \a fileName and returns its
      * index. Returns -1 when the document isn't open.
@@ -110,6 +151,14 @@ public:
      */
     void addDocument(MapDocument *mapDocument);
 
+    /**
+     * Adds placeholder tabs for the given session \a documents and switches
+     * to the one at \a currentIndex. Only the map in the current tab is
+     * loaded, the others are loaded when their tab is first activated.
+     */
+    void restoreSession(const QList<SessionDocument> &documents,
+                        int currentIndex);
+
     /**
      * Closes the current map document. Will not ask the user whether to save
      * any changes!
@@ -145,9 +194,9 @@ public:
     void closeAllDocuments();
 
     /**
-     * Returns all open map documents.
+     * Returns all loaded map documents.
      */
-    QList<MapDocument*> documents() const { return mDocuments; }
+    QList<MapDocument*> documents() const;
 
     /**
      * Centers the current map on the tile coordinates \a x, \a y.
@@ -172,11 +221,23 @@ signals:
      */
     void documentAboutToClose(MapDocument *document);
 
+    /**
+     * Emitted when a session document was loaded, after it became the current
+     * document.
+     */
+    void sessionDocumentLoaded(MapDocument *document);
+
     /**
      * Emitted when an error occurred while reloading the map.
      */
     void reloadError(const QString &error);
 
+    /**
+     * Emitted when saving a map in the background failed. The map that
+     * failed to save is made the current document first.
+     */
+    void saveError(const QString &error);
+
 public slots:
     void switchToLeftDocument();
     void switchToRightDocument();
@@ -189,6 +250,7 @@ private slots:
                          const QString &oldFileName);
     void updateDocumentTab();
     void documentSaved();
+    void documentSaveFailed(const QString &error);
     void documentTabMoved(int from, int to);
 
     void fileChanged(const QString &fileName);
@@ -199,6 +261,14 @@ private:
     DocumentManager(QObject *parent = 0);
     ~DocumentManager();
 
+    MapViewContainer *containerAt(int index) const;
+    void setupDocumentView(MapDocument *mapDocument,
+                           MapViewContainer *container);
+    MapDocument *loadSessionDocument(int index);
+
+    /**
+     * Holds a 0 entry for each session document that is not loaded yet.
+     */
     QList<MapDocument*> mDocuments;
 
     MovableTabWidget *mTabWidget;
@@ -206,6 +276,8 @@ private:
     AbstractTool *mSelectedTool;
     MapScene *mSceneWithTool;
     FileSystemWatcher *mFileSystemWatcher;
+    bool mRestoringSession;
+    bool mClosingDocuments;
 
     static DocumentManager *mInstance;
 };
@@ -40,19 +40,18 @@ EraseTiles::EraseTiles(MapDocument *mapDocument,
 
     // Store the tiles that are to be erased
     const QRegion r = mRegion.translated(-mTileLayer->x(), -mTileLayer->y());
-    mErasedCells = mTileLayer->copy(r);
+    mErasedCells.setLayer(mTileLayer->copy(r));
 }
 
 EraseTiles::~EraseTiles()
 {
-    delete mErasedCells;
 }
 
 void EraseTiles::undo()
 {
     const QRect bounds = mRegion.boundingRect();
     TilePainter painter(mMapDocument, mTileLayer);
-    painter.drawCells(bounds.x(), bounds.y(), mErasedCells);
+    painter.drawCells(bounds.x(), bounds.y(), mErasedCells.layer());
 }
 
 void EraseTiles::redo()
@@ -77,16 +76,26 @@ bool EraseTiles::mergeWith(const QUndoCommand *other)
         // Resize the erased tiles layer when necessary
         if (bounds != combinedBounds) {
             const QPoint shift = bounds.topLeft() - combinedBounds.topLeft();
-            mErasedCells->resize(combinedBounds.size(), shift);
+            mErasedCells.layer()->resize(combinedBounds.size(), shift);
         }
 
         // Copy the newly erased tiles over
         const QRect otherBounds = o->mRegion.boundingRect();
         const QPoint pos = otherBounds.topLeft() - combinedBounds.topLeft();
-        mErasedCells->merge(pos, o->mErasedCells);
+        mErasedCells.layer()->merge(pos, o->mErasedCells.layer());
 
         mRegion = combinedRegion;
     }
 
     return true;
 }
+
+void EraseTiles::compressPayload()
+{
+    mErasedCells.compress();
+}
+
+qint64 EraseTiles::payloadSize() const
+{
+    return mErasedCells.memoryUsage();
+}
@@ -21,6 +21,7 @@
 #ifndef ERASETILES_H
 #define ERASETILES_H
 
+#include "compressedtilelayer.h"
 #include "undocommands.h"
 
 #include <QRegion>
@@ -35,7 +36,7 @@ namespace Internal {
 
 class MapDocument;
 
-class EraseTiles : public QUndoCommand
+class EraseTiles : public QUndoCommand, public CompressibleCommand
 {
 public:
     EraseTiles(MapDocument *mapDocument,
@@ -55,10 +56,13 @@ public:
     int id() const { return Cmd_EraseTiles; }
     bool mergeWith(const QUndoCommand *other);
 
+    void compressPayload();
+    qint64 payloadSize() const;
+
 private:
     MapDocument *mMapDocument;
     TileLayer *mTileLayer;
-    TileLayer *mErasedCells;
+    CompressedTileLayer mErasedCells;
     QRegion mRegion;
     bool mMergeable;
 };
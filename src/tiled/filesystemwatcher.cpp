@@ -35,6 +35,12 @@ FileSystemWatcher::FileSystemWatcher(QObject *parent) :
             SLOT(onFileChanged(QString)));
     connect(mWatcher, SIGNAL(directoryChanged(QString)),
             SLOT(onDirectoryChanged(QString)));
+
+    mChangedFilesTimer.setInterval(100);
+    mChangedFilesTimer.setSingleShot(true);
+
+    connect(&mChangedFilesTimer, SIGNAL(timeout()),
+            SLOT(changedFilesTimeout()));
 }
 
 void FileSystemWatcher::addPath(const QString &path)
@@ -73,17 +79,36 @@ void FileSystemWatcher::removePath(const QString &path)
 
 void FileSystemWatcher::onFileChanged(const QString &path)
 {
-    // If the file was replaced, the watcher is automatically removed and needs
-    // to be re-added to keep watching it for changes. This happens commonly
-    // with applications that do atomic saving.
-    if (!mWatcher->files().contains(path))
-        if (QFile::exists(path))
-            mWatcher->addPath(path);
-
-    emit fileChanged(path);
+    // Atomic saves tend to cause several change events in a row, which are
+    // collected here and only reported once the file has settled
+    mChangedFiles.insert(path);
+    mChangedFilesTimer.start();
 }
 
 void FileSystemWatcher::onDirectoryChanged(const QString &path)
 {
     emit directoryChanged(path);
 }
+
+void FileSystemWatcher::changedFilesTimeout()
+{
+    const QSet<QString> changedFiles = mChangedFiles;
+    mChangedFiles.clear();
+
+    // If the file was replaced, the watcher is automatically removed and needs
+    // to be re-added to keep watching it for changes. This happens commonly
+    // with applications that do atomic saving.
+    const QSet<QString> watchedFiles = mWatcher->files().toSet();
+
+    foreach (const QString &path, changedFiles) {
+        // Ignore files that stopped being watched in the meantime
+        if (!mWatchCount.contains(path))
+            continue;
+
+        if (!watchedFiles.contains(path))
+            if (QFile::exists(path))
+                mWatcher->addPath(path);
+
+        emit fileChanged(path);
+    }
+}
@@ -23,6 +23,8 @@
 
 #include <QMap>
 #include <QObject>
+#include <QSet>
+#include <QTimer>
 
 class QFileSystemWatcher;
 
@@ -34,6 +36,10 @@ namespace Internal {
  * watched multiple times. It also doesn't start complaining when a file
  * doesn't exist.
  *
+ * Changes are collected for a short moment before they are reported, so that
+ * the burst of events caused by an atomic save results in a single
+ * fileChanged() signal per file.
+ *
  * It's meant to be used as drop-in replacement for QFileSystemWatcher.
  */
 class FileSystemWatcher : public QObject
@@ -53,10 +59,13 @@ signals:
 private slots:
     void onFileChanged(const QString &path);
     void onDirectoryChanged(const QString &path);
+    void changedFilesTimeout();
 
 private:
     QFileSystemWatcher *mWatcher;
     QMap<QString, int> mWatchCount;
+    QSet<QString> mChangedFiles;
+    QTimer mChangedFilesTimer;
 };
 
 } // namespace Internal
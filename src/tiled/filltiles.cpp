@@ -46,7 +46,6 @@ FillTiles::FillTiles(MapDocument *mapDocument,
 
 FillTiles::~FillTiles()
 {
-    delete mOriginalCells;
 }
 
 void FillTiles::undo()
@@ -55,7 +54,7 @@ void FillTiles::undo()
     TilePainter painter(mMapDocument, mTileLayer);
     painter.setCells(boundingRect.x(),
                      boundingRect.y(),
-                     mOriginalCells,
+                     mOriginalCells.layer(),
                      mFillRegion);
 
     QUndoCommand::undo(); // undo child commands
@@ -68,3 +67,13 @@ void FillTiles::redo()
     TilePainter painter(mMapDocument, mTileLayer);
     painter.drawStamp(mFillStamp.data(), mFillRegion);
 }
+
+void FillTiles::compressPayload()
+{
+    mOriginalCells.compress();
+}
+
+qint64 FillTiles::payloadSize() const
+{
+    return mOriginalCells.memoryUsage();
+}
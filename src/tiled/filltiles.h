@@ -21,6 +21,7 @@
 #ifndef FILLTILES_H
 #define FILLTILES_H
 
+#include "compressedtilelayer.h"
 #include "undocommands.h"
 #include "tilelayer.h"
 
@@ -36,7 +37,7 @@ namespace Internal {
 
 class MapDocument;
 
-class FillTiles : public QUndoCommand
+class FillTiles : public QUndoCommand, public CompressibleCommand
 {
 public:
     /**
@@ -54,11 +55,14 @@ public:
     void undo();
     void redo();
 
+    void compressPayload();
+    qint64 payloadSize() const;
+
 private:
     MapDocument *mMapDocument;
     TileLayer *mTileLayer;
     QRegion mFillRegion;
-    TileLayer *mOriginalCells;
+    CompressedTileLayer mOriginalCells;
     SharedTileLayer mFillStamp;
 };
 
@@ -46,6 +46,11 @@ public:
      */
     ImageLayerItem(ImageLayer *layer, MapDocument *mapDocument);
 
+    /**
+     * Returns the image layer displayed by this item.
+     */
+    ImageLayer *imageLayer() const { return mLayer; }
+
     /**
      * Updates the size and position of this item. Should be called when the
      * size of either the image layer or its associated map have changed.
@@ -30,6 +30,7 @@
 #include "preferences.h"
 #include "tiledapplication.h"
 #include "tileset.h"
+#include "tracing.h"
 
 #include <QDebug>
 #include <QFileInfo>
@@ -59,6 +60,7 @@ public:
     bool showedVersion;
     bool disableOpenGL;
     bool exportMap;
+    bool writeTrace;
 
 private:
     void showVersion();
@@ -66,6 +68,7 @@ private:
     void setDisableOpenGL();
     void setExportMap();
     void showExportFormats();
+    void setWriteTrace();
 
     // Convenience wrapper around registerOption
     template <void (CommandLineHandler::*memberFunction)()>
@@ -80,6 +83,34 @@ private:
     }
 };
 
+/**
+ * Writes the recorded trace when it goes out of scope, so that the trace
+ * covers everything up to leaving main().
+ */
+class TraceFileWriter
+{
+public:
+    TraceFileWriter()
+        : enabled(false)
+    {}
+
+    ~TraceFileWriter()
+    {
+        if (!enabled)
+            return;
+
+        const QString fileName = QFileInfo(QLatin1String("trace.json")).absoluteFilePath();
+
+        QString error;
+        if (Tiled::Tracer::writeChromeTrace(fileName, &error))
+            qWarning() << "Trace written to" << qPrintable(fileName);
+        else
+            qWarning() << "Failed to write trace:" << qPrintable(error);
+    }
+
+    bool enabled;
+};
+
 } // anonymous namespace
 
 
@@ -88,6 +119,7 @@ CommandLineHandler::CommandLineHandler()
     , showedVersion(false)
     , disableOpenGL(false)
     , exportMap(false)
+    , writeTrace(false)
 {
     option<&CommandLineHandler::showVersion>(
                 QLatin1Char('v'),
@@ -113,6 +145,13 @@ CommandLineHandler::CommandLineHandler()
                 QChar(),
                 QLatin1String("--export-formats"),
                 tr("Print a list of supported export formats"));
+
+    if (Tiled::Tracer::isAvailable()) {
+        option<&CommandLineHandler::setWriteTrace>(
+                    QChar(),
+                    QLatin1String("--trace"),
+                    tr("Write a Chrome trace to trace.json on exit"));
+    }
 }
 
 void CommandLineHandler::showVersion()
@@ -140,6 +179,11 @@ void CommandLineHandler::setExportMap()
     exportMap = true;
 }
 
+void CommandLineHandler::setWriteTrace()
+{
+    writeTrace = true;
+}
+
 void CommandLineHandler::showExportFormats()
 {
     PluginManager *pluginManager = PluginManager::instance();
@@ -216,6 +260,9 @@ int main(int argc, char *argv[])
     if (commandLine.disableOpenGL)
         Preferences::instance()->setUseOpenGL(false);
 
+    TraceFileWriter traceFileWriter;
+    traceFileWriter.enabled = commandLine.writeTrace;
+
     PluginManager::instance()->loadPlugins();
 
     if (commandLine.exportMap) {
@@ -78,9 +78,11 @@
 #include "tilestampmanager.h"
 #include "tilestampsdock.h"
 #include "terraindock.h"
+#include "thumbnailrenderer.h"
 #include "toolmanager.h"
 #include "tmxmapreader.h"
 #include "tmxmapwriter.h"
+#include "tracing.h"
 #include "undodock.h"
 #include "utils.h"
 #include "zoomable.h"
@@ -110,6 +112,7 @@
 #include "macsupport.h"
 #endif
 
+#include <QBuffer>
 #include <QMimeData>
 #include <QCloseEvent>
 #include <QComboBox>
@@ -151,6 +154,8 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     , mValidator(new RTBValidator(mValidatorDock))
     , mTutorialDock(new RTBTutorialDock(this))
 {
+    TILED_TRACE("MainWindow::MainWindow");
+
     mUi->setupUi(this);
     setCentralWidget(mDocumentManager->widget());
 
@@ -195,12 +200,12 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     undoAction->setIconText(tr("Undo"));
     connect(undoGroup, SIGNAL(cleanChanged(bool)), SLOT(updateWindowTitle()));
 
-    UndoDock *undoDock = new UndoDock(undoGroup, this);
+    mUndoDock = new UndoDock(undoGroup, this);
     mPropertiesDock = new PropertiesDock(this);
 
     addDockWidget(Qt::RightDockWidgetArea, mLayerDock);
     addDockWidget(Qt::LeftDockWidgetArea, mPropertiesDock);
-    addDockWidget(Qt::LeftDockWidgetArea, undoDock);
+    addDockWidget(Qt::LeftDockWidgetArea, mUndoDock);
     addDockWidget(Qt::LeftDockWidgetArea, mMapsDock);
     addDockWidget(Qt::RightDockWidgetArea, mMiniMapDock);
 
@@ -208,11 +213,11 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
     addDockWidget(Qt::RightDockWidgetArea, mTutorialDock);
 
     tabifyDockWidget(mMiniMapDock, mLayerDock);
-    tabifyDockWidget(undoDock, mMapsDock);
+    tabifyDockWidget(mUndoDock, mMapsDock);
 
     // These dock widgets may not be immediately useful to many people, so
     // they are hidden by default.
-    undoDock->setVisible(false);
+    mUndoDock->setVisible(false);
     mMapsDock->setVisible(false);
 
     statusBar()->addPermanentWidget(mZoomComboBox);
@@ -340,6 +345,14 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
 
     connect(mUi->actionAbout, SIGNAL(triggered()), SLOT(aboutTiled()));
 
+    // Exporting a trace is only useful when the zones were compiled in
+    if (Tracer::isAvailable()) {
+        QAction *exportTraceAction = new QAction(tr("Export &Trace..."), this);
+        connect(exportTraceAction, SIGNAL(triggered()), SLOT(exportTrace()));
+        mUi->menuHelp->insertAction(mUi->menuHelp->actions().first(),
+                                    exportTraceAction);
+    }
+
     // Add recent file actions to the recent files menu
     for (int i = 0; i < MaxRecentFiles; ++i)
     {
@@ -501,8 +514,12 @@ MainWindow::MainWindow(QWidget *parent, Qt::WindowFlags flags)
             SLOT(mapDocumentChanged(MapDocument*)));
     connect(mDocumentManager, SIGNAL(documentCloseRequested(int)),
             this, SLOT(closeMapDocument(int)));
+    connect(mDocumentManager, SIGNAL(sessionDocumentLoaded(MapDocument*)),
+            this, SLOT(sessionDocumentLoaded(MapDocument*)));
     connect(mDocumentManager, SIGNAL(reloadError(QString)),
             this, SLOT(reloadError(QString)));
+    connect(mDocumentManager, SIGNAL(saveError(QString)),
+            this, SLOT(saveError(QString)));
 
     QShortcut *switchToLeftDocument = new QShortcut(tr("Alt+Left"), this);
     connect(switchToLeftDocument, SIGNAL(activated()),
@@ -665,6 +682,8 @@ bool MainWindow::openFile(const QString &fileName)
 
 void MainWindow::openLastFiles()
 {
+    TILED_TRACE("MainWindow::openLastFiles");
+
     mSettings->beginGroup(QLatin1String("recentFiles"));
 
     QStringList lastOpenFiles = mSettings->value(
@@ -690,6 +709,19 @@ void MainWindow::openLastFiles()
                 QLatin1String("scrollY")).toStringList();
     QStringList selectedLayer = mSettings->value(
                 QLatin1String("selectedLayer")).toStringList();
+    QStringList mapSizes = mSettings->value(
+                QLatin1String("mapSize")).toStringList();
+    QVariantList thumbnails = mSettings->value(
+                QLatin1String("thumbnails")).toList();
+
+    const QString lastActiveDocument =
+            mSettings->value(QLatin1String("lastActive")).toString();
+    const QString lastActivePath =
+            QFileInfo(lastActiveDocument).canonicalFilePath();
+
+    // The maps are only loaded once their tab is activated
+    QList<SessionDocument> documents;
+    int currentIndex = -1;
 
     for (int i = 0; i < lastOpenFiles.size(); i++) {
         if (!(i < mapScales.size()))
@@ -701,29 +733,37 @@ void MainWindow::openLastFiles()
         if (!(i < selectedLayer.size()))
             continue;
 
-        if (openFile(lastOpenFiles.at(i))) {
-            MapView *mapView = mDocumentManager->currentMapView();
+        const QFileInfo fileInfo(lastOpenFiles.at(i));
+        if (!fileInfo.exists())
+            continue;
 
-            // Restore camera to the previous position
-            qreal scale = mapScales.at(i).toDouble();
-            if (scale > 0)
-                mapView->zoomable()->setScale(scale);
+        SessionDocument document;
+        document.fileName = lastOpenFiles.at(i);
+        document.scale = mapScales.at(i).toDouble();
+        document.scrollX = scrollX.at(i).toInt();
+        document.scrollY = scrollY.at(i).toInt();
+        document.currentLayerIndex = selectedLayer.at(i).toInt();
+
+        if (i < mapSizes.size()) {
+            const QStringList size = mapSizes.at(i).split(QLatin1Char('x'));
+            if (size.size() == 2)
+                document.mapSize = QSize(size.at(0).toInt(), size.at(1).toInt());
+        }
 
-            const int hor = scrollX.at(i).toInt();
-            const int ver = scrollY.at(i).toInt();
-            mapView->horizontalScrollBar()->setSliderPosition(hor);
-            mapView->verticalScrollBar()->setSliderPosition(ver);
+        if (i < thumbnails.size())
+            document.thumbnail = QImage::fromData(thumbnails.at(i).toByteArray(),
+                                                  "PNG");
 
-            int layer = selectedLayer.at(i).toInt();
-            if (layer > 0 && layer < mMapDocument->map()->layerCount())
-                mMapDocument->setCurrentLayerIndex(layer);
-        }
+        if (fileInfo.canonicalFilePath() == lastActivePath)
+            currentIndex = documents.size();
+
+        documents.append(document);
     }
-    QString lastActiveDocument =
-            mSettings->value(QLatin1String("lastActive")).toString();
-    int documentIndex = mDocumentManager->findDocument(lastActiveDocument);
-    if (documentIndex != -1)
-        mDocumentManager->switchToDocument(documentIndex);
+
+    if (currentIndex == -1)
+        currentIndex = documents.size() - 1;
+
+    mDocumentManager->restoreSession(documents, currentIndex);
 
     mSettings->endGroup();
 }
@@ -732,7 +772,7 @@ void MainWindow::openFile()
 {
     QString filter = tr("Json files (*.json)");
 
-    const PluginManager *pm = PluginManager::instance();
+    PluginManager *pm = PluginManager::instance();
     QList<MapReaderInterface*> readers = pm->interfaces<MapReaderInterface>();
 
     QString selectedFilter = tr("Json files (*.json)");
@@ -765,8 +805,9 @@ bool MainWindow::saveFile(const QString &fileName)
     mToolManager->resetToolbarActionIcons();
     mMapDocument->map()->rtbMap()->setHasError(mValidator->validate());
 
+    // The map is written on a worker thread, errors are reported by saveError()
     QString error;
-    if (!mMapDocument->save(fileName, &error)) {
+    if (!mMapDocument->saveInBackground(fileName, &error)) {
         QMessageBox::critical(this, tr("Error Saving Map"), error);
         return false;
     }
@@ -793,12 +834,10 @@ bool MainWindow::saveFileAs()
     const QString tmxfilter = tr("Tiled map files (*.tmx)");
     QString filter = QString(tmxfilter);
     PluginManager *pm = PluginManager::instance();
-    foreach (const Plugin &plugin, pm->plugins()) {
-        const MapWriterInterface *writer = qobject_cast<MapWriterInterface*>
-                (plugin.instance);
+    foreach (MapWriterInterface *writer, pm->interfaces<MapWriterInterface>()) {
         const MapReaderInterface *reader = qobject_cast<MapReaderInterface*>
-                (plugin.instance);
-        if (writer && reader) {
+                (pm->plugin(writer)->instance());
+        if (reader) {
             foreach (const QString &str, writer->nameFilters()) {
                 if (!str.isEmpty()) {
                     filter += QLatin1String(";;");
@@ -865,7 +904,12 @@ void MainWindow::saveAll()
 
 bool MainWindow::confirmSave(MapDocument *mapDocument)
 {
-    if (!mapDocument || !mapDocument->isModified())
+    if (!mapDocument)
+        return true;
+
+    // A save that is still being written may leave nothing to confirm
+    mapDocument->waitForSave();
+    if (!mapDocument->isModified())
         return true;
 
     mDocumentManager->switchToDocument(mapDocument);
@@ -876,7 +920,7 @@ bool MainWindow::confirmSave(MapDocument *mapDocument)
             QMessageBox::Save | QMessageBox::Discard | QMessageBox::Cancel);
 
     switch (ret) {
-    case QMessageBox::Save:    return saveFile();
+    case QMessageBox::Save:    return saveFile() && mapDocument->waitForSave();
     case QMessageBox::Discard: return true;
     case QMessageBox::Cancel:
     default:
@@ -886,8 +930,8 @@ bool MainWindow::confirmSave(MapDocument *mapDocument)
 
 bool MainWindow::confirmAllSave()
 {
-    for (int i = 0; i < mDocumentManager->documentCount(); ++i) {
-        if (!confirmSave(mDocumentManager->documents().at(i)))
+    foreach (MapDocument *mapDocument, mDocumentManager->documents()) {
+        if (!confirmSave(mapDocument))
             return false;
     }
 
@@ -911,10 +955,12 @@ void MainWindow::export_()
         } else {
             PluginManager *pm = PluginManager::instance();
             if (const Plugin *plugin = pm->pluginByFileName(exportPluginFileName))
-                writer = qobject_cast<MapWriterInterface*>(plugin->instance);
+                writer = qobject_cast<MapWriterInterface*>(plugin->instance());
         }
 
         if (writer) {
+            MapDocument::waitForBackgroundSaves();
+
             if (writer->write(mMapDocument->map(), exportFileName)) {
                 statusBar()->showMessage(tr("Exported to %1").arg(exportFileName),
                                          3000);
@@ -1054,6 +1100,8 @@ void MainWindow::exportAs()
     pref->setLastPath(Preferences::ExportedFile, QFileInfo(fileName).path());
     mSettings->setValue(QLatin1String("lastUsedExportFilter"), selectedFilter);
 
+    MapDocument::waitForBackgroundSaves();
+
     if (!chosenWriter->write(mMapDocument->map(), fileName)) {
         QMessageBox::critical(this, tr("Error Exporting Map"),
                               chosenWriter->errorString());
@@ -1620,6 +1668,23 @@ void MainWindow::updateStatusInfoLabel(const QString &statusInfo)
     mStatusInfoLabel->setText(statusInfo);
 }
 
+static QString sizeToString(const QSize &size)
+{
+    return QString::number(size.width()) + QLatin1Char('x') +
+            QString::number(size.height());
+}
+
+static QByteArray thumbnailData(const QImage &thumbnail)
+{
+    QByteArray data;
+    if (!thumbnail.isNull()) {
+        QBuffer buffer(&data);
+        buffer.open(QIODevice::WriteOnly);
+        thumbnail.save(&buffer, "PNG");
+    }
+    return data;
+}
+
 void MainWindow::writeSettings()
 {
     mSettings->beginGroup(QLatin1String("mainwindow"));
@@ -1636,8 +1701,24 @@ void MainWindow::writeSettings()
     QStringList scrollX;
     QStringList scrollY;
     QStringList selectedLayer;
+    QStringList mapSizes;
+    QVariantList thumbnails;
     for (int i = 0; i < mDocumentManager->documentCount(); i++) {
-        MapDocument *document = mDocumentManager->documents().at(i);
+        MapDocument *document = mDocumentManager->documentAt(i);
+
+        // Documents that were never loaded keep their recorded state
+        if (!document) {
+            const SessionDocument session = mDocumentManager->sessionDocumentAt(i);
+            fileList.append(session.fileName);
+            mapScales.append(QString::number(session.scale));
+            scrollX.append(QString::number(session.scrollX));
+            scrollY.append(QString::number(session.scrollY));
+            selectedLayer.append(QString::number(session.currentLayerIndex));
+            mapSizes.append(sizeToString(session.mapSize));
+            thumbnails.append(thumbnailData(session.thumbnail));
+            continue;
+        }
+
         MapView *mapView = mDocumentManager->viewForDocument(document);
         fileList.append(document->fileName());
         const int currentLayerIndex = document->currentLayerIndex();
@@ -1648,12 +1729,20 @@ void MainWindow::writeSettings()
         scrollY.append(QString::number(
                        mapView->verticalScrollBar()->sliderPosition()));
         selectedLayer.append(QString::number(currentLayerIndex));
+
+        Map *map = document->map();
+        mapSizes.append(sizeToString(map->size()));
+
+        ThumbnailRenderer renderer(map);
+        thumbnails.append(thumbnailData(renderer.render(QSize(128, 128))));
     }
     mSettings->setValue(QLatin1String("lastOpenFiles"), fileList);
     mSettings->setValue(QLatin1String("mapScale"), mapScales);
     mSettings->setValue(QLatin1String("scrollX"), scrollX);
     mSettings->setValue(QLatin1String("scrollY"), scrollY);
     mSettings->setValue(QLatin1String("selectedLayer"), selectedLayer);
+    mSettings->setValue(QLatin1String("mapSize"), mapSizes);
+    mSettings->setValue(QLatin1String("thumbnails"), thumbnails);
     mSettings->endGroup();
 }
 
@@ -1696,6 +1785,20 @@ void MainWindow::aboutTiled()
     aboutDialog.exec();
 }
 
+void MainWindow::exportTrace()
+{
+    const QString fileName =
+            QFileDialog::getSaveFileName(this, tr("Export Trace"),
+                                         QLatin1String("trace.json"),
+                                         tr("Chrome trace files (*.json)"));
+    if (fileName.isEmpty())
+        return;
+
+    QString error;
+    if (!Tracer::writeChromeTrace(fileName, &error))
+        QMessageBox::critical(this, tr("Error Exporting Trace"), error);
+}
+
 void MainWindow::retranslateUi()
 {
     updateWindowTitle();
@@ -1748,6 +1851,7 @@ void MainWindow::mapDocumentChanged(MapDocument *mapDocument)
 
     mActionHandler->setMapDocument(mapDocument);
     mLayerDock->setMapDocument(mapDocument);
+    mUndoDock->setMapDocument(mapDocument);
     mMiniMapDock->setMapDocument(mapDocument);
     mToolManager->setMapDocument(mapDocument);
     mTileSelectionManager->setMapDocument(mapDocument);
@@ -1812,15 +1916,31 @@ void MainWindow::mapDocumentChanged(MapDocument *mapDocument)
 
 void MainWindow::closeMapDocument(int index)
 {
-    if (confirmSave(mDocumentManager->documents().at(index)))
+    if (confirmSave(mDocumentManager->documentAt(index)))
         mDocumentManager->closeDocumentAt(index);
 }
 
+void MainWindow::sessionDocumentLoaded(MapDocument *mapDocument)
+{
+    // Validate the map, which is skipped while its tab is a placeholder
+    mapDocument->map()->rtbMap()->setHasError(mValidator->validate());
+}
+
 void MainWindow::reloadError(const QString &error)
 {
     QMessageBox::critical(this, tr("Error Reloading Map"), error);
 }
 
+/**
+ * Called when the current document failed to save in the background. Like a
+ * failed synchronous save, this falls back to asking for another file name.
+ */
+void MainWindow::saveError(const QString &error)
+{
+    QMessageBox::critical(this, tr("Error Saving Map"), error);
+    saveFileAsJSON();
+}
+
 void MainWindow::activateObjectSelectionTool()
 {
     if(mToolManager->selectedTool() != mObjectSelectionTool)
@@ -1908,8 +2028,8 @@ bool MainWindow::saveFileAsJSON()
 
 void MainWindow::buildMap()
 {
-    // save first
-    if(!saveFile())
+    // save first, the game reads the map from disk
+    if(!saveFile() || !mMapDocument->waitForSave())
         return;
 
     RTBCore *core = RTBCore::instance();
@@ -66,6 +66,7 @@ class TerrainDock;
 class TileAnimationEditor;
 class TileCollisionEditor;
 class TilesetDock;
+class UndoDock;
 class TileStamp;
 class TileStampManager;
 class ToolManager;
@@ -181,8 +182,10 @@ public slots:
 
     void mapDocumentChanged(MapDocument *mapDocument);
     void closeMapDocument(int index);
+    void sessionDocumentLoaded(MapDocument *mapDocument);
 
     void reloadError(const QString &error);
+    void saveError(const QString &error);
 
     void activateObjectSelectionTool();
     void activateObjectSelectionTool(MapObject *mapObject);
@@ -190,6 +193,7 @@ public slots:
 
 private slots:
     void setShowPropVisualization(bool show);
+    void exportTrace();
     void buildMap();
     void highlightSection(int section);
 
@@ -238,6 +242,7 @@ private:
     PropertiesDock *mPropertiesDock;
     LayerDock *mLayerDock;
     MapsDock *mMapsDock;
+    UndoDock *mUndoDock;
     MiniMapDock* mMiniMapDock;
     QLabel *mCurrentLayerLabel;
     Zoomable *mZoomable;
@@ -26,6 +26,7 @@
 #include "addremovetileset.h"
 #include "changeproperties.h"
 #include "changeselectedarea.h"
+#include "compressedtilelayer.h"
 #include "containerhelpers.h"
 #include "flipmapobjects.h"
 #include "hexagonalrenderer.h"
@@ -35,6 +36,7 @@
 #include "mapobjectmodel.h"
 #include "map.h"
 #include "mapobject.h"
+#include "mapwriterinterface.h"
 #include "movelayer.h"
 #include "movemapobject.h"
 #include "movemapobjecttogroup.h"
@@ -43,6 +45,7 @@
 #include "orthogonalrenderer.h"
 #include "painttilelayer.h"
 #include "pluginmanager.h"
+#include "preferences.h"
 #include "resizemap.h"
 #include "resizetilelayer.h"
 #include "rotatemapobject.h"
@@ -54,17 +57,103 @@
 #include "tilesetmanager.h"
 #include "tmxmapreader.h"
 #include "tmxmapwriter.h"
+#include "tracing.h"
 
 #include "rtbmapsettings.h"
 #include "rtbchangemapobjectproperties.h"
 
 #include <QFileInfo>
+#include <QHash>
 #include <QRect>
+#include <QRunnable>
+#include <QThreadPool>
 #include <QUndoStack>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
 
+namespace Tiled {
+namespace Internal {
+
+/**
+ * The state of a save that is running on a worker thread.
+ */
+class BackgroundSave
+{
+public:
+    int id;
+    QString fileName;
+
+    // The modification count at the time the snapshot was taken
+    int modificationCount;
+
+    // Written by the worker thread
+    bool success;
+    QString error;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+namespace {
+
+/**
+ * Writes a snapshot of a map on a worker thread.
+ */
+class SaveJob : public QRunnable
+{
+public:
+    SaveJob(MapDocument *document,
+            Map *snapshot,
+            MapWriterInterface *writer,
+            const QSharedPointer<BackgroundSave> &save)
+        : mDocument(document)
+        , mSnapshot(snapshot)
+        , mWriter(writer)
+        , mSave(save)
+    {}
+
+    ~SaveJob()
+    {
+        // The snapshot owns a copy of the RTB map settings
+        delete mSnapshot->rtbMap();
+        delete mSnapshot;
+    }
+
+    void run() override
+    {
+        mSave->success = mWriter->write(mSnapshot, mSave->fileName);
+        if (!mSave->success)
+            mSave->error = mWriter->errorString();
+
+        // The document waits for pending saves before it is deleted
+        QMetaObject::invokeMethod(mDocument, "backgroundSaveFinished",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, mSave->id));
+    }
+
+private:
+    MapDocument *mDocument;
+    Map *mSnapshot;
+    MapWriterInterface *mWriter;
+    QSharedPointer<BackgroundSave> mSave;
+};
+
+/**
+ * All saves go through a single thread, since map writers are not reentrant.
+ */
+QThreadPool *saveThreadPool()
+{
+    static QThreadPool *threadPool = 0;
+    if (!threadPool) {
+        threadPool = new QThreadPool;
+        threadPool->setMaxThreadCount(1);
+    }
+    return threadPool;
+}
+
+} // anonymous namespace
+
 MapDocument::MapDocument(Map *map, const QString &fileName):
     mFileName(fileName),
     mMap(map),
@@ -74,6 +163,8 @@ MapDocument::MapDocument(Map *map, const QString &fileName):
     mMapObjectModel(new MapObjectModel(this)),
     mTerrainModel(new TerrainModel(this, this)),
     mUndoStack(new QUndoStack(this)),
+    mUndoMemoryUsage(0),
+    mModificationCount(0),
     mValidatorModel(new RTBValidatorModel(this))
 {
     createRenderer();
@@ -111,7 +202,22 @@ MapDocument::MapDocument(Map *map, const QString &fileName):
     connect(mTerrainModel, SIGNAL(terrainRemoved(Terrain*)),
             SLOT(onTerrainRemoved(Terrain*)));
 
+    // Collect the fine-grained change notifications, to be delivered merged
+    // once the event loop is reached again
+    mChangesTimer.setSingleShot(true);
+    mChangesTimer.setInterval(0);
+    connect(&mChangesTimer, SIGNAL(timeout()), SLOT(flushChanges()));
+    connect(this, SIGNAL(regionChanged(QRegion)),
+            SLOT(collectRegionChanged(QRegion)));
+    connect(this, SIGNAL(objectsChanged(QList<MapObject*>)),
+            SLOT(collectObjectsChanged(QList<MapObject*>)));
+    connect(this, SIGNAL(layerChanged(int)), SLOT(collectLayerChanged(int)));
+
     connect(mUndoStack, SIGNAL(cleanChanged(bool)), SIGNAL(modifiedChanged()));
+    connect(mUndoStack, SIGNAL(indexChanged(int)), SLOT(updateUndoPayloads()));
+    connect(Preferences::instance(), SIGNAL(undoMemoryBudgetChanged(int)),
+            SLOT(updateUndoPayloads()));
+    connect(mUndoStack, SIGNAL(indexChanged(int)), SLOT(countModification()));
 
     // Register tileset references
     TilesetManager *tilesetManager = TilesetManager::instance();
@@ -120,6 +226,10 @@ MapDocument::MapDocument(Map *map, const QString &fileName):
 
 MapDocument::~MapDocument()
 {
+    // The save job refers to this document
+    if (mBackgroundSave)
+        waitForBackgroundSaves();
+
     // Unregister tileset references
     TilesetManager *tilesetManager = TilesetManager::instance();
     tilesetManager->removeReferences(mMap->tilesets());
@@ -134,18 +244,127 @@ bool MapDocument::save(QString *error)
 }
 
 bool MapDocument::save(const QString &fileName, QString *error)
+{
+    TILED_TRACE("MapDocument::save");
+
+    // Make sure the writer is not in use by a background save
+    waitForSave();
+    waitForBackgroundSaves();
+
+    MapWriterInterface *chosenWriter = writer();
+    if (!chosenWriter)
+        return false;
+
+    if (!chosenWriter->write(map(), fileName)) {
+        if (error)
+            *error = chosenWriter->errorString();
+        return false;
+    }
+
+    undoStack()->setClean();
+    setFileName(fileName);
+    mLastSaved = QFileInfo(fileName).lastModified();
+
+    emit saved();
+    return true;
+}
+
+bool MapDocument::saveInBackground(const QString &fileName, QString *error)
+{
+    MapWriterInterface *chosenWriter = writer();
+    if (!chosenWriter) {
+        if (error)
+            *error = tr("No map writer found.");
+        return false;
+    }
+
+    static int lastId = 0;
+
+    // A save that is still pending is superseded by this one
+    QSharedPointer<BackgroundSave> save(new BackgroundSave);
+    save->id = ++lastId;
+    save->fileName = fileName;
+    save->modificationCount = mModificationCount;
+    save->success = false;
+
+    Map *snapshot = new Map(*mMap);
+    snapshot->setRTBMap(new RTBMap(*mMap->rtbMap()));
+
+    // The tilesets may be changed while the map is written, so the snapshot
+    // refers to copies of them instead. Tile images are implicitly shared.
+    foreach (const SharedTileset &tileset, mMap->tilesets())
+        snapshot->replaceTileset(tileset, tileset->clone());
+
+    mBackgroundSave = save;
+    saveThreadPool()->start(new SaveJob(this, snapshot, chosenWriter, save));
+
+    return true;
+}
+
+bool MapDocument::waitForSave()
+{
+    bool success = true;
+
+    // A failed save may be followed by another one, when the user picks a
+    // different file name in response to saveFailed()
+    while (mBackgroundSave) {
+        const QSharedPointer<BackgroundSave> save = mBackgroundSave;
+        waitForBackgroundSaves();
+        finishBackgroundSave();
+        success = save->success;
+    }
+
+    return success;
+}
+
+void MapDocument::waitForBackgroundSaves()
+{
+    saveThreadPool()->waitForDone();
+}
+
+void MapDocument::backgroundSaveFinished(int id)
+{
+    // Ignore superseded saves, and saves already finished by waitForSave()
+    if (!mBackgroundSave || mBackgroundSave->id != id)
+        return;
+
+    finishBackgroundSave();
+}
+
+void MapDocument::finishBackgroundSave()
+{
+    const QSharedPointer<BackgroundSave> save = mBackgroundSave;
+    mBackgroundSave.clear();
+
+    if (!save->success) {
+        emit saveFailed(save->error);
+        return;
+    }
+
+    // Only mark the document as clean when the saved snapshot is still the
+    // current state of the map
+    if (mModificationCount == save->modificationCount)
+        mUndoStack->setClean();
+
+    setFileName(save->fileName);
+    mLastSaved = QFileInfo(save->fileName).lastModified();
+
+    emit saved();
+}
+
+MapWriterInterface *MapDocument::writer()
 {
     PluginManager *pm = PluginManager::instance();
 
     MapWriterInterface *chosenWriter = 0;
     if (const Plugin *plugin = pm->pluginByFileName(mWriterPluginFileName))
-        chosenWriter = qobject_cast<MapWriterInterface*>(plugin->instance);
+        chosenWriter = qobject_cast<MapWriterInterface*>(plugin->instance());
 
     // if writer could not found search for the plugin file and set chosenWriter
     if (!chosenWriter)
     {
-        foreach (const Plugin p, pm->plugins()) {
-            QString fileName = p.fileName;
+        foreach (const Plugin *p, pm->plugins()) {
+            QString fileName = p->fileName;
             if(fileName.contains(QString::fromStdString("json.dll")))
             {
                 mWriterPluginFileName = fileName;
@@ -154,36 +373,27 @@ bool MapDocument::save(const QString &fileName, QString *error)
         }
 
         if (const Plugin *plugin = pm->pluginByFileName(mWriterPluginFileName))
-            chosenWriter = qobject_cast<MapWriterInterface*>(plugin->instance);
-        else
-            return false;
-    }
-
-    if (!chosenWriter->write(map(), fileName)) {
-        if (error)
-            *error = chosenWriter->errorString();
-        return false;
+            chosenWriter = qobject_cast<MapWriterInterface*>(plugin->instance());
     }
 
-    undoStack()->setClean();
-    setFileName(fileName);
-    mLastSaved = QFileInfo(fileName).lastModified();
-
-    emit saved();
-    return true;
+    return chosenWriter;
 }
 
 MapDocument *MapDocument::load(const QString &fileName,
                                MapReaderInterface *mapReader,
                                QString *error)
 {
+    TILED_TRACE("MapDocument::load");
+
     TmxMapReader tmxMapReader;
 
-    const PluginManager *pm = PluginManager::instance();
+    PluginManager *pm = PluginManager::instance();
     if (!mapReader && !tmxMapReader.supportsFile(fileName)) {
-        // Try to find a plugin that implements support for this format
+        // Try to find a plugin that implements support for this format. Only
+        // the plugins that declare a matching name filter are loaded, unless
+        // none of them supports the file.
         QList<MapReaderInterface*> readers =
-                pm->interfaces<MapReaderInterface>();
+                pm->interfacesForFile<MapReaderInterface>(fileName);
 
         foreach (MapReaderInterface *reader, readers) {
             if (reader->supportsFile(fileName)) {
@@ -191,6 +401,15 @@ MapDocument *MapDocument::load(const QString &fileName,
                 break;
             }
         }
+
+        if (!mapReader) {
+            foreach (MapReaderInterface *reader, pm->interfaces<MapReaderInterface>()) {
+                if (reader->supportsFile(fileName)) {
+                    mapReader = reader;
+                    break;
+                }
+            }
+        }
     }
 
     // check if we can save in that format as well
@@ -199,7 +418,7 @@ MapDocument *MapDocument::load(const QString &fileName,
     if (mapReader) {
         if (const Plugin *plugin = pm->plugin(mapReader)) {
             readerPluginFileName = plugin->fileName;
-            if (qobject_cast<MapWriterInterface*>(plugin->instance))
+            if (qobject_cast<MapWriterInterface*>(plugin->instance()))
                 writerPluginFileName = plugin->fileName;
         }
     } else {
@@ -803,6 +1022,7 @@ void MapDocument::emitTilesetChanged(Tileset *tileset)
  */
 void MapDocument::onObjectsRemoved(const QList<MapObject*> &objects)
 {
+    forgetChangedObjects(objects);
     deselectObjects(objects);
     emit objectsRemoved(objects);
 }
@@ -864,8 +1084,11 @@ void MapDocument::onLayerAboutToBeRemoved(int index)
         setCurrentObject(0);
 
     // Deselect any objects on this layer when necessary
-    if (ObjectGroup *og = dynamic_cast<ObjectGroup*>(layer))
+    if (ObjectGroup *og = dynamic_cast<ObjectGroup*>(layer)) {
+        forgetChangedObjects(og->objects());
         deselectObjects(og->objects());
+    }
+    mChanges.layers.removeOne(layer);
     emit layerAboutToBeRemoved(index);
 }
 
@@ -884,12 +1107,134 @@ void MapDocument::onLayerRemoved(int index)
         emit currentLayerIndexChanged(mCurrentLayerIndex);
 }
 
+void MapDocument::collectRegionChanged(const QRegion &region)
+{
+    mChanges.region += region;
+    mChangesTimer.start();
+}
+
+void MapDocument::collectObjectsChanged(const QList<MapObject*> &objects)
+{
+    foreach (MapObject *object, objects) {
+        if (!mChangedObjects.contains(object)) {
+            mChangedObjects.insert(object);
+            mChanges.objects.append(object);
+        }
+    }
+    mChangesTimer.start();
+}
+
+void MapDocument::collectLayerChanged(int index)
+{
+    Layer *layer = mMap->layerAt(index);
+    if (!mChanges.layers.contains(layer))
+        mChanges.layers.append(layer);
+    mChangesTimer.start();
+}
+
+/**
+ * Removes objects that are no longer part of the map from the collected
+ * changes, so that listeners don't get to see them.
+ */
+void MapDocument::forgetChangedObjects(const QList<MapObject*> &objects)
+{
+    if (mChangedObjects.isEmpty())
+        return;
+
+    foreach (MapObject *object, objects) {
+        if (mChangedObjects.remove(object))
+            mChanges.objects.removeOne(object);
+    }
+}
+
+void MapDocument::flushChanges()
+{
+    mChangesTimer.stop();
+
+    if (mChanges.isEmpty())
+        return;
+
+    const MapChanges changes = mChanges;
+    mChanges = MapChanges();
+    mChangedObjects.clear();
+
+    emit changesFlushed(changes);
+}
+
 void MapDocument::onTerrainRemoved(Terrain *terrain)
 {
     if (terrain == mCurrentObject)
         setCurrentObject(0);
 }
 
+static void collectCompressibleCommands(const QUndoCommand *command,
+                                       QVector<CompressibleCommand*> &commands)
+{
+    QUndoCommand *c = const_cast<QUndoCommand*>(command);
+    if (CompressibleCommand *compressible = dynamic_cast<CompressibleCommand*>(c))
+        commands.append(compressible);
+
+    for (int i = 0; i < command->childCount(); ++i)
+        collectCompressibleCommands(command->child(i), commands);
+}
+
+/**
+ * Compresses the tile data kept by the commands on the undo stack, except for
+ * the commands closest to the current index, as far as they fit within the
+ * undo memory budget. The command at the top is never compressed, since it
+ * may still get merged with new commands.
+ */
+void MapDocument::updateUndoPayloads()
+{
+    const qint64 budget =
+            qint64(Preferences::instance()->undoMemoryBudget()) * 1024 * 1024;
+    const int index = mUndoStack->index();
+    const int count = mUndoStack->count();
+
+    qint64 usage = 0;
+
+    // Visit the commands in order of distance from the current index
+    for (int distance = 0; distance < count; ++distance) {
+        const int below = index - 1 - distance;
+        const int above = index + distance;
+
+        for (int i = 0; i < 2; ++i) {
+            const int commandIndex = i == 0 ? below : above;
+            if (commandIndex < 0 || commandIndex >= count)
+                continue;
+
+            QVector<CompressibleCommand*> commands;
+            collectCompressibleCommands(mUndoStack->command(commandIndex),
+                                        commands);
+
+            foreach (CompressibleCommand *command, commands) {
+                qint64 size = command->payloadSize();
+
+                if (commandIndex != index - 1 && usage + size > budget) {
+                    command->compressPayload();
+                    size = command->payloadSize();
+                }
+
+                usage += size;
+            }
+        }
+    }
+
+    if (mUndoMemoryUsage != usage) {
+        mUndoMemoryUsage = usage;
+        emit undoMemoryUsageChanged(usage);
+    }
+}
+
+/**
+ * Counts every change of the undo stack, including commands merged into the
+ * top command, which leave its index unchanged.
+ */
+void MapDocument::countModification()
+{
+    ++mModificationCount;
+}
+
 void MapDocument::deselectObjects(const QList<MapObject *> &objects)
 {
     // Unset the current object when it was part of this list of objects
@@ -933,15 +1278,24 @@ void MapDocument::duplicateObjects(const QList<MapObject *> &objects)
 
     mUndoStack->beginMacro(tr("Duplicate %n Object(s)", "", objects.size()));
 
+    // Add the clones to each object group at once
     QList<MapObject*> clones;
+    QList<ObjectGroup*> objectGroups;
+    QHash<ObjectGroup*, QList<MapObject*> > clonesPerGroup;
     foreach (const MapObject *mapObject, objects) {
         MapObject *clone = mapObject->clone();
         clones.append(clone);
-        mUndoStack->push(new AddMapObject(this,
-                                          mapObject->objectGroup(),
-                                          clone));
+
+        ObjectGroup *objectGroup = mapObject->objectGroup();
+        if (!clonesPerGroup.contains(objectGroup))
+            objectGroups.append(objectGroup);
+        clonesPerGroup[objectGroup].append(clone);
     }
 
+    foreach (ObjectGroup *objectGroup, objectGroups)
+        mUndoStack->push(new AddMapObjects(this, objectGroup,
+                                           clonesPerGroup.value(objectGroup)));
+
     mUndoStack->endMacro();
     setSelectedObjects(clones);
 }
@@ -952,8 +1306,7 @@ void MapDocument::removeObjects(const QList<MapObject *> &objects)
         return;
 
     mUndoStack->beginMacro(tr("Remove %n Object(s)", "", objects.size()));
-    foreach (MapObject *mapObject, objects)
-        mUndoStack->push(new RemoveMapObject(this, mapObject));
+    mUndoStack->push(new RemoveMapObjects(this, objects));
     mUndoStack->endMacro();
 }
 
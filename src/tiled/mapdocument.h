@@ -33,7 +33,10 @@
 #include <QList>
 #include <QObject>
 #include <QRegion>
+#include <QSet>
+#include <QSharedPointer>
 #include <QString>
+#include <QTimer>
 
 class QModelIndex;
 class QPoint;
@@ -47,16 +50,32 @@ class Map;
 class MapObject;
 class MapRenderer;
 class MapReaderInterface;
+class MapWriterInterface;
 class Terrain;
 class Tile;
 
 namespace Internal {
 
+class BackgroundSave;
 class LayerModel;
 class MapObjectModel;
 class TerrainModel;
 class TileSelectionModel;
 
+/**
+ * The changes made to a map document since the last changesFlushed() signal.
+ * Each object and layer is listed only once.
+ */
+struct MapChanges
+{
+    QRegion region;
+    QList<MapObject*> objects;
+    QList<Layer*> layers;
+
+    bool isEmpty() const
+    { return region.isEmpty() && objects.isEmpty() && layers.isEmpty(); }
+};
+
 /**
  * Represents an editable map. The purpose of this class is to make sure that
  * any editing operations will cause the appropriate signals to be emitted, in
@@ -101,6 +120,38 @@ public:
      */
     bool save(const QString &fileName, QString *error = 0);
 
+    /**
+     * Saves a snapshot of the map to the file at \a fileName on a worker
+     * thread, so that editing can continue while the map is written. Returns
+     * false and sets \a error when the save could not be started.
+     *
+     * When the save finished, either saved() or saveFailed() is emitted. The
+     * document is only marked as unmodified when it was not changed since
+     * the snapshot was taken.
+     */
+    bool saveInBackground(const QString &fileName, QString *error = 0);
+
+    /**
+     * Returns whether a background save of this document has not been
+     * completed yet.
+     */
+    bool isSaving() const { return !mBackgroundSave.isNull(); }
+
+    /**
+     * Waits until a pending background save of this document has finished
+     * and applies its result. When a save started in response to
+     * saveFailed() follows, it is waited for as well. Returns whether the
+     * last save was successful.
+     */
+    bool waitForSave();
+
+    /**
+     * Waits until all background saves have been written. Needed before
+     * using a map writer on the main thread, since writers are not
+     * reentrant.
+     */
+    static void waitForBackgroundSaves();
+
     /**
      * Loads a map and returns a MapDocument instance on success. Returns 0
      * on error and sets the \a error message.
@@ -221,6 +272,12 @@ public:
      */
     QUndoStack *undoStack() const { return mUndoStack; }
 
+    /**
+     * Returns the amount of memory used by the tile data kept by the commands
+     * on the undo stack, in bytes.
+     */
+    qint64 undoMemoryUsage() const { return mUndoMemoryUsage; }
+
     /**
      * Returns the selected area of tiles.
      */
@@ -288,6 +345,7 @@ signals:
     void modifiedChanged();
 
     void saved();
+    void saveFailed(const QString &error);
 
     /**
      * Emitted when the selected tile region changes. Sends the currently
@@ -345,6 +403,15 @@ signals:
      */
     void regionEdited(const QRegion &region, Layer *layer);
 
+    /**
+     * Emitted once per event loop iteration with the merged regionChanged(),
+     * objectsChanged() and layerChanged() notifications of that iteration.
+     *
+     * Listeners that do a lot of work per change should prefer this signal,
+     * since a single edit can cause hundreds of fine-grained notifications.
+     */
+    void changesFlushed(const MapChanges &changes);
+
     void tileLayerDrawMarginsChanged(TileLayer *layer);
 
     void tileTerrainChanged(const QList<Tile*> &tiles);
@@ -381,7 +448,15 @@ signals:
 
     void hasWallsChanged();
 
+    void undoMemoryUsageChanged(qint64 usage);
+
 public slots:
+    /**
+     * Emits changesFlushed() right away for any changes collected so far,
+     * rather than waiting for the event loop.
+     */
+    void flushChanges();
+
     void selectFloorLayer();
     void selectOrbLayer();
     void selectObjectLayer();
@@ -417,7 +492,20 @@ private slots:
 
     void onTerrainRemoved(Terrain *terrain);
 
+    void updateUndoPayloads();
+    void countModification();
+
+    void backgroundSaveFinished(int id);
+
+    void collectRegionChanged(const QRegion &region);
+    void collectObjectsChanged(const QList<MapObject*> &objects);
+    void collectLayerChanged(int index);
+
 private:
+    MapWriterInterface *writer();
+    void finishBackgroundSave();
+    void forgetChangedObjects(const QList<MapObject*> &objects);
+
     void setFileName(const QString &fileName);
     void deselectObjects(const QList<MapObject*> &objects);
 
@@ -445,7 +533,14 @@ private:
     MapObjectModel *mMapObjectModel;
     TerrainModel *mTerrainModel;
     QUndoStack *mUndoStack;
+    qint64 mUndoMemoryUsage;
+    int mModificationCount;
     QDateTime mLastSaved;
+    QSharedPointer<BackgroundSave> mBackgroundSave;
+
+    MapChanges mChanges;
+    QSet<MapObject*> mChangedObjects;
+    QTimer mChangesTimer;
 
     RTBValidatorModel *mValidatorModel;
 };
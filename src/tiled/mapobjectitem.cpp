@@ -55,6 +55,7 @@ MapObjectItem::MapObjectItem(MapObject *object, MapDocument *mapDocument,
     mObject(object),
     mMapDocument(mapDocument),
     mIsEditable(false),
+    mBatched(false),
     mSyncing(false),
     mRTBMapObjectItem(new RTBMapObjectItem(object, mapDocument, this)),
     mIsMoving(false)
@@ -64,6 +65,8 @@ MapObjectItem::MapObjectItem(MapObject *object, MapDocument *mapDocument,
 
 void MapObjectItem::syncWithMapObject()
 {
+    const QRectF oldArea = mBatched ? batchedArea() : QRectF();
+
     // Update the whole object when the name or polygon has changed
     if (mObject->name() != mName || mObject->polygon() != mPolygon) {
         mName = mObject->name();
@@ -71,11 +74,7 @@ void MapObjectItem::syncWithMapObject()
         update();
     }
 
-    const QColor color = objectColor(mObject);
-    if (mColor != color) {
-        mColor = color;
-        update();
-    }
+    syncColor();
 
     QString toolTip = mName;
     const QString &type = mObject->type();
@@ -113,6 +112,18 @@ void MapObjectItem::syncWithMapObject()
         mRTBMapObjectItem->updateBoundingRect();
         mPosition = mObject->position();
     }
+
+    if (mBatched)
+        updateBatchedArea(oldArea);
+}
+
+void MapObjectItem::syncColor()
+{
+    const QColor color = objectColor(mObject);
+    if (mColor != color) {
+        mColor = color;
+        update();
+    }
 }
 
 void MapObjectItem::setEditable(bool editable)
@@ -127,9 +138,69 @@ void MapObjectItem::setEditable(bool editable)
     else
         unsetCursor();
 
+    if (mBatched) {
+        // Editable items paint themselves, to appear on top of the others
+        setFlag(QGraphicsItem::ItemHasNoContents, !mIsEditable);
+        mRTBMapObjectItem->setEditable(mIsEditable);
+        updateBatchedArea(batchedArea());
+    }
+
     update();
 }
 
+void MapObjectItem::setBatched(bool batched)
+{
+    if (mBatched == batched)
+        return;
+
+    mBatched = batched;
+
+    setFlag(QGraphicsItem::ItemHasNoContents, mBatched && !mIsEditable);
+    mRTBMapObjectItem->setBatched(mBatched);
+    mRTBMapObjectItem->setEditable(mIsEditable);
+
+    if (mBatched)
+        updateBatchedArea(batchedArea());
+    else
+        update();
+}
+
+void MapObjectItem::paintBatched(QPainter *painter, const QRectF &exposedRect,
+                                 qreal scale)
+{
+    if (!exposedRect.intersects(batchedArea()))
+        return;
+
+    const bool rotated = rotation() != 0;
+    if (rotated) {
+        painter->save();
+        painter->translate(pos());
+        painter->rotate(rotation());
+        painter->translate(-pos());
+    }
+
+    MapRenderer *renderer = mMapDocument->renderer();
+    renderer->setPainterScale(scale);
+    renderer->drawMapObject(painter, mObject, mColor);
+
+    if (rotated)
+        painter->restore();
+
+    mRTBMapObjectItem->paintBatched(painter, pos());
+}
+
+QRectF MapObjectItem::batchedArea() const
+{
+    return mapRectToParent(mBoundingRect) |
+            RTBMapObjectItem::batchedRect().translated(pos());
+}
+
+void MapObjectItem::updateBatchedArea(const QRectF &oldArea)
+{
+    if (ObjectGroupItem *ogItem = static_cast<ObjectGroupItem*>(parentItem()))
+        ogItem->objectAreaChanged(oldArea, batchedArea());
+}
+
 QRectF MapObjectItem::boundingRect() const
 {
     return mBoundingRect;
@@ -66,6 +66,12 @@ public:
      */
     void syncWithMapObject();
 
+    /**
+     * Updates only the color of this item. Should be called when the object
+     * types have changed, since these determine the color.
+     */
+    void syncColor();
+
     /**
      * Sets whether this map object is editable. Editable map objects can be
      * resized and get a move cursor.
@@ -75,6 +81,29 @@ public:
     bool isEditable() const
     { return mIsEditable; }
 
+    /**
+     * Sets whether this item is painted by its ObjectGroupItem. A batched
+     * item only paints itself while it is editable.
+     */
+    void setBatched(bool batched);
+
+    bool isBatched() const
+    { return mBatched; }
+
+    /**
+     * Paints this item on behalf of its batched ObjectGroupItem, when it
+     * intersects with the \a exposedRect. The painter is expected to be in
+     * the coordinates of the object group item.
+     */
+    void paintBatched(QPainter *painter, const QRectF &exposedRect,
+                      qreal scale);
+
+    /**
+     * Returns the area painted for this item when batched, in the
+     * coordinates of its object group item.
+     */
+    QRectF batchedArea() const;
+
     // QGraphicsItem
     QRectF boundingRect() const;
     QPainterPath shape() const;
@@ -110,6 +139,7 @@ public:
 private:
     MapDocument *mapDocument() const { return mMapDocument; }
     QColor color() const { return mColor; }
+    void updateBatchedArea(const QRectF &oldArea);
 
     MapObject *mObject;
     MapDocument *mMapDocument;
@@ -120,6 +150,7 @@ private:
     QPolygonF mPolygon; // Copy of the polygon, for the same reason
     QColor mColor;      // Cached color of the object
     bool mIsEditable;
+    bool mBatched;
     bool mSyncing;
     RTBMapObjectItem *mRTBMapObjectItem;
     QPointF mPosition;
@@ -48,7 +48,7 @@ QModelIndex MapObjectModel::index(int row, int column,
 {
     if (!parent.isValid()) {
         if (row < mObjectGroups.count())
-            return createIndex(row, column, mGroups[mObjectGroups.at(row)]);
+            return createIndex(row, column, mGroups.value(mObjectGroups.at(row)));
         return QModelIndex();
     }
 
@@ -59,10 +59,12 @@ QModelIndex MapObjectModel::index(int row, int column,
         return QModelIndex();
 
     // Paranoia: sometimes "fake" objects are in use (see createobjecttool)
-    if (!mObjects.contains(og->objects().at(row)))
+    ObjectOrGroup *oog = mObjects.value(og->objectAt(row));
+    if (!oog)
         return QModelIndex();
 
-    return createIndex(row, column, mObjects[og->objects()[row]]);
+    oog->mRow = row;
+    return createIndex(row, column, oog);
 }
 
 QModelIndex MapObjectModel::parent(const QModelIndex &index) const
@@ -232,15 +234,26 @@ QVariant MapObjectModel::headerData(int section, Qt::Orientation orientation,
 QModelIndex MapObjectModel::index(ObjectGroup *og) const
 {
     const int row = mObjectGroups.indexOf(og);
-    Q_ASSERT(mGroups[og]);
-    return createIndex(row, 0, mGroups[og]);
+    ObjectOrGroup *oog = mGroups.value(og);
+    Q_ASSERT(oog);
+    return createIndex(row, 0, oog);
 }
 
 QModelIndex MapObjectModel::index(MapObject *o, int column) const
 {
-    const int row = o->objectGroup()->objects().indexOf(o);
-    Q_ASSERT(mObjects[o]);
-    return createIndex(row, column, mObjects[o]);
+    ObjectOrGroup *oog = mObjects.value(o);
+    Q_ASSERT(oog);
+
+    // Looking up the row is linear in the amount of objects, so the last
+    // known row is tried first
+    const ObjectGroup *og = o->objectGroup();
+    int row = oog->mRow;
+    if (row < 0 || row >= og->objectCount() || og->objectAt(row) != o) {
+        row = og->objects().indexOf(o);
+        oog->mRow = row;
+    }
+
+    return createIndex(row, column, oog);
 }
 
 ObjectGroup *MapObjectModel::toObjectGroup(const QModelIndex &index) const
@@ -366,26 +379,59 @@ void MapObjectModel::layerAboutToBeRemoved(int index)
 
 void MapObjectModel::insertObject(ObjectGroup *og, int index, MapObject *o)
 {
-    const int row = (index >= 0) ? index : og->objectCount();
-    beginInsertRows(this->index(og), row, row);
-    og->insertObject(row, o);
-    mObjects.insert(o, new ObjectOrGroup(o));
-    endInsertRows();
-    emit objectsAdded(QList<MapObject*>() << o);
+    insertObjects(og, index, QList<MapObject*>() << o);
 }
 
 int MapObjectModel::removeObject(ObjectGroup *og, MapObject *o)
+{
+    const int row = og->objects().indexOf(o);
+    removeObjects(og, row, 1);
+    return row;
+}
+
+void MapObjectModel::insertObjects(ObjectGroup *og, int index,
+                                   const QList<MapObject*> &objects)
+{
+    if (objects.isEmpty())
+        return;
+
+    const int first = (index >= 0) ? index : og->objectCount();
+    const int last = first + objects.size() - 1;
+
+    beginInsertRows(this->index(og), first, last);
+    for (int i = 0; i < objects.size(); ++i) {
+        MapObject *o = objects.at(i);
+        og->insertObject(first + i, o);
+
+        ObjectOrGroup *oog = new ObjectOrGroup(o);
+        oog->mRow = first + i;
+        mObjects.insert(o, oog);
+    }
+    endInsertRows();
+
+    emit objectsAdded(objects);
+}
+
+QList<MapObject*> MapObjectModel::removeObjects(ObjectGroup *og, int index,
+                                                int count)
 {
     QList<MapObject*> objects;
-    objects << o;
+    if (count <= 0)
+        return objects;
 
-    const int row = og->objects().indexOf(o);
-    beginRemoveRows(index(og), row, row);
-    og->removeObjectAt(row);
-    delete mObjects.take(o);
+    objects.reserve(count);
+    for (int i = index; i < index + count; ++i)
+        objects.append(og->objectAt(i));
+
+    beginRemoveRows(this->index(og), index, index + count - 1);
+    for (int i = index + count - 1; i >= index; --i) {
+        delete mObjects.take(og->objectAt(i));
+        og->removeObjectAt(i);
+    }
     endRemoveRows();
+
     emit objectsRemoved(objects);
-    return row;
+    return objects;
 }
 
 void MapObjectModel::moveObjects(ObjectGroup *og, int from, int to, int count)
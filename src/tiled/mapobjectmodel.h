@@ -22,6 +22,7 @@
 #define MAPOBJECTMODEL_H
 
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QIcon>
 
 namespace Tiled {
@@ -53,15 +54,18 @@ public:
         ObjectOrGroup(ObjectGroup *g)
             : mGroup(g)
             , mObject(0)
+            , mRow(-1)
         {
         }
         ObjectOrGroup(MapObject *o)
             : mGroup(0)
             , mObject(o)
+            , mRow(-1)
         {
         }
         ObjectGroup *mGroup;
         MapObject *mObject;
+        int mRow;           // Last known row of the object, may be outdated
     };
 
     MapObjectModel(QObject *parent = 0);
@@ -91,6 +95,20 @@ public:
 
     void insertObject(ObjectGroup *og, int index, MapObject *o);
     int removeObject(ObjectGroup *og, MapObject *o);
+
+    /**
+     * Inserts the given \a objects as consecutive rows starting at \a index,
+     * or at the end when \a index is -1. Emits a single range of inserted
+     * rows.
+     */
+    void insertObjects(ObjectGroup *og, int index,
+                       const QList<MapObject*> &objects);
+
+    /**
+     * Removes \a count objects starting at \a index. Emits a single range
+     * of removed rows. Returns the removed objects.
+     */
+    QList<MapObject*> removeObjects(ObjectGroup *og, int index, int count);
     void moveObjects(ObjectGroup *og, int from, int to, int count);
     void emitObjectsChanged(const QList<MapObject *> &objects);
 
@@ -116,8 +134,8 @@ private:
     MapDocument *mMapDocument;
     Map *mMap;
     QList<ObjectGroup*> mObjectGroups;
-    QMap<MapObject*, ObjectOrGroup*> mObjects;
-    QMap<ObjectGroup*, ObjectOrGroup*> mGroups;
+    QHash<MapObject*, ObjectOrGroup*> mObjects;
+    QHash<ObjectGroup*, ObjectOrGroup*> mGroups;
 
     QIcon mObjectGroupIcon;
 };
@@ -41,13 +41,16 @@
 #include "imagelayeritem.h"
 #include "toolmanager.h"
 #include "tilesetmanager.h"
+#include "tracing.h"
 
 #include "objectselectiontool.h"
 #include "stampbrush.h"
 #include "rtbmapsettings.h"
 
 #include <QGraphicsSceneMouseEvent>
+#include <QHash>
 #include <QPainter>
+#include <QSet>
 #include <QKeyEvent>
 #include <QApplication>
 
@@ -59,6 +62,68 @@ using namespace Tiled::Internal;
 static const qreal darkeningFactor = 0.6;
 static const qreal opacityFactor = 0.4;
 
+/**
+ * Object groups with at least this amount of objects are painted by their
+ * object group item, rather than by each map object item.
+ */
+static const int batchedObjectCount = 1000;
+
+/**
+ * Deletes the given map object item, repainting its area when it was painted
+ * by its object group item.
+ */
+static void deleteObjectItem(MapObjectItem *item)
+{
+    if (item->isBatched())
+        item->parentItem()->update(item->batchedArea());
+    delete item;
+}
+
+namespace {
+
+class MatchesAnyTile
+{
+public:
+    MatchesAnyTile(const QSet<Tile*> &tiles) : mTiles(tiles) {}
+
+    bool operator() (const Cell &cell) const
+    { return mTiles.contains(cell.tile); }
+
+private:
+    const QSet<Tile*> &mTiles;
+};
+
+} // anonymous namespace
+
+static Layer *layerForItem(QGraphicsItem *item)
+{
+    if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
+        return tli->tileLayer();
+    if (ObjectGroupItem *ogi = dynamic_cast<ObjectGroupItem*>(item))
+        return ogi->objectGroup();
+    if (ImageLayerItem *ili = dynamic_cast<ImageLayerItem*>(item))
+        return ili->imageLayer();
+    return 0;
+}
+
+MapScene::SceneGeometry::SceneGeometry()
+    : orientation(-1)
+    , hexSideLength(0)
+    , staggerAxis(0)
+    , staggerIndex(0)
+{
+}
+
+bool MapScene::SceneGeometry::operator==(const SceneGeometry &other) const
+{
+    return orientation == other.orientation &&
+            mapSize == other.mapSize &&
+            tileSize == other.tileSize &&
+            hexSideLength == other.hexSideLength &&
+            staggerAxis == other.staggerAxis &&
+            staggerIndex == other.staggerIndex;
+}
+
 MapScene::MapScene(QObject *parent):
     QGraphicsScene(parent),
     mMapDocument(0),
@@ -66,6 +131,7 @@ MapScene::MapScene(QObject *parent):
     mActiveTool(0),
     mUnderMouse(false),
     mCurrentModifiers(Qt::NoModifier),
+    mTileSelectionItem(0),
     mDarkRectangle(new QGraphicsRectItem),
     mDefaultBackgroundColor(Qt::darkGray)
 {
@@ -76,12 +142,14 @@ MapScene::MapScene(QObject *parent):
             this, SLOT(tilesetChanged(Tileset*)));
     connect(tilesetManager, SIGNAL(repaintTileset(Tileset*)),
             this, SLOT(tilesetChanged(Tileset*)));
+    connect(tilesetManager, SIGNAL(tileImagesChanged(Tileset*,QList<Tile*>)),
+            this, SLOT(tileImagesChanged(Tileset*,QList<Tile*>)));
 
     Preferences *prefs = Preferences::instance();
     connect(prefs, SIGNAL(showGridChanged(bool)), SLOT(setGridVisible(bool)));
     connect(prefs, SIGNAL(showTileObjectOutlinesChanged(bool)),
             SLOT(setShowTileObjectOutlines(bool)));
-    connect(prefs, SIGNAL(objectTypesChanged()), SLOT(syncAllObjectItems()));
+    connect(prefs, SIGNAL(objectTypesChanged()), SLOT(syncObjectItemColors()));
     connect(prefs, SIGNAL(highlightCurrentLayerChanged(bool)),
             SLOT(setHighlightCurrentLayer(bool)));
     connect(prefs, SIGNAL(gridColorChanged(QColor)), SLOT(update()));
@@ -119,6 +187,10 @@ void MapScene::setMapDocument(MapDocument *mapDocument)
         }
     }
 
+    // The items refer to the map document they were created for
+    if (mMapDocument != mapDocument)
+        clearSceneItems();
+
     mMapDocument = mapDocument;
 
     if (mMapDocument) {
@@ -128,8 +200,6 @@ void MapScene::setMapDocument(MapDocument *mapDocument)
 
         connect(mMapDocument, SIGNAL(mapChanged()),
                 this, SLOT(mapChanged()));
-        connect(mMapDocument, SIGNAL(regionChanged(QRegion)),
-                this, SLOT(repaintRegion(QRegion)));
         connect(mMapDocument, SIGNAL(tileLayerDrawMarginsChanged(TileLayer*)),
                 this, SLOT(tileLayerDrawMarginsChanged(TileLayer*)));
         connect(mMapDocument, SIGNAL(layerAdded(int)),
@@ -150,8 +220,8 @@ void MapScene::setMapDocument(MapDocument *mapDocument)
                 this, SLOT(objectsInserted(ObjectGroup*,int,int)));
         connect(mMapDocument, SIGNAL(objectsRemoved(QList<MapObject*>)),
                 this, SLOT(objectsRemoved(QList<MapObject*>)));
-        connect(mMapDocument, SIGNAL(objectsChanged(QList<MapObject*>)),
-                this, SLOT(objectsChanged(QList<MapObject*>)));
+        connect(mMapDocument, SIGNAL(changesFlushed(MapChanges)),
+                this, SLOT(changesFlushed(MapChanges)));
         connect(mMapDocument, SIGNAL(objectsIndexChanged(ObjectGroup*,int,int)),
                 this, SLOT(objectsIndexChanged(ObjectGroup*,int,int)));
         connect(mMapDocument, SIGNAL(selectedObjectsChanged()),
@@ -180,46 +250,134 @@ void MapScene::setSelectedTool(AbstractTool *tool)
 
 void MapScene::refreshScene()
 {
-    mLayerItems.clear();
-    mObjectItems.clear();
-
-    removeItem(mDarkRectangle);
-    clear();
-    addItem(mDarkRectangle);
+    TILED_TRACE("MapScene::refreshScene");
 
     if (!mMapDocument) {
+        clearSceneItems();
         setSceneRect(QRectF());
         return;
     }
 
-    const QSize mapSize = mMapDocument->renderer()->mapSize();
-    setSceneRect(0, 0, mapSize.width(), mapSize.height());
-    mDarkRectangle->setRect(0, 0, mapSize.width(), mapSize.height());
+    // Adapt the existing items before creating any new ones, since new items
+    // are already created in sync
+    syncSceneGeometry();
 
     const Map *map = mMapDocument->map();
-    mLayerItems.resize(map->layerCount());
+    const QList<Layer*> &layers = map->layers();
 
     if (map->backgroundColor().isValid())
         setBackgroundBrush(map->backgroundColor());
     else
         setBackgroundBrush(mDefaultBackgroundColor);
 
-    int layerIndex = 0;
-    foreach (Layer *layer, map->layers()) {
-        QGraphicsItem *layerItem = createLayerItem(layer);
+    QHash<Layer*, QGraphicsItem*> oldLayerItems;
+    foreach (QGraphicsItem *layerItem, mLayerItems)
+        oldLayerItems.insert(layerForItem(layerItem), layerItem);
+
+    QVector<QGraphicsItem*> layerItems(layers.size());
+
+    for (int layerIndex = 0; layerIndex < layers.size(); ++layerIndex) {
+        Layer *layer = layers.at(layerIndex);
+        QGraphicsItem *layerItem = oldLayerItems.take(layer);
+
+        if (layerItem) {
+            if (ObjectGroup *og = layer->asObjectGroup())
+                syncObjectItems(og, static_cast<ObjectGroupItem*>(layerItem));
+            layerItem->setVisible(layer->isVisible());
+        } else {
+            layerItem = createLayerItem(layer);
+            addItem(layerItem);
+        }
+
         layerItem->setZValue(layerIndex);
-        addItem(layerItem);
-        mLayerItems[layerIndex] = layerItem;
-        ++layerIndex;
+        layerItems[layerIndex] = layerItem;
     }
 
-    TileSelectionItem *selectionItem = new TileSelectionItem(mMapDocument);
-    selectionItem->setZValue(10000 - 1);
-    addItem(selectionItem);
+    // Remove the items of the layers that are no longer part of the map
+    foreach (QGraphicsItem *layerItem, oldLayerItems)
+        removeLayerItem(layerItem);
+
+    mLayerItems = layerItems;
+
+    if (!mTileSelectionItem) {
+        mTileSelectionItem = new TileSelectionItem(mMapDocument);
+        mTileSelectionItem->setZValue(10000 - 1);
+        addItem(mTileSelectionItem);
+    }
 
     updateCurrentLayerHighlight();
 }
 
+/**
+ * Removes all the items created for the current map document.
+ */
+void MapScene::clearSceneItems()
+{
+    foreach (QGraphicsItem *layerItem, mLayerItems)
+        removeLayerItem(layerItem);
+    mLayerItems.clear();
+
+    delete mTileSelectionItem;
+    mTileSelectionItem = 0;
+
+    mSceneGeometry = SceneGeometry();
+}
+
+MapScene::SceneGeometry MapScene::sceneGeometry() const
+{
+    const Map *map = mMapDocument->map();
+
+    SceneGeometry geometry;
+    geometry.orientation = map->orientation();
+    geometry.mapSize = map->size();
+    geometry.tileSize = QSize(map->tileWidth(), map->tileHeight());
+    geometry.hexSideLength = map->hexSideLength();
+    geometry.staggerAxis = map->staggerAxis();
+    geometry.staggerIndex = map->staggerIndex();
+    return geometry;
+}
+
+/**
+ * Adapts the scene rect and the position of the existing items when the
+ * size, orientation or tile size of the map changed.
+ */
+void MapScene::syncSceneGeometry()
+{
+    const SceneGeometry geometry = sceneGeometry();
+    if (geometry == mSceneGeometry)
+        return;
+
+    const SceneGeometry previous = mSceneGeometry;
+    mSceneGeometry = geometry;
+
+    const QSize mapSize = mMapDocument->renderer()->mapSize();
+    setSceneRect(0, 0, mapSize.width(), mapSize.height());
+    mDarkRectangle->setRect(0, 0, mapSize.width(), mapSize.height());
+
+    foreach (QGraphicsItem *item, mLayerItems) {
+        if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
+            tli->syncWithTileLayer();
+        else if (ImageLayerItem *ili = dynamic_cast<ImageLayerItem*>(item))
+            ili->syncWithImageLayer();
+    }
+
+    // Only in orthogonal orientation the position of objects on the screen
+    // does not depend on the size of the map
+    SceneGeometry resized = previous;
+    resized.mapSize = geometry.mapSize;
+    if (geometry.orientation == Map::Orthogonal && resized == geometry)
+        return;
+
+    // A change of orientation also means a new renderer
+    if (previous.orientation != geometry.orientation) {
+        MapRenderer *renderer = mMapDocument->renderer();
+        renderer->setObjectLineWidth(mObjectLineWidth);
+        renderer->setFlag(ShowTileObjectOutlines, mShowTileObjectOutlines);
+    }
+
+    syncAllObjectItems();
+}
+
 QGraphicsItem *MapScene::createLayerItem(Layer *layer)
 {
     QGraphicsItem *layerItem = 0;
@@ -227,20 +385,8 @@ QGraphicsItem *MapScene::createLayerItem(Layer *layer)
     if (TileLayer *tl = layer->asTileLayer()) {
         layerItem = new TileLayerItem(tl, mMapDocument);
     } else if (ObjectGroup *og = layer->asObjectGroup()) {
-        const ObjectGroup::DrawOrder drawOrder = og->drawOrder();
         ObjectGroupItem *ogItem = new ObjectGroupItem(og);
-        int objectIndex = 0;
-        foreach (MapObject *object, og->objects()) {
-            MapObjectItem *item = new MapObjectItem(object, mMapDocument,
-                                                    ogItem);
-            if (drawOrder == ObjectGroup::TopDownOrder)
-                item->setZValue(item->y());
-            else
-                item->setZValue(objectIndex);
-
-            mObjectItems.insert(object, item);
-            ++objectIndex;
-        }
+        syncObjectItems(og, ogItem);
         layerItem = ogItem;
     } else if (ImageLayer *il = layer->asImageLayer()) {
         layerItem = new ImageLayerItem(il, mMapDocument);
@@ -252,6 +398,68 @@ QGraphicsItem *MapScene::createLayerItem(Layer *layer)
     return layerItem;
 }
 
+/**
+ * Makes sure the given object group item has an item for each object in the
+ * object group and no others. Existing items are kept.
+ */
+void MapScene::syncObjectItems(ObjectGroup *objectGroup,
+                               ObjectGroupItem *ogItem)
+{
+    const QList<MapObject*> &objects = objectGroup->objects();
+
+    if (!ogItem->childItems().isEmpty()) {
+        const QSet<MapObject*> objectSet = objects.toSet();
+
+        foreach (QGraphicsItem *child, ogItem->childItems()) {
+            MapObjectItem *item = qgraphicsitem_cast<MapObjectItem*>(child);
+            if (item && !objectSet.contains(item->mapObject())) {
+                mSelectedObjectItems.remove(item);
+                mObjectItems.remove(item->mapObject());
+                deleteObjectItem(item);
+            }
+        }
+    }
+
+    ogItem->setBatched(objects.size() >= batchedObjectCount);
+
+    const ObjectGroup::DrawOrder drawOrder = objectGroup->drawOrder();
+
+    for (int objectIndex = 0; objectIndex < objects.size(); ++objectIndex) {
+        MapObject *object = objects.at(objectIndex);
+        MapObjectItem *item = mObjectItems.value(object);
+
+        if (!item) {
+            item = new MapObjectItem(object, mMapDocument, ogItem);
+            item->setBatched(ogItem->isBatched());
+            mObjectItems.insert(object, item);
+
+            if (drawOrder == ObjectGroup::TopDownOrder)
+                item->setZValue(item->y());
+        }
+
+        if (drawOrder == ObjectGroup::IndexOrder)
+            item->setZValue(objectIndex);
+    }
+}
+
+/**
+ * Deletes the given layer item, forgetting about the object items it
+ * contains.
+ */
+void MapScene::removeLayerItem(QGraphicsItem *layerItem)
+{
+    if (ObjectGroupItem *ogItem = dynamic_cast<ObjectGroupItem*>(layerItem)) {
+        foreach (QGraphicsItem *child, ogItem->childItems()) {
+            if (MapObjectItem *item = qgraphicsitem_cast<MapObjectItem*>(child)) {
+                mSelectedObjectItems.remove(item);
+                mObjectItems.remove(item->mapObject());
+            }
+        }
+    }
+
+    delete layerItem;
+}
+
 void MapScene::updateCurrentLayerHighlight()
 {
     if (!mMapDocument)
@@ -336,18 +544,17 @@ void MapScene::currentLayerIndexChanged()
  */
 void MapScene::mapChanged()
 {
-    const QSize mapSize = mMapDocument->renderer()->mapSize();
-    setSceneRect(0, 0, mapSize.width(), mapSize.height());
-    mDarkRectangle->setRect(0, 0, mapSize.width(), mapSize.height());
+    // Many map properties don't affect the items at all, so they are only
+    // synchronized when the geometry of the map changed
+    syncSceneGeometry();
 
+    // Batched object group items paint the validation state of the objects
     foreach (QGraphicsItem *item, mLayerItems) {
-        if (TileLayerItem *tli = dynamic_cast<TileLayerItem*>(item))
-            tli->syncWithTileLayer();
+        ObjectGroupItem *ogItem = dynamic_cast<ObjectGroupItem*>(item);
+        if (ogItem && ogItem->isBatched())
+            ogItem->update();
     }
 
-    foreach (MapObjectItem *item, mObjectItems)
-        item->syncWithMapObject();
-
     const Map *map = mMapDocument->map();
     if (map->backgroundColor().isValid())
         setBackgroundBrush(map->backgroundColor());
@@ -364,6 +571,38 @@ void MapScene::tilesetChanged(Tileset *tileset)
         update();
 }
 
+/**
+ * Repaints only the cells and tile objects that display any of the given
+ * \a tiles.
+ */
+void MapScene::tileImagesChanged(Tileset *tileset, const QList<Tile*> &tiles)
+{
+    if (!mMapDocument)
+        return;
+
+    Map *map = mMapDocument->map();
+    if (!contains(map->tilesets(), tileset))
+        return;
+
+    const QSet<Tile*> changedTiles = tiles.toSet();
+    QRegion region;
+
+    foreach (Layer *layer, map->layers()) {
+        TileLayer *tileLayer = layer->asTileLayer();
+        if (!tileLayer || !tileLayer->referencesTileset(tileset))
+            continue;
+
+        region |= tileLayer->region(MatchesAnyTile(changedTiles));
+    }
+
+    repaintRegion(region);
+
+    for (MapObjectItem *item : mObjectItems) {
+        if (changedTiles.contains(item->mapObject()->cell().tile))
+            update(item->mapRectToScene(item->boundingRect()));
+    }
+}
+
 void MapScene::tileLayerDrawMarginsChanged(TileLayer *tileLayer)
 {
     const int index = mMapDocument->map()->layers().indexOf(tileLayer);
@@ -385,7 +624,7 @@ void MapScene::layerAdded(int index)
 
 void MapScene::layerRemoved(int index)
 {
-    delete mLayerItems.at(index);
+    removeLayerItem(mLayerItems.at(index));
     mLayerItems.remove(index);
 }
 
@@ -468,12 +707,16 @@ void MapScene::objectsInserted(ObjectGroup *objectGroup, int first, int last)
 
     Q_ASSERT(ogItem);
 
+    // The group may have grown large enough to be painted in one pass
+    ogItem->setBatched(objectGroup->objectCount() >= batchedObjectCount);
+
     const ObjectGroup::DrawOrder drawOrder = objectGroup->drawOrder();
 
     for (int i = first; i <= last; ++i) {
         MapObject *object = objectGroup->objectAt(i);
 
         MapObjectItem *item = new MapObjectItem(object, mMapDocument, ogItem);
+        item->setBatched(ogItem->isBatched());
         if (drawOrder == ObjectGroup::TopDownOrder)
             item->setZValue(item->y());
         else
@@ -488,14 +731,24 @@ void MapScene::objectsInserted(ObjectGroup *objectGroup, int first, int last)
  */
 void MapScene::objectsRemoved(const QList<MapObject*> &objects)
 {
+    QSet<ObjectGroupItem*> ogItems;
+
     foreach (MapObject *o, objects) {
         ObjectItems::iterator i = mObjectItems.find(o);
         Q_ASSERT(i != mObjectItems.end());
 
+        ogItems.insert(static_cast<ObjectGroupItem*>(i.value()->parentItem()));
+
         mSelectedObjectItems.remove(i.value());
-        delete i.value();
+        deleteObjectItem(i.value());
         mObjectItems.erase(i);
     }
+
+    // Groups that became small again are painted per object
+    foreach (ObjectGroupItem *ogItem, ogItems) {
+        const int count = ogItem->objectGroup()->objectCount();
+        ogItem->setBatched(count >= batchedObjectCount);
+    }
 }
 
 /**
@@ -511,6 +764,20 @@ void MapScene::objectsChanged(const QList<MapObject*> &objects)
     }
 }
 
+/**
+ * Repaints the changed region and synchronizes the changed objects once for
+ * all the changes made during an event loop iteration.
+ */
+void MapScene::changesFlushed(const MapChanges &changes)
+{
+    TILED_TRACE("MapScene::changesFlushed");
+
+    if (!changes.region.isEmpty())
+        repaintRegion(changes.region);
+
+    objectsChanged(changes.objects);
+}
+
 /**
  * Updates the Z value of the objects when appropriate.
  */
@@ -525,6 +792,11 @@ void MapScene::objectsIndexChanged(ObjectGroup *objectGroup,
         Q_ASSERT(item);
 
         item->setZValue(i);
+
+        // The stacking order of batched items is only visible through
+        // their object group item
+        if (item->isBatched())
+            item->parentItem()->update(item->batchedArea());
     }
 }
 
@@ -556,6 +828,15 @@ void MapScene::syncAllObjectItems()
         item->syncWithMapObject();
 }
 
+/**
+ * The object types only determine the color of the objects.
+ */
+void MapScene::syncObjectItemColors()
+{
+    foreach (MapObjectItem *item, mObjectItems)
+        item->syncColor();
+}
+
 /**
  * Sets whether the tile grid is visible.
  */
@@ -580,8 +861,7 @@ void MapScene::setObjectLineWidth(qreal lineWidth)
 
         // Changing the line width can change the size of the object items
         if (!mObjectItems.isEmpty()) {
-            foreach (MapObjectItem *item, mObjectItems)
-                item->syncWithMapObject();
+            syncAllObjectItems();
 
             update();
         }
@@ -35,6 +35,7 @@ class ImageLayer;
 class Layer;
 class MapObject;
 class ObjectGroup;
+class Tile;
 class TileLayer;
 class Tileset;
 
@@ -42,9 +43,11 @@ namespace Internal {
 
 class AbstractTool;
 class MapDocument;
+struct MapChanges;
 class MapObjectItem;
 class MapScene;
 class ObjectGroupItem;
+class TileSelectionItem;
 
 /**
  * A graphics scene that represents the contents of a map.
@@ -142,7 +145,9 @@ private slots:
     void setHighlightCurrentLayer(bool highlightCurrentLayer);
 
     /**
-     * Refreshes the map scene.
+     * Refreshes the map scene. Existing layer and object items are reused,
+     * only the items of layers and objects that appeared or vanished are
+     * created or destroyed.
      */
     void refreshScene();
 
@@ -155,6 +160,7 @@ private slots:
 
     void mapChanged();
     void tilesetChanged(Tileset *tileset);
+    void tileImagesChanged(Tileset *tileset, const QList<Tile*> &tiles);
     void tileLayerDrawMarginsChanged(TileLayer *tileLayer);
 
     void layerAdded(int index);
@@ -169,13 +175,40 @@ private slots:
     void objectsInserted(ObjectGroup *objectGroup, int first, int last);
     void objectsRemoved(const QList<MapObject*> &objects);
     void objectsChanged(const QList<MapObject*> &objects);
+    void changesFlushed(const MapChanges &changes);
     void objectsIndexChanged(ObjectGroup *objectGroup, int first, int last);
 
     void updateSelectedObjectItems();
-    void syncAllObjectItems();
+    void syncObjectItemColors();
 
 private:
+    /**
+     * The properties of the map that determine the placement of the items.
+     */
+    struct SceneGeometry
+    {
+        SceneGeometry();
+
+        bool operator==(const SceneGeometry &other) const;
+        bool operator!=(const SceneGeometry &other) const
+        { return !(*this == other); }
+
+        int orientation;
+        QSize mapSize;
+        QSize tileSize;
+        int hexSideLength;
+        int staggerAxis;
+        int staggerIndex;
+    };
+
+    SceneGeometry sceneGeometry() const;
+    void syncSceneGeometry();
+    void syncAllObjectItems();
+
     QGraphicsItem *createLayerItem(Layer *layer);
+    void syncObjectItems(ObjectGroup *objectGroup, ObjectGroupItem *ogItem);
+    void removeLayerItem(QGraphicsItem *layerItem);
+    void clearSceneItems();
 
     void updateCurrentLayerHighlight();
 
@@ -194,7 +227,9 @@ private:
     Qt::KeyboardModifiers mCurrentModifiers;
     QPointF mLastMousePos;
     QVector<QGraphicsItem*> mLayerItems;
+    TileSelectionItem *mTileSelectionItem;
     QGraphicsRectItem *mDarkRectangle;
+    SceneGeometry mSceneGeometry;
     QColor mDefaultBackgroundColor;
 
     typedef QMap<MapObject*, MapObjectItem*> ObjectItems;
@@ -161,23 +161,13 @@ MapsView::MapsView(MainWindow *mainWindow, QWidget *parent)
     mFSModel = new FileSystemModel(this);
     mFSModel->setRootPath(mapsDir.absolutePath());
 
-    PluginManager *pm = PluginManager::instance();
-    QStringList nameFilters(QLatin1String("*.tmx"));
-
-    // The file system model name filters are plain, whereas the plugins expose
-    // a filter as part of the file description
-    QRegExp filterFinder(QLatin1String("\\((\\*\\.[^\\)\\s]*)"));
-
-    foreach (MapReaderInterface *reader, pm->interfaces<MapReaderInterface>()) {
-        foreach (const QString &filter, reader->nameFilters()) {
-            if (filterFinder.indexIn(filter) != -1)
-                nameFilters.append(filterFinder.cap(1));
-        }
-    }
-
     mFSModel->setFilter(QDir::AllDirs | QDir::Files | QDir::NoDot);
-    mFSModel->setNameFilters(nameFilters);
     mFSModel->setNameFilterDisables(false); // hide filtered files
+    updateNameFilters();
+
+    // Plugins without name filters in their metadata add theirs once loaded
+    connect(PluginManager::instance(), SIGNAL(pluginLoaded(QObject*)),
+            SLOT(updateNameFilters()));
 
     setModel(mFSModel);
 
@@ -204,6 +194,18 @@ QSize MapsView::sizeHint() const
     return QSize(130, 100);
 }
 
+/**
+ * Sets the name filters of the supported map formats. They are taken from
+ * the plugin metadata, to avoid loading the plugins.
+ */
+void MapsView::updateNameFilters()
+{
+    QStringList nameFilters(QLatin1String("*.tmx"));
+    nameFilters.append(PluginManager::instance()->nameFilters<MapReaderInterface>(false));
+
+    mFSModel->setNameFilters(nameFilters);
+}
+
 void MapsView::mousePressEvent(QMouseEvent *event)
 {
     QModelIndex index = indexAt(event->pos());
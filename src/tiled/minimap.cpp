@@ -32,6 +32,7 @@
 #include "objectgroup.h"
 #include "preferences.h"
 #include "tilelayer.h"
+#include "tracing.h"
 #include "zoomable.h"
 
 #include <QCursor>
@@ -170,6 +171,8 @@ static bool objectLessThan(const MapObject *a, const MapObject *b)
 
 void MiniMap::renderMapToImage()
 {
+    TILED_TRACE("MiniMap::renderMapToImage");
+
     if (!mMapDocument) {
         mMapImage = QImage();
         return;
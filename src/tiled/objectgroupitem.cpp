@@ -22,13 +22,18 @@
 
 #include "map.h"
 #include "mapobjectitem.h"
+#include "mapview.h"
 #include "objectgroup.h"
+#include "zoomable.h"
+
+#include <QStyleOptionGraphicsItem>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
 
 ObjectGroupItem::ObjectGroupItem(ObjectGroup *objectGroup):
-    mObjectGroup(objectGroup)
+    mObjectGroup(objectGroup),
+    mBatched(false)
 {
     // Since we don't do any painting, we can spare us the call to paint()
     setFlag(QGraphicsItem::ItemHasNoContents);
@@ -40,13 +45,58 @@ ObjectGroupItem::ObjectGroupItem(ObjectGroup *objectGroup):
     setOpacity(objectGroup->opacity());
 }
 
+void ObjectGroupItem::setBatched(bool batched)
+{
+    if (mBatched == batched)
+        return;
+
+    prepareGeometryChange();
+    mBatched = batched;
+    mBoundingRect = QRectF();
+
+    setFlag(QGraphicsItem::ItemHasNoContents, !batched);
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption, batched);
+
+    foreach (QGraphicsItem *child, childItems())
+        if (MapObjectItem *item = qgraphicsitem_cast<MapObjectItem*>(child))
+            item->setBatched(batched);
+}
+
+void ObjectGroupItem::objectAreaChanged(const QRectF &oldArea,
+                                        const QRectF &newArea)
+{
+    if (!mBatched)
+        return;
+
+    // The bounding rect only grows, which avoids having to look at all the
+    // objects when one of them shrinks or moves away
+    if (!mBoundingRect.contains(newArea)) {
+        prepareGeometryChange();
+        mBoundingRect |= newArea;
+    }
+
+    update(oldArea);
+    update(newArea);
+}
+
 QRectF ObjectGroupItem::boundingRect() const
 {
-    return QRectF();
+    return mBoundingRect;
 }
 
-void ObjectGroupItem::paint(QPainter *,
-                            const QStyleOptionGraphicsItem *,
-                            QWidget *)
+void ObjectGroupItem::paint(QPainter *painter,
+                            const QStyleOptionGraphicsItem *option,
+                            QWidget *widget)
 {
+    if (!mBatched)
+        return;
+
+    const qreal scale = static_cast<MapView*>(widget->parent())->zoomable()->scale();
+
+    // The children are sorted by stacking order
+    foreach (QGraphicsItem *child, childItems()) {
+        MapObjectItem *item = qgraphicsitem_cast<MapObjectItem*>(child);
+        if (item && item->isVisible() && !item->isEditable())
+            item->paintBatched(painter, option->exposedRect, scale);
+    }
 }
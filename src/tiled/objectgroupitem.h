@@ -30,9 +30,13 @@ class ObjectGroup;
 namespace Internal {
 
 /**
- * A graphics item representing an object group in a QGraphicsView. It only
+ * A graphics item representing an object group in a QGraphicsView. It
  * serves to group together the objects belonging to the same object group.
  *
+ * In batched mode, this item paints all its map object items that are not
+ * being edited in a single paint() call, which scales much better to large
+ * amounts of objects. The map object items are still there for hit testing.
+ *
  * @see MapObjectItem
  */
 class ObjectGroupItem : public QGraphicsItem
@@ -43,6 +47,19 @@ public:
     ObjectGroup *objectGroup() const
     { return mObjectGroup; }
 
+    /**
+     * Sets whether this item paints its map object items itself. The map
+     * object items are informed through MapObjectItem::setBatched.
+     */
+    void setBatched(bool batched);
+    bool isBatched() const { return mBatched; }
+
+    /**
+     * Should be called by a batched map object item when its area changed.
+     * The rectangles are in the coordinates of this item.
+     */
+    void objectAreaChanged(const QRectF &oldArea, const QRectF &newArea);
+
     // QGraphicsItem
     QRectF boundingRect() const;
     void paint(QPainter *painter,
@@ -51,6 +68,8 @@ public:
 
 private:
     ObjectGroup *mObjectGroup;
+    QRectF mBoundingRect;
+    bool mBatched;
 };
 
 } // namespace Internal
@@ -43,22 +43,20 @@ PaintTileLayer::PaintTileLayer(MapDocument *mapDocument,
     mPaintedRegion(x, y, source->width(), source->height()),
     mMergeable(false)
 {
-    mErased = mTarget->copy(mX - mTarget->x(),
-                            mY - mTarget->y(),
-                            mSource->width(), mSource->height());
+    mErased.setLayer(mTarget->copy(mX - mTarget->x(),
+                                   mY - mTarget->y(),
+                                   source->width(), source->height()));
     setText(QCoreApplication::translate("Undo Commands", "Paint"));
 }
 
 PaintTileLayer::~PaintTileLayer()
 {
-    delete mSource;
-    delete mErased;
 }
 
 void PaintTileLayer::undo()
 {
     TilePainter painter(mMapDocument, mTarget);
-    painter.setCells(mX, mY, mErased, mPaintedRegion);
+    painter.setCells(mX, mY, mErased.layer(), mPaintedRegion);
 
     QUndoCommand::undo(); // undo child commands
 }
@@ -68,7 +66,7 @@ void PaintTileLayer::redo()
     QUndoCommand::redo(); // redo child commands
 
     TilePainter painter(mMapDocument, mTarget);
-    painter.drawCells(mX, mY, mSource);
+    painter.drawCells(mX, mY, mSource.layer());
 }
 
 bool PaintTileLayer::mergeWith(const QUndoCommand *other)
@@ -81,14 +79,19 @@ bool PaintTileLayer::mergeWith(const QUndoCommand *other)
 
     const QRegion newRegion = o->mPaintedRegion.subtracted(mPaintedRegion);
     const QRegion combinedRegion = mPaintedRegion.united(o->mPaintedRegion);
-    const QRect bounds = QRect(mX, mY, mSource->width(), mSource->height());
+    TileLayer *source = mSource.layer();
+    TileLayer *erased = mErased.layer();
+    const TileLayer *otherSource = o->mSource.layer();
+    const TileLayer *otherErased = o->mErased.layer();
+
+    const QRect bounds = QRect(mX, mY, source->width(), source->height());
     const QRect combinedBounds = combinedRegion.boundingRect();
 
     // Resize the erased tiles and source layers when necessary
     if (bounds != combinedBounds) {
         const QPoint shift = bounds.topLeft() - combinedBounds.topLeft();
-        mErased->resize(combinedBounds.size(), shift);
-        mSource->resize(combinedBounds.size(), shift);
+        erased->resize(combinedBounds.size(), shift);
+        source->resize(combinedBounds.size(), shift);
     }
 
     mX = combinedBounds.left();
@@ -97,15 +100,26 @@ bool PaintTileLayer::mergeWith(const QUndoCommand *other)
 
     // Copy the painted tiles from the other command over
     const QPoint pos = QPoint(o->mX, o->mY) - combinedBounds.topLeft();
-    mSource->merge(pos, o->mSource);
+    source->merge(pos, otherSource);
 
     // Copy the newly erased tiles from the other command over
     foreach (const QRect &rect, newRegion.rects())
         for (int y = rect.top(); y <= rect.bottom(); ++y)
             for (int x = rect.left(); x <= rect.right(); ++x)
-                mErased->setCell(x - mX,
-                                 y - mY,
-                                 o->mErased->cellAt(x - o->mX, y - o->mY));
+                erased->setCell(x - mX,
+                                y - mY,
+                                otherErased->cellAt(x - o->mX, y - o->mY));
 
     return true;
 }
+
+void PaintTileLayer::compressPayload()
+{
+    mSource.compress();
+    mErased.compress();
+}
+
+qint64 PaintTileLayer::payloadSize() const
+{
+    return mSource.memoryUsage() + mErased.memoryUsage();
+}
@@ -21,6 +21,7 @@
 #ifndef PAINTTILELAYER_H
 #define PAINTTILELAYER_H
 
+#include "compressedtilelayer.h"
 #include "undocommands.h"
 
 #include <QRegion>
@@ -37,7 +38,7 @@ class MapDocument;
 /**
  * A command that paints one tile layer on top of another tile layer.
  */
-class PaintTileLayer : public QUndoCommand
+class PaintTileLayer : public QUndoCommand, public CompressibleCommand
 {
 public:
     /**
@@ -68,11 +69,14 @@ public:
     int id() const { return Cmd_PaintTileLayer; }
     bool mergeWith(const QUndoCommand *other);
 
+    void compressPayload();
+    qint64 payloadSize() const;
+
 private:
     MapDocument *mMapDocument;
     TileLayer *mTarget;
-    TileLayer *mSource;
-    TileLayer *mErased;
+    CompressedTileLayer mSource;
+    CompressedTileLayer mErased;
     int mX, mY;
     QRegion mPaintedRegion;
     bool mMergeable;
@@ -21,16 +21,115 @@
 #include "pluginmanager.h"
 
 #include "mapwriterinterface.h"
+#include "tracing.h"
 
 #include <QApplication>
 #include <QDebug>
 #include <QDir>
 #include <QDirIterator>
+#include <QFileInfo>
 #include <QPluginLoader>
+#include <QRegExp>
+#include <QRunnable>
+#include <QThreadPool>
+
+#if QT_VERSION >= 0x050000
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#endif
 
 using namespace Tiled;
 using namespace Tiled::Internal;
 
+namespace {
+
+/**
+ * Loads a plugin library on a worker thread. The plugin instance is created
+ * afterwards on the main thread.
+ */
+class LoadLibraryJob : public QRunnable
+{
+public:
+    LoadLibraryJob(const QString &fileName)
+        : mFileName(fileName)
+    {}
+
+    void run() override
+    {
+        TILED_TRACE("Plugin::load");
+
+        QPluginLoader loader(mFileName);
+        loader.load();
+    }
+
+private:
+    QString mFileName;
+};
+
+} // anonymous namespace
+
+Plugin::Plugin(const QString &fileName, QObject *instance)
+    : fileName(fileName)
+    , mHasNameFilters(false)
+    , mInstance(instance)
+    , mLoaded(true)
+{
+}
+
+Plugin::Plugin(const QString &fileName,
+               const QStringList &interfaces,
+               const QStringList &nameFilters,
+               bool hasNameFilters)
+    : fileName(fileName)
+    , mInterfaces(interfaces)
+    , mNameFilters(nameFilters)
+    , mHasNameFilters(hasNameFilters)
+    , mInstance(0)
+    , mLoaded(false)
+{
+}
+
+QObject *Plugin::instance() const
+{
+    if (!mLoaded) {
+        mLoaded = true;
+
+        QPluginLoader loader(fileName);
+        mInstance = loader.instance();
+
+        if (mInstance)
+            emit PluginManager::instance()->pluginLoaded(mInstance);
+        else
+            qWarning() << "Error:" << qPrintable(loader.errorString());
+    }
+
+    return mInstance;
+}
+
+bool Plugin::provides(const char *iid) const
+{
+    if (mInterfaces.isEmpty())
+        return true;
+
+    return mInterfaces.contains(QLatin1String(iid));
+}
+
+bool Plugin::matchesFileName(const QString &fileName) const
+{
+    if (!mHasNameFilters)
+        return true;
+
+    const QString name = QFileInfo(fileName).fileName();
+    foreach (const QString &filter, mNameFilters) {
+        QRegExp regExp(filter, Qt::CaseInsensitive, QRegExp::Wildcard);
+        if (regExp.exactMatch(name))
+            return true;
+    }
+
+    return false;
+}
+
 PluginManager *PluginManager::mInstance = 0;
 
 PluginManager::PluginManager()
@@ -39,6 +138,7 @@ PluginManager::PluginManager()
 
 PluginManager::~PluginManager()
 {
+    qDeleteAll(mPlugins);
 }
 
 PluginManager *PluginManager::instance()
@@ -57,9 +157,11 @@ void PluginManager::deleteInstance()
 
 void PluginManager::loadPlugins()
 {
+    TILED_TRACE("PluginManager::loadPlugins");
+
     // Load static plugins
     foreach (QObject *instance, QPluginLoader::staticInstances())
-        mPlugins.append(Plugin(QLatin1String("<static>"), instance));
+        mPlugins.append(new Plugin(QLatin1String("<static>"), instance));
 
     // Determine the plugin path based on the application location
 #ifndef TILED_PLUGIN_DIR
@@ -76,7 +178,7 @@ void PluginManager::loadPlugins()
     pluginPath += QLatin1String("/../lib/tiled/plugins");
 #endif
 
-    // Load dynamic plugins
+    // Find dynamic plugins
     QDirIterator iterator(pluginPath, QDir::Files | QDir::Readable);
     while (iterator.hasNext()) {
         const QString &pluginFile = iterator.next();
@@ -84,6 +186,27 @@ void PluginManager::loadPlugins()
             continue;
 
         QPluginLoader loader(pluginFile);
+
+#if QT_VERSION >= 0x050000
+        // Reading the metadata does not load the library
+        const QJsonObject pluginMetaData = loader.metaData();
+        if (pluginMetaData.isEmpty()) {
+            qWarning() << "Error: Not a plugin:" << qPrintable(pluginFile);
+            continue;
+        }
+
+        const QJsonObject metaData =
+                pluginMetaData.value(QLatin1String("MetaData")).toObject();
+        const QStringList nameFilters =
+                metaData.value(QLatin1String("NameFilters")).toVariant().toStringList();
+
+        // Plugins that only know their name filters at runtime leave them
+        // out or empty, and are loaded to ask for them
+        mPlugins.append(new Plugin(pluginFile,
+                                   metaData.value(QLatin1String("Interfaces")).toVariant().toStringList(),
+                                   nameFilters,
+                                   !nameFilters.isEmpty()));
+#else
         QObject *instance = loader.instance();
 
         if (!instance) {
@@ -91,27 +214,82 @@ void PluginManager::loadPlugins()
             continue;
         }
 
-        mPlugins.append(Plugin(pluginFile, instance));
+        mPlugins.append(new Plugin(pluginFile, instance));
+#endif
+    }
+}
+
+/**
+ * Returns the plugins that may provide the interface with the given \a iid
+ * and, when given, match the \a fileName. Makes sure these plugins are
+ * loaded.
+ */
+QList<const Plugin*> PluginManager::loadProviders(const char *iid,
+                                                  const QString &fileName)
+{
+    QList<const Plugin*> providers;
+    QList<const Plugin*> unloaded;
+
+    foreach (const Plugin *plugin, mPlugins) {
+        if (!plugin->provides(iid))
+            continue;
+        if (!fileName.isEmpty() && !plugin->matchesFileName(fileName))
+            continue;
+
+        providers.append(plugin);
+        if (!plugin->isLoaded())
+            unloaded.append(plugin);
+    }
+
+    // The plugin libraries are independent, so they are loaded in parallel
+    if (unloaded.size() > 1) {
+        QThreadPool threadPool;
+        foreach (const Plugin *plugin, unloaded)
+            threadPool.start(new LoadLibraryJob(plugin->fileName));
+        threadPool.waitForDone();
+    }
+
+    foreach (const Plugin *plugin, unloaded)
+        plugin->instance();
+
+    return providers;
+}
+
+/**
+ * Extracts the plain file name patterns from the given \a nameFilters, which
+ * contain them as part of a file description.
+ */
+QStringList PluginManager::namePatterns(const QStringList &nameFilters)
+{
+    QRegExp filterFinder(QLatin1String("\\((\\*\\.[^\\)\\s]*)"));
+
+    QStringList patterns;
+    foreach (const QString &filter, nameFilters) {
+        if (filterFinder.indexIn(filter) != -1)
+            patterns.append(filterFinder.cap(1));
     }
+    return patterns;
 }
 
 const Plugin *PluginManager::pluginByFileName(const QString &pluginFileName) const
 {
-    foreach (const Plugin &plugin, mPlugins)
-        if (pluginFileName == plugin.fileName)
-            return &plugin;
+    foreach (const Plugin *plugin, mPlugins)
+        if (pluginFileName == plugin->fileName)
+            return plugin;
 
     return 0;
 }
 
-const Plugin *PluginManager::pluginByNameFilter(const QString &pluginFilter) const
+const Plugin *PluginManager::pluginByNameFilter(const QString &pluginFilter)
 {
-    foreach (const Plugin &plugin, mPlugins) {
+    const char *iid = qobject_interface_iid<MapWriterInterface*>();
+
+    foreach (const Plugin *plugin, loadProviders(iid)) {
         MapWriterInterface *writer =
-                qobject_cast<MapWriterInterface*>(plugin.instance);
+                qobject_cast<MapWriterInterface*>(plugin->instance());
 
         if (writer && writer->nameFilters().contains(pluginFilter))
-            return &plugin;
+            return plugin;
     }
 
     return 0;
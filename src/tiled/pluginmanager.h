@@ -24,29 +24,78 @@
 #include <QList>
 #include <QObject>
 #include <QString>
+#include <QStringList>
 
 namespace Tiled {
 namespace Internal {
 
 /**
- * A loaded plugin.
+ * A plugin found by the plugin manager.
+ *
+ * The interfaces and file name patterns of a plugin are read from the
+ * "Interfaces" and "NameFilters" entries of its plugin.json, without loading
+ * the plugin library. The library is only loaded once the instance of the
+ * plugin is first requested.
  */
-struct Plugin
+class Plugin
 {
-    Plugin(const QString &fileName, QObject *instance)
-        : fileName(fileName)
-        , instance(instance)
-    {}
+public:
+    /**
+     * Creates a plugin for an already loaded \a instance.
+     */
+    Plugin(const QString &fileName, QObject *instance);
+
+    /**
+     * Creates a plugin that is loaded on demand. Empty \a interfaces means
+     * that the plugin did not declare them, in which case it is assumed to
+     * provide any interface.
+     */
+    Plugin(const QString &fileName,
+           const QStringList &interfaces,
+           const QStringList &nameFilters,
+           bool hasNameFilters);
 
     QString fileName;
-    QObject *instance;
+
+    /**
+     * Returns the plugin instance, loading the plugin when necessary.
+     * Returns 0 when the plugin failed to load.
+     */
+    QObject *instance() const;
+
+    bool isLoaded() const { return mLoaded; }
+
+    /**
+     * Returns whether this plugin may provide the interface with the given
+     * \a iid, without loading it.
+     */
+    bool provides(const char *iid) const;
+
+    /**
+     * Returns whether the name filters of this plugin match the given
+     * \a fileName. Plugins that declare no name filters match any file.
+     */
+    bool matchesFileName(const QString &fileName) const;
+
+    bool hasNameFilters() const { return mHasNameFilters; }
+    const QStringList &nameFilters() const { return mNameFilters; }
+
+private:
+    QStringList mInterfaces;
+    QStringList mNameFilters;
+    bool mHasNameFilters;
+
+    mutable QObject *mInstance;
+    mutable bool mLoaded;
 };
 
 /**
  * The plugin manager loads the plugins and provides ways to access them.
  */
-class PluginManager
+class PluginManager : public QObject
 {
+    Q_OBJECT
+
 public:
     /**
      * Returns the plugin manager instance.
@@ -56,30 +105,70 @@ public:
     static void deleteInstance();
 
     /**
-     * Scans the plugin directory for plugins and attempts to load them.
+     * Scans the plugin directory for plugins and reads their metadata. The
+     * plugins themselves are loaded when they are first needed.
      */
     void loadPlugins();
 
     /**
      * Returns the list of plugins found by the plugin manager.
      */
-    const QList<Plugin> &plugins() const { return mPlugins; }
+    const QList<Plugin*> &plugins() const { return mPlugins; }
 
     /**
-     * Returns the list of plugins that implement a given interface.
+     * Returns the list of plugins that implement a given interface. Loads
+     * the plugins that may implement it and are not loaded yet.
      */
-    template<typename T> QList<T*> interfaces() const
+    template<typename T> QList<T*> interfaces()
     {
         QList<T*> results;
-        foreach (const Plugin &plugin, mPlugins)
-            if (T *result = qobject_cast<T*>(plugin.instance))
+        foreach (const Plugin *plugin, loadProviders(qobject_interface_iid<T*>()))
+            if (T *result = qobject_cast<T*>(plugin->instance()))
                 results.append(result);
         return results;
     }
 
+    /**
+     * Returns the list of plugins that implement a given interface and whose
+     * name filters match the given \a fileName. Only these plugins are
+     * loaded.
+     */
+    template<typename T> QList<T*> interfacesForFile(const QString &fileName)
+    {
+        QList<T*> results;
+        foreach (const Plugin *plugin, loadProviders(qobject_interface_iid<T*>(),
+                                                     fileName))
+            if (T *result = qobject_cast<T*>(plugin->instance()))
+                results.append(result);
+        return results;
+    }
+
+    /**
+     * Returns the file name patterns supported by the plugins that provide a
+     * given interface. Only plugins that declare no name filters in their
+     * metadata need to be loaded for this. When \a loadPlugins is false,
+     * such plugins are skipped unless they are already loaded.
+     */
+    template<typename T> QStringList nameFilters(bool loadPlugins = true)
+    {
+        QStringList results;
+        foreach (const Plugin *plugin, mPlugins) {
+            if (!plugin->provides(qobject_interface_iid<T*>()))
+                continue;
+
+            if (plugin->hasNameFilters())
+                results.append(plugin->nameFilters());
+            else if (!loadPlugins && !plugin->isLoaded())
+                continue;
+            else if (T *result = qobject_cast<T*>(plugin->instance()))
+                results.append(namePatterns(result->nameFilters()));
+        }
+        return results;
+    }
+
     const Plugin *pluginByFileName(const QString &pluginFileName) const;
 
-    const Plugin *pluginByNameFilter(const QString &pluginFilter) const;
+    const Plugin *pluginByNameFilter(const QString &pluginFilter);
 
     /**
      * Returns the plugin, which implements the given interface.
@@ -88,22 +177,36 @@ public:
      */
     template<typename T> const Plugin *plugin(T *interface) const
     {
-        foreach (const Plugin &plugin, mPlugins)
-            if (T *result = qobject_cast<T*>(plugin.instance))
-                if (result == interface)
-                    return &plugin;
+        foreach (const Plugin *plugin, mPlugins)
+            if (plugin->isLoaded())
+                if (T *result = qobject_cast<T*>(plugin->instance()))
+                    if (result == interface)
+                        return plugin;
         return 0;
     }
 
+signals:
+    /**
+     * Emitted when the instance of a plugin was created.
+     */
+    void pluginLoaded(QObject *instance);
+
 private:
     Q_DISABLE_COPY(PluginManager)
 
+    friend class Plugin;    // Emits pluginLoaded()
+
     PluginManager();
     ~PluginManager();
 
+    QList<const Plugin*> loadProviders(const char *iid,
+                                       const QString &fileName = QString());
+
+    static QStringList namePatterns(const QStringList &nameFilters);
+
     static PluginManager *mInstance;
 
-    QList<Plugin> mPlugins;
+    QList<Plugin*> mPlugins;
 };
 
 } // namespace Internal
@@ -68,6 +68,7 @@ Preferences::Preferences()
                              Map::RightDown).toInt();
     mDtdEnabled = boolValue("DtdEnabled");
     mReloadTilesetsOnChange = boolValue("ReloadTilesets", true);
+    mUndoMemoryBudget = intValue("UndoMemoryBudget", 64);
     mSettings->endGroup();
 
     // Retrieve interface settings
@@ -329,6 +330,22 @@ void Preferences::setReloadTilesetsOnChanged(bool value)
     tilesetManager->setReloadTilesetsOnChange(mReloadTilesetsOnChange);
 }
 
+/**
+ * Sets the amount of memory, in megabytes, that the undo commands of each
+ * map may use before their tile data gets compressed.
+ */
+void Preferences::setUndoMemoryBudget(int megabytes)
+{
+    if (mUndoMemoryBudget == megabytes)
+        return;
+
+    mUndoMemoryBudget = megabytes;
+    mSettings->setValue(QLatin1String("Storage/UndoMemoryBudget"),
+                        mUndoMemoryBudget);
+
+    emit undoMemoryBudgetChanged(mUndoMemoryBudget);
+}
+
 void Preferences::setUseOpenGL(bool useOpenGL)
 {
     if (mUseOpenGL == useOpenGL)
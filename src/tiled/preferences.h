@@ -72,6 +72,9 @@ public:
     bool reloadTilesetsOnChange() const;
     void setReloadTilesetsOnChanged(bool value);
 
+    int undoMemoryBudget() const { return mUndoMemoryBudget; }
+    void setUndoMemoryBudget(int megabytes);
+
     bool useOpenGL() const { return mUseOpenGL; }
     void setUseOpenGL(bool useOpenGL);
 
@@ -145,6 +148,7 @@ signals:
     void highlightCurrentLayerChanged(bool highlight);
     void showTilesetGridChanged(bool showTilesetGrid);
 
+    void undoMemoryBudgetChanged(int megabytes);
     void useOpenGLChanged(bool useOpenGL);
 
     void objectTypesChanged();
@@ -182,6 +186,7 @@ private:
     bool mDtdEnabled;
     QString mLanguage;
     bool mReloadTilesetsOnChange;
+    int mUndoMemoryBudget;
     bool mUseOpenGL;
     ObjectTypes mObjectTypes;
 
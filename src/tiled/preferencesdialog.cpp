@@ -313,6 +313,7 @@ void PreferencesDialog::fromPreferences()
     //mUi->reloadTilesetImages->setChecked(prefs->reloadTilesetsOnChange());
     //mUi->enableDtd->setChecked(prefs->dtdEnabled());
     mUi->openLastFiles->setChecked(prefs->openLastFilesOnStartup());
+    mUi->undoMemoryBudget->setValue(prefs->undoMemoryBudget());
     //if (mUi->openGL->isEnabled())
         //mUi->openGL->setChecked(prefs->useOpenGL());
 
@@ -338,6 +339,7 @@ void PreferencesDialog::toPreferences()
     //prefs->setDtdEnabled(mUi->enableDtd->isChecked());
     //prefs->setAutomappingDrawing(mUi->autoMapWhileDrawing->isChecked());
     prefs->setOpenLastFilesOnStartup(mUi->openLastFiles->isChecked());
+    prefs->setUndoMemoryBudget(mUi->undoMemoryBudget->value());
     prefs->setGameDirectory(mUi->gamePath->text());
 }
 
@@ -64,6 +64,7 @@ namespace Internal {
 PropertyBrowser::PropertyBrowser(QWidget *parent)
     : QtTreePropertyBrowser(parent)
     , mUpdating(false)
+    , mPropertiesTileId(-1)
     , mObject(0)
     , mMapDocument(0)
     , mVariantManager(new VariantPropertyManager(this))
@@ -117,12 +118,37 @@ void PropertyBrowser::setObject(Object *object)
     if (mObject == object)
         return;
 
+    // Map objects of the same kind share the same properties, so only their
+    // values need to be updated
+    if (canReuseProperties(object)) {
+        mObject = object;
+
+        mUpdating = true;
+        updateTargetNames(mPropertiesTileId);
+        mUpdating = false;
+
+        updateProperties();
+        updateCustomProperties();
+        return;
+    }
+
     removeProperties();
     mObject = object;
 
     addProperties();
 }
 
+bool PropertyBrowser::canReuseProperties(const Object *object) const
+{
+    if (!object || mPropertiesTileId == -1)
+        return false;
+    if (object->typeId() != Object::MapObjectType)
+        return false;
+
+    const Tile *tile = static_cast<const MapObject*>(object)->cell().tile;
+    return tile && tile->id() == mPropertiesTileId;
+}
+
 void PropertyBrowser::setMapDocument(MapDocument *mapDocument)
 {
     if (mMapDocument == mapDocument)
@@ -138,10 +164,8 @@ void PropertyBrowser::setMapDocument(MapDocument *mapDocument)
     if (mapDocument) {
         connect(mapDocument, SIGNAL(mapChanged()),
                 SLOT(mapChanged()));
-        connect(mapDocument, SIGNAL(objectsChanged(QList<MapObject*>)),
-                SLOT(objectsChanged(QList<MapObject*>)));
-        connect(mapDocument, SIGNAL(layerChanged(int)),
-                SLOT(layerChanged(int)));
+        connect(mapDocument, SIGNAL(changesFlushed(MapChanges)),
+                SLOT(changesFlushed(MapChanges)));
         connect(mapDocument, SIGNAL(objectGroupChanged(ObjectGroup*)),
                 SLOT(objectGroupChanged(ObjectGroup*)));
         connect(mapDocument, SIGNAL(imageLayerChanged(ImageLayer*)),
@@ -205,16 +229,38 @@ void PropertyBrowser::mapChanged()
         updateProperties();
 }
 
-void PropertyBrowser::objectsChanged(const QList<MapObject *> &objects)
+/**
+ * Updates the properties at most once for all the changes made during an
+ * event loop iteration.
+ */
+void PropertyBrowser::changesFlushed(const MapChanges &changes)
 {
-    if (mObject && mObject->typeId() == Object::MapObjectType)
-        if (objects.contains(static_cast<MapObject*>(mObject)))
-            updateProperties();
-}
+    if (!mObject)
+        return;
 
-void PropertyBrowser::layerChanged(int index)
-{
-    if (mObject == mMapDocument->map()->layerAt(index))
+    bool changed = false;
+
+    switch (mObject->typeId()) {
+    case Object::MapObjectType:
+        // Any change to the selected objects may affect the conflicts
+        foreach (Object *object, mConflictObjects) {
+            if (changes.objects.contains(static_cast<MapObject*>(object))) {
+                mConflictObjects.clear();
+                changed = true;
+                break;
+            }
+        }
+        if (changes.objects.contains(static_cast<MapObject*>(mObject)))
+            changed = true;
+        break;
+    case Object::LayerType:
+        changed = changes.layers.contains(static_cast<Layer*>(mObject));
+        break;
+    default:
+        break;
+    }
+
+    if (changed)
         updateProperties();
 }
 
@@ -451,6 +497,7 @@ void PropertyBrowser::addMapObjectProperties()
 
     int tileID = static_cast<const MapObject*>(mObject)->cell().tile->id();
     addRTBMapObjectProperties(tileID);
+    mPropertiesTileId = tileID;
 }
 
 void PropertyBrowser::addLayerProperties(QtProperty *parent)
@@ -1066,6 +1113,8 @@ void PropertyBrowser::removeProperties()
     mPropertyToId.clear();
     mIdToProperty.clear();
     mNameToProperty.clear();
+    mPropertiesTileId = -1;
+    mConflictObjects.clear();
 }
 
 void PropertyBrowser::updateProperties()
@@ -1127,10 +1176,7 @@ void PropertyBrowser::updateProperties()
         }
 
          // RTB
-        if(mMapDocument->currentObjects().size() > 1)
-            updatePropMultipleSelection();
-        else
-            removeConflicts();
+        updateConflicts();
 
         RTBMapObject *rtbMapObject = mapObject->rtbMapObject();
 
@@ -1434,6 +1480,27 @@ void PropertyBrowser::updateProperties()
     mUpdating = false;
 }
 
+/**
+ * Updates the conflict markers of the properties, which show that the
+ * selected objects have different values. They are only computed again when
+ * the selection changed, or when changesFlushed() found a selected object to
+ * have changed.
+ */
+void PropertyBrowser::updateConflicts()
+{
+    const QList<Object*> selection = mMapDocument->currentObjects();
+
+    if (selection.size() > 1) {
+        if (selection != mConflictObjects) {
+            updatePropMultipleSelection();
+            mConflictObjects = selection;
+        }
+    } else if (!mConflictObjects.isEmpty()) {
+        removeConflicts();
+        mConflictObjects.clear();
+    }
+}
+
 void PropertyBrowser::removeConflicts()
 {
     for(QtVariantProperty *prop : mIdToProperty)
@@ -2112,49 +2179,11 @@ void PropertyBrowser::addRTBMapObjectProperties(int tileID)
 
         QtVariantProperty *laserBeamTargetsProp = createProperty(RTBLaserBeamTargets, QVariant::String, tr("Laser Beam Targets"), groupProperty);
 
-        mButtonTargetNames.clear();
-        mButtonTargetNames.append(QLatin1String(""));
-
-        QStringList usedTargets;
-
-        // find all possible laser beam objects
-        QList<MapObject *> objects = mMapDocument->map()->objectGroups().first()->objects();
-        for(MapObject * obj : objects)
-        {
-            int id = obj->cell().tile->id();
-            if(id == RTBMapObject::LaserBeamBottom || id == RTBMapObject::LaserBeamLeft
-                    || id == RTBMapObject::LaserBeamRight || id == RTBMapObject::LaserBeamTop)
-            {
-                const RTBLaserBeam *laserBeam = static_cast<const RTBLaserBeam*>(obj->rtbMapObject());
-                if(laserBeam->beamType() != RTBMapObject::BT2)
-                    mButtonTargetNames.append(QString::number(obj->id()));
-            }
-            if(id == RTBMapObject::Button && mObject != obj)
-            {
-                const RTBButtonObject *mapObject = static_cast<const RTBButtonObject*>(obj->rtbMapObject());
-                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget1));
-                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget2));
-                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget3));
-                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget4));
-                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget5));
-            }
-        }
-
-        usedTargets.removeAll(QLatin1String(""));
-
-        // remove all possible targets which are already target of an other button
-        for(QString s : usedTargets)
-        {
-            mButtonTargetNames.removeAll(s);
-        }
-
-
         QtVariantProperty *target1Prop =
                 createProperty(RTBLaserBeamTarget1,
                                QtVariantPropertyManager::enumTypeId(),
                                tr("Target ID 1"),
                                laserBeamTargetsProp);
-        target1Prop->setAttribute(QLatin1String("enumNames"), mButtonTargetNames);
         laserBeamTargetsProp->addSubProperty(target1Prop);
 
         QtVariantProperty *target2Prop =
@@ -2162,7 +2191,6 @@ void PropertyBrowser::addRTBMapObjectProperties(int tileID)
                                QtVariantPropertyManager::enumTypeId(),
                                tr("Target ID 2"),
                                laserBeamTargetsProp);
-        target2Prop->setAttribute(QLatin1String("enumNames"), mButtonTargetNames);
         laserBeamTargetsProp->addSubProperty(target2Prop);
 
         QtVariantProperty *target3Prop =
@@ -2170,7 +2198,6 @@ void PropertyBrowser::addRTBMapObjectProperties(int tileID)
                                QtVariantPropertyManager::enumTypeId(),
                                tr("Target ID 3"),
                                laserBeamTargetsProp);
-        target3Prop->setAttribute(QLatin1String("enumNames"), mButtonTargetNames);
         laserBeamTargetsProp->addSubProperty(target3Prop);
 
         QtVariantProperty *target4Prop =
@@ -2178,7 +2205,6 @@ void PropertyBrowser::addRTBMapObjectProperties(int tileID)
                                QtVariantPropertyManager::enumTypeId(),
                                tr("Target ID 4"),
                                laserBeamTargetsProp);
-        target4Prop->setAttribute(QLatin1String("enumNames"), mButtonTargetNames);
         laserBeamTargetsProp->addSubProperty(target4Prop);
 
         QtVariantProperty *target5Prop =
@@ -2186,7 +2212,6 @@ void PropertyBrowser::addRTBMapObjectProperties(int tileID)
                                QtVariantPropertyManager::enumTypeId(),
                                tr("Target ID 5"),
                                laserBeamTargetsProp);
-        target5Prop->setAttribute(QLatin1String("enumNames"), mButtonTargetNames);
         laserBeamTargetsProp->addSubProperty(target5Prop);
 
 
@@ -2274,25 +2299,10 @@ void PropertyBrowser::addRTBMapObjectProperties(int tileID)
     {
         groupProperty = mGroupManager->addProperty(tr("%1").arg(RTBMapObject::objectName(RTBMapObject::Teleporter)));
 
-        mTeleporterTargetNames.clear();
-        mTeleporterTargetNames.append(QLatin1String(""));
-        // find all possible targets
-        QList<MapObject *> objects = mMapDocument->map()->objectGroups().first()->objects();
-        for(MapObject * obj : objects)
-        {
-            int id = obj->cell().tile->id();
-            if(id == RTBMapObject::Target)
-            {
-                mTeleporterTargetNames.append(QString::number(obj->id()));
-            }
-        }
-
-        QtVariantProperty *teleporterTargetProp =
-                createProperty(RTBTeleporterTarget,
-                               QtVariantPropertyManager::enumTypeId(),
-                               tr("Target ID"),
-                               groupProperty);
-        teleporterTargetProp->setAttribute(QLatin1String("enumNames"), mTeleporterTargetNames);
+        createProperty(RTBTeleporterTarget,
+                       QtVariantPropertyManager::enumTypeId(),
+                       tr("Target ID"),
+                       groupProperty);
 
         break;
     }
@@ -2328,25 +2338,10 @@ void PropertyBrowser::addRTBMapObjectProperties(int tileID)
     {
         groupProperty = mGroupManager->addProperty(tr("%1").arg(RTBMapObject::objectName(RTBMapObject::CameraTrigger)));
 
-        mTeleporterTargetNames.clear();
-        mTeleporterTargetNames.append(QLatin1String(""));
-        // find all possible targets
-        QList<MapObject *> objects = mMapDocument->map()->objectGroups().first()->objects();
-        for(MapObject * obj : objects)
-        {
-            int id = obj->cell().tile->id();
-            if(id == RTBMapObject::Target)
-            {
-                mTeleporterTargetNames.append(QString::number(obj->id()));
-            }
-        }
-
-        QtVariantProperty *teleporterTargetProp =
-                createProperty(RTBCameraTarget,
-                               QtVariantPropertyManager::enumTypeId(),
-                               tr("Target ID"),
-                               groupProperty);
-        teleporterTargetProp->setAttribute(QLatin1String("enumNames"), mTeleporterTargetNames);
+        createProperty(RTBCameraTarget,
+                       QtVariantPropertyManager::enumTypeId(),
+                       tr("Target ID"),
+                       groupProperty);
 
         QtVariantProperty *triggerZoneProp = createProperty(RTBTriggerZone, QVariant::Size, tr("Trigger Zone"), groupProperty);
         triggerZoneProp->setAttribute(QLatin1String("minimum"), QSizeF(1, 1));
@@ -2444,11 +2439,93 @@ void PropertyBrowser::addRTBMapObjectProperties(int tileID)
         break;
     }
 
+    updateTargetNames(tileID);
+
     addProperty(groupProperty);
 
     setMapObjectPropertiesTooltip(tileID);
 }
 
+/**
+ * Updates the lists of possible targets, which depend on the other objects
+ * on the map.
+ */
+void PropertyBrowser::updateTargetNames(int tileID)
+{
+    switch (tileID) {
+    case RTBMapObject::Button:
+    {
+        mButtonTargetNames.clear();
+        mButtonTargetNames.append(QLatin1String(""));
+
+        QStringList usedTargets;
+
+        // find all possible laser beam objects
+        QList<MapObject *> objects = mMapDocument->map()->objectGroups().first()->objects();
+        for(MapObject * obj : objects)
+        {
+            int id = obj->cell().tile->id();
+            if(id == RTBMapObject::LaserBeamBottom || id == RTBMapObject::LaserBeamLeft
+                    || id == RTBMapObject::LaserBeamRight || id == RTBMapObject::LaserBeamTop)
+            {
+                const RTBLaserBeam *laserBeam = static_cast<const RTBLaserBeam*>(obj->rtbMapObject());
+                if(laserBeam->beamType() != RTBMapObject::BT2)
+                    mButtonTargetNames.append(QString::number(obj->id()));
+            }
+            if(id == RTBMapObject::Button && mObject != obj)
+            {
+                const RTBButtonObject *mapObject = static_cast<const RTBButtonObject*>(obj->rtbMapObject());
+                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget1));
+                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget2));
+                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget3));
+                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget4));
+                usedTargets.append(mapObject->target(RTBChangeMapObjectProperties::RTBLaserBeamTarget5));
+            }
+        }
+
+        usedTargets.removeAll(QLatin1String(""));
+
+        // remove all possible targets which are already target of an other button
+        for(QString s : usedTargets)
+        {
+            mButtonTargetNames.removeAll(s);
+        }
+
+
+        const QLatin1String enumNames("enumNames");
+        mIdToProperty[RTBLaserBeamTarget1]->setAttribute(enumNames, mButtonTargetNames);
+        mIdToProperty[RTBLaserBeamTarget2]->setAttribute(enumNames, mButtonTargetNames);
+        mIdToProperty[RTBLaserBeamTarget3]->setAttribute(enumNames, mButtonTargetNames);
+        mIdToProperty[RTBLaserBeamTarget4]->setAttribute(enumNames, mButtonTargetNames);
+        mIdToProperty[RTBLaserBeamTarget5]->setAttribute(enumNames, mButtonTargetNames);
+        break;
+    }
+    case RTBMapObject::Teleporter:
+    case RTBMapObject::CameraTrigger:
+    {
+        mTeleporterTargetNames.clear();
+        mTeleporterTargetNames.append(QLatin1String(""));
+        // find all possible targets
+        QList<MapObject *> objects = mMapDocument->map()->objectGroups().first()->objects();
+        for(MapObject * obj : objects)
+        {
+            int id = obj->cell().tile->id();
+            if(id == RTBMapObject::Target)
+            {
+                mTeleporterTargetNames.append(QString::number(obj->id()));
+            }
+        }
+
+        const PropertyId id = tileID == RTBMapObject::Teleporter ? RTBTeleporterTarget
+                                                                 : RTBCameraTarget;
+        mIdToProperty[id]->setAttribute(QLatin1String("enumNames"), mTeleporterTargetNames);
+        break;
+    }
+    default:
+        break;
+    }
+}
+
 void PropertyBrowser::setDoublePropSettings(QtVariantProperty *property, double min, double max, double step, int decimals)
 {
     property->setAttribute(QLatin1String("minimum"), min);
@@ -45,6 +45,7 @@ class Tileset;
 namespace Internal {
 
 class MapDocument;
+struct MapChanges;
 
 class PropertyBrowser : public QtTreePropertyBrowser
 {
@@ -87,8 +88,7 @@ protected:
 
 private slots:
     void mapChanged();
-    void objectsChanged(const QList<MapObject*> &objects);
-    void layerChanged(int index);
+    void changesFlushed(const MapChanges &changes);
     void objectGroupChanged(ObjectGroup *objectGroup);
     void imageLayerChanged(ImageLayer *imageLayer);
     void tilesetChanged(Tileset *tileset);
@@ -238,7 +238,10 @@ private:
     QtVariantProperty *createIntervalOffsetProperty(QtProperty *groupProperty);
     void setTileDescription(int tileID);
     void updatePropMultipleSelection();
+    void updateConflicts();
     void removeConflicts();
+    void updateTargetNames(int tileID);
+    bool canReuseProperties(const Object *object) const;
     void setMapObjectPropertiesTooltip(int tileID);
     void setMapPropertiesTooltip();
     void updateValidationState(const RTBMapObject *mapObject, PropertyId, Tiled::RTBMapObject::PropertyId objectPropID);
@@ -248,6 +251,12 @@ private:
     QStringList mButtonTargetNames;
     QStringList mTeleporterTargetNames;
 
+    // The tile ID of the map object properties currently shown, or -1
+    int mPropertiesTileId;
+
+    // The selection for which conflicts are currently shown
+    QList<Object*> mConflictObjects;
+
     Object *mObject;
     MapDocument *mMapDocument;
 
@@ -38,33 +38,31 @@ ResizeTileLayer::ResizeTileLayer(MapDocument *mapDocument,
                                                "Resize Layer"))
     , mMapDocument(mapDocument)
     , mIndex(mapDocument->map()->layers().indexOf(layer))
-    , mOriginalLayer(0)
 {
     Q_ASSERT(mIndex != -1);
 
     // Create the resized layer (once)
-    mResizedLayer = static_cast<TileLayer*>(layer->clone());
-    mResizedLayer->resize(size, offset);
+    TileLayer *resizedLayer = static_cast<TileLayer*>(layer->clone());
+    resizedLayer->resize(size, offset);
+    mResizedLayer.setLayer(resizedLayer);
 }
 
 ResizeTileLayer::~ResizeTileLayer()
 {
-    delete mOriginalLayer;
-    delete mResizedLayer;
 }
 
 void ResizeTileLayer::undo()
 {
-    Q_ASSERT(!mResizedLayer);
-    mResizedLayer = static_cast<TileLayer*>(swapLayer(mOriginalLayer));
-    mOriginalLayer = 0;
+    Q_ASSERT(!mResizedLayer.layer());
+    Layer *replaced = swapLayer(mOriginalLayer.takeLayer());
+    mResizedLayer.setLayer(static_cast<TileLayer*>(replaced));
 }
 
 void ResizeTileLayer::redo()
 {
-    Q_ASSERT(!mOriginalLayer);
-    mOriginalLayer = static_cast<TileLayer*>(swapLayer(mResizedLayer));
-    mResizedLayer = 0;
+    Q_ASSERT(!mOriginalLayer.layer());
+    Layer *replaced = swapLayer(mResizedLayer.takeLayer());
+    mOriginalLayer.setLayer(static_cast<TileLayer*>(replaced));
 }
 
 Layer *ResizeTileLayer::swapLayer(Layer *layer)
@@ -80,3 +78,15 @@ Layer *ResizeTileLayer::swapLayer(Layer *layer)
 
     return replaced;
 }
+
+void ResizeTileLayer::compressPayload()
+{
+    // Only the layer that is not part of the map is kept by this command
+    mOriginalLayer.compress();
+    mResizedLayer.compress();
+}
+
+qint64 ResizeTileLayer::payloadSize() const
+{
+    return mOriginalLayer.memoryUsage() + mResizedLayer.memoryUsage();
+}
@@ -21,6 +21,8 @@
 #ifndef RESIZELAYER_H
 #define RESIZELAYER_H
 
+#include "compressedtilelayer.h"
+
 #include <QPoint>
 #include <QSize>
 #include <QUndoCommand>
@@ -37,7 +39,7 @@ class MapDocument;
 /**
  * Undo command that resizes a map layer.
  */
-class ResizeTileLayer : public QUndoCommand
+class ResizeTileLayer : public QUndoCommand, public CompressibleCommand
 {
 public:
     /**
@@ -54,13 +56,16 @@ public:
     void undo();
     void redo();
 
+    void compressPayload();
+    qint64 payloadSize() const;
+
 private:
     Layer *swapLayer(Layer *layer);
 
     MapDocument *mMapDocument;
     int mIndex;
-    TileLayer *mOriginalLayer;
-    TileLayer *mResizedLayer;
+    CompressedTileLayer mOriginalLayer;
+    CompressedTileLayer mResizedLayer;
 };
 
 } // namespace Internal
@@ -1001,6 +1001,9 @@ bool RTBLaserBeamItem::onStartCell()
 RTBMapObjectItem::RTBMapObjectItem(MapObject *mapObject, MapDocument *mapDocument, QGraphicsItem *parent)
     : mMapObject(mapObject)
     , mMapDocument(mapDocument)
+    , mIsPaintingAllowed(true)
+    , mParent(parent)
+    , mBatched(false)
     , mRTBVisualization(new RTBVisualization(mapObject, mapDocument, parent))
     , mRTBMapObjectValidate(new RTBMapObjectValidate(mapObject, mapDocument, parent))
     , mRTBMapObjectLabel(0)
@@ -1040,6 +1043,71 @@ void RTBMapObjectItem::updateBoundingRect()
         static_cast<RTBLaserBeamItem*>(mRTBLaserBeamItem)->updateBoundingRect();
 }
 
+void RTBMapObjectItem::setBatched(bool batched)
+{
+    if(mBatched == batched)
+        return;
+
+    mBatched = batched;
+
+    if(mBatched)
+    {
+        delete mRTBMapObjectValidate;
+        mRTBMapObjectValidate = 0;
+        delete mRTBVisualization;
+        mRTBVisualization = 0;
+    }
+    else
+    {
+        if(!mRTBMapObjectValidate)
+            mRTBMapObjectValidate = new RTBMapObjectValidate(mMapObject, mMapDocument, mParent);
+        if(!mRTBVisualization)
+            mRTBVisualization = new RTBVisualization(mMapObject, mMapDocument, mParent);
+    }
+}
+
+void RTBMapObjectItem::setEditable(bool editable)
+{
+    if(!mBatched)
+        return;
+
+    // the visualization only paints the selection of editable objects
+    if(editable && !mRTBVisualization)
+    {
+        mRTBVisualization = new RTBVisualization(mMapObject, mMapDocument, mParent);
+    }
+    else if(!editable && mRTBVisualization)
+    {
+        delete mRTBVisualization;
+        mRTBVisualization = 0;
+    }
+}
+
+void RTBMapObjectItem::paintBatched(QPainter *painter, const QPointF &pos)
+{
+    RTBMapObject *rtbObject = mMapObject->rtbMapObject();
+
+    QColor color;
+    if(rtbObject->hasError())
+        color = Qt::red;
+    else if(rtbObject->hasWarning())
+        color = RTBMapObject::warningColor();
+    else
+        return;
+
+    // same as RTBMapObjectValidate, which ignores the zoom level
+    QPen pen(color, 2);
+    pen.setCosmetic(true);
+    painter->setPen(pen);
+    painter->setBrush(Qt::NoBrush);
+    painter->drawRect(borderRect.translated(pos));
+}
+
+QRectF RTBMapObjectItem::batchedRect()
+{
+    return QRectF(-2, -34, 36, 36);
+}
+
 void RTBMapObjectItem::setIsPaintingAllowed(bool isPaintingAllowed)
 {
     if(mIsPaintingAllowed == isPaintingAllowed)
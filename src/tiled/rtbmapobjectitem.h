@@ -36,6 +36,13 @@ public:
     void setIsPaintingAllowed(bool isPaintingAllowed);
     bool isPaintingAllowed() { return mIsPaintingAllowed; }
 
+    // when batched, the validation marker is painted by paintBatched and the
+    // selection visualization only exists while the object is editable
+    void setBatched(bool batched);
+    void setEditable(bool editable);
+    void paintBatched(QPainter *painter, const QPointF &pos);
+    static QRectF batchedRect();
+
 protected:
     MapObject *mMapObject;
     MapDocument *mMapDocument;
@@ -43,6 +50,9 @@ protected:
     bool mIsPaintingAllowed;
 
 private:
+    QGraphicsItem *mParent;
+    bool mBatched;
+
     QGraphicsItem *mRTBMapObjectLabel;
     QGraphicsItem *mVisualizePropHandle;
     QGraphicsItem *mRTBLaserBeamItem;
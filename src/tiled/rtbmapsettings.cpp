@@ -73,9 +73,11 @@ void RTBMapSettings::createLayers(MapDocument *mapDocument)
 
 void RTBMapSettings::addStarterContent(MapDocument *mapDocument)
 {
+    const QString starterContent = QLatin1String("://rtb_resources/StarterContent.json");
+
     // find .json reader
     PluginManager *pm = PluginManager::instance();
-    QList<MapReaderInterface*> readers = pm->interfaces<MapReaderInterface>();
+    QList<MapReaderInterface*> readers = pm->interfacesForFile<MapReaderInterface>(starterContent);
     MapReaderInterface *mapReader = 0;
     foreach (MapReaderInterface *reader, readers) {
         foreach (const QString &str, reader->nameFilters()) {
@@ -87,7 +89,7 @@ void RTBMapSettings::addStarterContent(MapDocument *mapDocument)
     }
 
     // load mapdocument an unify the tilesets
-    MapDocument *importMapDocument = MapDocument::load(QLatin1String("://rtb_resources/StarterContent.json"), mapReader);
+    MapDocument *importMapDocument = MapDocument::load(starterContent, mapReader);
     mapDocument->unifyTilesets(importMapDocument->map());
 
     QUndoStack *undoStack = mapDocument->undoStack();
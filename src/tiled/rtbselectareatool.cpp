@@ -103,7 +103,7 @@ void RTBSelectAreaTool::tilePositionChanged(const QPoint &tilePos)
 
             // Only update the brush item for the last drawn piece
             if (i == points.size() - 1)
-                brushItem()->setTileLayer(mPreviewLayer);
+                mPreview.updateBrushItem(brushItem());
 
             editedRegion |= doPaint(Mergeable | SuppressRegionEdited);
         }
@@ -142,6 +142,9 @@ void RTBSelectAreaTool::setStamp(const TileStamp &stamp)
 
     mStamp = stamp;
 
+    // The layers of the previous stamp may be deleted
+    mPreview.clear();
+
     updatePreview();
 }
 
@@ -263,7 +266,7 @@ void RTBSelectAreaTool::mouseReleased(QGraphicsSceneMouseEvent *event)
         brushItem()->clear();
 
         // select area which was moved
-        setSelectedArea(mPreviewLayer.data()->region());
+        setSelectedArea(mPreview.layer()->region());
         const MapRenderer *renderer = mapDocument()->renderer();
         for(QRectF rect : mapDocument()->selectedArea().rects())
         {
@@ -572,13 +575,13 @@ void RTBSelectAreaTool::updatePreview(QPoint tilePos)
 
     if (mStamp.isEmpty())
     {
-        mPreviewLayer.clear();
+        mPreview.clear();
         tileRegion = QRect(tilePos, QSize(1, 1));
     }
     else
         drawPreviewLayer(QVector<QPoint>() << tilePos);
 
-    brushItem()->setTileLayer(mPreviewLayer);
+    mPreview.updateBrushItem(brushItem());
     if (!tileRegion.isEmpty())
         brushItem()->setTileRegion(tileRegion);
 }
@@ -594,7 +597,7 @@ void RTBSelectAreaTool::beginPaint()
 
 QRegion RTBSelectAreaTool::doPaint(int flags)
 {
-    TileLayer *preview = mPreviewLayer.data();
+    TileLayer *preview = mPreview.layer().data();
     if (!preview)
         return QRegion();
 
@@ -636,22 +639,14 @@ QRegion RTBSelectAreaTool::doPaint(int flags)
     return editedRegion;
 }
 
-struct PaintOperation {
-    QPoint pos;
-    TileLayer *stamp;
-};
-
 void RTBSelectAreaTool::drawPreviewLayer(const QVector<QPoint> &list)
 {
-    mPreviewLayer.clear();
-
-    if (mStamp.isEmpty())
+    if (mStamp.isEmpty()) {
+        mPreview.clear();
         return;
+    }
 
     mMissingTilesets.clear();
-    QRegion paintedRegion;
-    QVector<PaintOperation> operations;
-    QHash<TileLayer *, QRegion> regionCache;
 
     for (const QPoint &p : list)
     {
@@ -660,38 +655,14 @@ void RTBSelectAreaTool::drawPreviewLayer(const QVector<QPoint> &list)
 
         TileLayer *stamp = variation->layerAt(RTBMapSettings::FloorID)->asTileLayer();
 
-        QRegion stampRegion;
-        if (regionCache.contains(stamp)) {
-            stampRegion = regionCache.value(stamp);
-        } else {
-            stampRegion = stamp->region();
-            regionCache.insert(stamp, stampRegion);
-        }
-
         // stamp position in relation to the mouse, like the objects
         QPoint startPos(p.x() - (mDragDelta.x()),
                         (p.y() - mDragDelta.y()));
 
-        const QRegion region = stampRegion.translated(startPos.x(),
-                                                      startPos.y());
-
-        if (!paintedRegion.intersects(region)) {
-            paintedRegion += region;
-
-            PaintOperation op = { startPos, stamp };
-            operations.append(op);
-        }
-
-        QRect bounds = paintedRegion.boundingRect();
-        SharedTileLayer preview(new TileLayer(QString(),
-                                              bounds.x(), bounds.y(),
-                                              bounds.width(), bounds.height()));
-
-        for (const PaintOperation &op : operations)
-            preview->merge(op.pos - bounds.topLeft(), op.stamp);
-
-        mPreviewLayer = preview;
+        mPreview.addStamp(startPos, stamp);
     }
+
+    mPreview.build();
 }
 
 void RTBSelectAreaTool::removeSelectedAreaItems()
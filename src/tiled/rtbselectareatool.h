@@ -21,6 +21,7 @@
 #ifndef RTBSELECTAREATOOL_H
 #define RTBSELECTAREATOOL_H
 
+#include "stamppreview.h"
 #include "tileselectiontool.h"
 #include "tilestamp.h"
 
@@ -134,7 +135,7 @@ private:
 
     BrushBehavior mBrushBehavior;
     TileStamp mStamp;
-    SharedTileLayer mPreviewLayer;
+    StampPreview mPreview;
     QVector<SharedTileset> mMissingTilesets;
     QPoint mPrevTilePosition;
 
@@ -22,6 +22,7 @@
 
 #include "map.h"
 #include "objectgroup.h"
+#include "tracing.h"
 
 #include "rtbmapsettings.h"
 #include "rtbvalidatordock.h"
@@ -106,6 +107,8 @@ void RTBValidator::createRules()
 
 bool RTBValidator::validate()
 {
+    TILED_TRACE("RTBValidator::validate");
+
     if(!mMapDocument || !mValidatorModel)
     {
         return false;
@@ -23,36 +23,46 @@
 #include "brushitem.h"
 #include "mapdocument.h"
 #include "changeselectedarea.h"
+#include "map.h"
 
 #include <QApplication>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
 
-/**
- * Determines whether a cell matches specified one.
- */
-class MatchesSpecifiedCell
-{
-public:
-    MatchesSpecifiedCell(const Cell &cell) : mCell(cell) {}
-
-    bool operator() (const Cell &cell) const
-    {
-        return cell == mCell;
-    }
-
-private:
-    Cell mCell;
-};
-
 SelectSameTileTool::SelectSameTileTool(QObject *parent)
     : AbstractTileTool(tr("Select Same Tile"),
                        QIcon(QLatin1String(
                                ":images/22x22/stock-tool-select-same-tiles.png")),
                        QKeySequence(tr("S")),
                        parent)
+    , mIndexedLayer(0)
+{
+}
+
+void SelectSameTileTool::deactivate(MapScene *scene)
 {
+    // Don't keep paying for the index maintenance when the tool is not used
+    setIndexedLayer(0);
+    AbstractTileTool::deactivate(scene);
+}
+
+void SelectSameTileTool::mapDocumentChanged(MapDocument *oldDocument,
+                                            MapDocument *newDocument)
+{
+    setIndexedLayer(0);
+
+    if (oldDocument) {
+        disconnect(oldDocument, SIGNAL(layerAboutToBeRemoved(int)),
+                   this, SLOT(layerAboutToBeRemoved(int)));
+    }
+
+    if (newDocument) {
+        connect(newDocument, SIGNAL(layerAboutToBeRemoved(int)),
+                SLOT(layerAboutToBeRemoved(int)));
+    }
+
+    AbstractTileTool::mapDocumentChanged(oldDocument, newDocument);
 }
 
 void SelectSameTileTool::tilePositionChanged(const QPoint &tilePos)
@@ -64,9 +74,9 @@ void SelectSameTileTool::tilePositionChanged(const QPoint &tilePos)
 
     QRegion resultRegion;
     if (tileLayer->contains(tilePos)) {
-        const Cell matchCell = tileLayer->cellAt(tilePos);
-        MatchesSpecifiedCell condition(matchCell);
-        resultRegion = tileLayer->region(condition);
+        // The occurrence index avoids checking the whole layer on each hover
+        setIndexedLayer(tileLayer);
+        resultRegion = tileLayer->cellRegion(tileLayer->cellAt(tilePos));
     }
     mSelectedRegion = resultRegion;
     brushItem()->setTileRegion(mSelectedRegion);
@@ -102,6 +112,26 @@ void SelectSameTileTool::mouseReleased(QGraphicsSceneMouseEvent *)
 {
 }
 
+void SelectSameTileTool::layerAboutToBeRemoved(int index)
+{
+    if (mapDocument()->map()->layerAt(index) == mIndexedLayer)
+        setIndexedLayer(0);
+}
+
+void SelectSameTileTool::setIndexedLayer(TileLayer *layer)
+{
+    if (mIndexedLayer == layer)
+        return;
+
+    if (mIndexedLayer)
+        mIndexedLayer->setTileIndexEnabled(false);
+
+    mIndexedLayer = layer;
+
+    if (mIndexedLayer)
+        mIndexedLayer->setTileIndexEnabled(true);
+}
+
 void SelectSameTileTool::languageChanged()
 {
     setName(tr("Select Same Tile"));
@@ -42,17 +42,31 @@ class SelectSameTileTool : public AbstractTileTool
 public:
     SelectSameTileTool(QObject *parent = 0);
 
+    void deactivate(MapScene *scene);
+
     void mousePressed(QGraphicsSceneMouseEvent *event);
     void mouseReleased(QGraphicsSceneMouseEvent *event);
 
     void languageChanged();
 
 protected:
+    void mapDocumentChanged(MapDocument *oldDocument,
+                            MapDocument *newDocument);
+
     void tilePositionChanged(const QPoint &tilePos);
 
+private slots:
+    void layerAboutToBeRemoved(int index);
+
 private:
+    /**
+     * Enables the tile index of \a layer while it is hovered, releasing the
+     * index of the previously hovered layer.
+     */
+    void setIndexedLayer(TileLayer *layer);
 
     QRegion mSelectedRegion;
+    TileLayer *mIndexedLayer;
 };
 
 } // namespace Internal
@@ -65,7 +65,7 @@ void StampBrush::tilePositionChanged(const QPoint &pos)
 
             // Only update the brush item for the last drawn piece
             if (i == points.size() - 1)
-                brushItem()->setTileLayer(mPreviewLayer);
+                mPreview.updateBrushItem(brushItem());
 
             editedRegion |= doPaint(Mergeable | SuppressRegionEdited);
         }
@@ -208,6 +208,9 @@ void StampBrush::setStamp(const TileStamp &stamp)
 
     mStamp = stamp;
 
+    // The layers of the previous stamp may be deleted
+    mPreview.clear();
+
     if (mIsRandom)
         updateRandomList();
 
@@ -294,7 +297,7 @@ QRect StampBrush::capturedArea() const
  */
 QRegion StampBrush::doPaint(int flags)
 {
-    TileLayer *preview = mPreviewLayer.data();
+    TileLayer *preview = mPreview.layer().data();
     if (!preview)
         return QRegion();
 
@@ -330,11 +333,6 @@ QRegion StampBrush::doPaint(int flags)
     return editedRegion;
 }
 
-struct PaintOperation {
-    QPoint pos;
-    TileLayer *stamp;
-};
-
 /**
  * Draws the preview layer.
  * It tries to put at all given points a stamp of the current stamp at the
@@ -345,77 +343,39 @@ struct PaintOperation {
  */
 void StampBrush::drawPreviewLayer(const QVector<QPoint> &list)
 {
-    mPreviewLayer.clear();
-
-    if (mStamp.isEmpty())
+    if (mStamp.isEmpty()) {
+        mPreview.clear();
         return;
+    }
 
     if (mIsRandom) {
-        if (mRandomList.empty())
+        if (mRandomList.empty()) {
+            mPreview.clear();
             return;
-
-        QRegion paintedRegion;
-        foreach (const QPoint p, list)
-            paintedRegion += QRect(p, QSize(1, 1));
-
-        QRect bounds = paintedRegion.boundingRect();
-        SharedTileLayer preview(new TileLayer(QString(),
-                                              bounds.x(), bounds.y(),
-                                              bounds.width(), bounds.height()));
+        }
 
         for (const QPoint &p : list) {
             // todo: take into account tile probability
             const Cell &cell = mRandomList.at(rand() % mRandomList.size());
-            preview->setCell(p.x() - bounds.left(),
-                             p.y() - bounds.top(),
-                             cell);
+            mPreview.addCell(p, cell);
         }
-
-        mPreviewLayer = preview;
     } else {
         mMissingTilesets.clear();
 
-        QRegion paintedRegion;
-        QVector<PaintOperation> operations;
-        QHash<TileLayer *, QRegion> regionCache;
-
         for (const QPoint &p : list) {
             Map *variation = mStamp.randomVariation();
             mapDocument()->unifyTilesets(variation, mMissingTilesets);
 
             TileLayer *stamp = static_cast<TileLayer*>(variation->layerAt(0));
 
-            QRegion stampRegion;
-            if (regionCache.contains(stamp)) {
-                stampRegion = regionCache.value(stamp);
-            } else {
-                stampRegion = stamp->region();
-                regionCache.insert(stamp, stampRegion);
-            }
-
             QPoint centered(p.x() - stamp->width() / 2,
                             p.y() - stamp->height() / 2);
 
-            const QRegion region = stampRegion.translated(centered.x(),
-                                                          centered.y());
-            if (!paintedRegion.intersects(region)) {
-                paintedRegion += region;
-
-                PaintOperation op = { centered, stamp };
-                operations.append(op);
-            }
+            mPreview.addStamp(centered, stamp);
         }
-
-        QRect bounds = paintedRegion.boundingRect();
-        SharedTileLayer preview(new TileLayer(QString(),
-                                              bounds.x(), bounds.y(),
-                                              bounds.width(), bounds.height()));
-
-        for (const PaintOperation &op : operations)
-            preview->merge(op.pos - bounds.topLeft(), op.stamp);
-
-        mPreviewLayer = preview;
     }
+
+    mPreview.build();
 }
 
 /**
@@ -431,10 +391,10 @@ void StampBrush::updatePreview(QPoint tilePos)
     QRegion tileRegion;
 
     if (mBrushBehavior == Capture) {
-        mPreviewLayer.clear();
+        mPreview.clear();
         tileRegion = capturedArea();
     } else if (mStamp.isEmpty()) {
-        mPreviewLayer.clear();
+        mPreview.clear();
         tileRegion = QRect(tilePos, QSize(1, 1));
     } else {
         switch (mBrushBehavior) {
@@ -450,7 +410,7 @@ void StampBrush::updatePreview(QPoint tilePos)
         case Circle:
             // while finding the mid point, there is no need to show
             // the (maybe bigger than 1x1) stamp
-            mPreviewLayer.clear();
+            mPreview.clear();
             tileRegion = QRect(tilePos, QSize(1, 1));
             break;
         case Line:
@@ -461,7 +421,7 @@ void StampBrush::updatePreview(QPoint tilePos)
         }
     }
 
-    brushItem()->setTileLayer(mPreviewLayer);
+    mPreview.updateBrushItem(brushItem());
     if (!tileRegion.isEmpty())
         brushItem()->setTileRegion(tileRegion);
 }
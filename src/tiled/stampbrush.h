@@ -23,6 +23,7 @@
 #define STAMPBRUSH_H
 
 #include "abstracttiletool.h"
+#include "stamppreview.h"
 #include "tilelayer.h"
 #include "tilestamp.h"
 
@@ -99,7 +100,7 @@ private:
     void updatePreview(QPoint tilePos);
 
     TileStamp mStamp;
-    SharedTileLayer mPreviewLayer;
+    StampPreview mPreview;
     QVector<SharedTileset> mMissingTilesets;
 
     QPoint mCaptureStart;
@@ -0,0 +1,196 @@
+/*
+ * stamppreview.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "stamppreview.h"
+
+#include "brushitem.h"
+
+using namespace Tiled;
+using namespace Tiled::Internal;
+
+/**
+ * Returns whether any of the tiles of \a stamp, placed at \a pos, would end
+ * up on a cell of \a layer that already has a tile.
+ */
+static bool overlaps(const TileLayer *layer, const QPoint &pos,
+                     const TileLayer *stamp)
+{
+    for (int y = 0; y < stamp->height(); ++y) {
+        for (int x = 0; x < stamp->width(); ++x) {
+            if (stamp->cellAt(x, y).isEmpty())
+                continue;
+
+            const int layerX = pos.x() + x;
+            const int layerY = pos.y() + y;
+
+            if (layer->contains(layerX, layerY) &&
+                    !layer->cellAt(layerX, layerY).isEmpty())
+                return true;
+        }
+    }
+
+    return false;
+}
+
+StampPreview::StampPreview()
+{
+}
+
+void StampPreview::clear()
+{
+    mOperations.clear();
+    mApplied.clear();
+    mStampBounds.clear();
+    mBounds = QRect();
+    mLayer.clear();
+    mChangedRegion = QRegion();
+}
+
+void StampPreview::addStamp(const QPoint &pos, TileLayer *stamp)
+{
+    QHash<TileLayer*, QRect>::iterator it = mStampBounds.find(stamp);
+    if (it == mStampBounds.end())
+        it = mStampBounds.insert(stamp, stamp->region().boundingRect());
+
+    mBounds |= it.value().translated(pos);
+
+    Operation operation = { pos, stamp, Cell() };
+    mOperations.append(operation);
+}
+
+void StampPreview::addCell(const QPoint &pos, const Cell &cell)
+{
+    mBounds |= QRect(pos, QSize(1, 1));
+
+    Operation operation = { pos, 0, cell };
+    mOperations.append(operation);
+}
+
+void StampPreview::build()
+{
+    // Count the operations of the last update that are still queued
+    int applied = 0;
+    if (mLayer) {
+        const int count = qMin(mApplied.size(), mOperations.size());
+        while (applied < count && mApplied.at(applied) == mOperations.at(applied))
+            ++applied;
+    }
+
+    if (mLayer && applied == mApplied.size())
+        appendOperations(applied);
+    else
+        replayOperations();
+
+    mApplied.swap(mOperations);
+    mOperations.clear();
+    mStampBounds.clear();
+    mBounds = QRect();
+}
+
+/**
+ * Applies the queued operations starting at \a first directly to the preview
+ * layer, growing it in place when they extend beyond its bounds.
+ */
+void StampPreview::appendOperations(int first)
+{
+    const QRect oldBounds = mLayer->bounds();
+    const QRect bounds = oldBounds | mBounds;
+
+    if (bounds != oldBounds) {
+        mLayer->resize(bounds.size(), oldBounds.topLeft() - bounds.topLeft());
+        mLayer->setPosition(bounds.topLeft());
+    }
+
+    for (int i = first; i < mOperations.size(); ++i)
+        mChangedRegion += apply(mLayer.data(), mOperations.at(i));
+}
+
+/**
+ * Composes all queued operations in the buffer and copies the cells that
+ * differ over to the preview layer.
+ */
+void StampPreview::replayOperations()
+{
+    // Keep the bounds of the preview layer while they cover all operations,
+    // so that a shrinking preview does not cause reallocations
+    QRect bounds = mBounds;
+    if (mLayer && mLayer->bounds().contains(mBounds))
+        bounds = mLayer->bounds();
+
+    const QSize size = bounds.size();
+
+    if (!mBuffer || mBuffer->size() != size)
+        mBuffer.reset(new TileLayer(QString(), 0, 0, size.width(), size.height()));
+    else
+        mBuffer->erase(QRegion(0, 0, size.width(), size.height()));
+
+    mBuffer->setPosition(bounds.topLeft());
+
+    foreach (const Operation &operation, mOperations)
+        apply(mBuffer.data(), operation);
+
+    if (!mLayer) {
+        mLayer = SharedTileLayer(static_cast<TileLayer*>(mBuffer->clone()));
+        mChangedRegion = QRegion();
+        return;
+    }
+
+    if (mLayer->bounds() != bounds) {
+        // The tiles need to be repainted at their old location as well
+        mChangedRegion += mLayer->region();
+        mLayer->resize(size, QPoint());
+        mLayer->setPosition(bounds.topLeft());
+    }
+
+    // Only copy over the cells that actually changed
+    const QRegion changed = mLayer->computeDiffRegion(mBuffer.data());
+    mLayer->setCells(0, 0, mBuffer.data(), changed);
+    mChangedRegion += changed.translated(mLayer->position());
+}
+
+/**
+ * Applies \a operation to \a layer. Returns the area that was painted, in map
+ * coordinates.
+ */
+QRect StampPreview::apply(TileLayer *layer, const Operation &operation) const
+{
+    const QPoint pos = operation.pos - layer->position();
+
+    if (operation.stamp) {
+        if (overlaps(layer, pos, operation.stamp))
+            return QRect();
+
+        layer->merge(pos, operation.stamp);
+        return mStampBounds.value(operation.stamp).translated(operation.pos);
+    }
+
+    layer->setCell(pos.x(), pos.y(), operation.cell);
+    return QRect(operation.pos, QSize(1, 1));
+}
+
+void StampPreview::updateBrushItem(BrushItem *brushItem)
+{
+    if (mLayer && brushItem->tileLayer() == mLayer)
+        brushItem->tileLayerChanged(mChangedRegion);
+    else
+        brushItem->setTileLayer(mLayer);
+
+    mChangedRegion = QRegion();
+}
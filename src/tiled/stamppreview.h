@@ -0,0 +1,117 @@
+/*
+ * stamppreview.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STAMPPREVIEW_H
+#define STAMPPREVIEW_H
+
+#include "tilelayer.h"
+
+#include <QHash>
+#include <QRegion>
+#include <QScopedPointer>
+#include <QVector>
+
+namespace Tiled {
+namespace Internal {
+
+class BrushItem;
+
+/**
+ * Builds the preview layer shown while painting stamps or single cells at a
+ * number of positions, like when drawing lines, circles or random fills.
+ *
+ * The preview layer is kept between updates and remembers the operations
+ * that were applied to it. When the queued operations only add to those, as
+ * when a line is extended, the layer is grown in place and only the new
+ * operations are applied. Otherwise the preview is composed again in a
+ * buffer and only the cells that differ are copied over. In both cases the
+ * changed cells are remembered, so that the brush item only needs to repaint
+ * those.
+ */
+class StampPreview
+{
+public:
+    StampPreview();
+
+    /**
+     * Returns the current preview layer, which may be null.
+     */
+    const SharedTileLayer &layer() const { return mLayer; }
+
+    /**
+     * Clears the preview layer.
+     */
+    void clear();
+
+    /**
+     * Queues the \a stamp to be placed at \a pos, in map coordinates. The
+     * stamp is left out when it would overlap with a stamp queued before.
+     */
+    void addStamp(const QPoint &pos, TileLayer *stamp);
+
+    /**
+     * Queues a single \a cell to be placed at \a pos, in map coordinates.
+     */
+    void addCell(const QPoint &pos, const Cell &cell);
+
+    /**
+     * Updates the preview layer to show the queued stamps and cells.
+     */
+    void build();
+
+    /**
+     * Sets the preview layer on the \a brushItem. When the brush item is
+     * already showing the preview layer, it is only told about the cells
+     * that changed since the last update.
+     */
+    void updateBrushItem(BrushItem *brushItem);
+
+private:
+    struct Operation {
+        QPoint pos;
+        TileLayer *stamp;
+        Cell cell;
+
+        bool operator==(const Operation &other) const
+        {
+            return pos == other.pos &&
+                    stamp == other.stamp &&
+                    cell == other.cell;
+        }
+    };
+
+    void appendOperations(int first);
+    void replayOperations();
+    QRect apply(TileLayer *layer, const Operation &operation) const;
+
+    QVector<Operation> mOperations;
+    QVector<Operation> mApplied;
+    QHash<TileLayer*, QRect> mStampBounds;
+    QRect mBounds;
+
+    SharedTileLayer mLayer;
+    QScopedPointer<TileLayer> mBuffer;
+    QRegion mChangedRegion;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+#endif // STAMPPREVIEW_H
@@ -35,7 +35,7 @@
 
 #include <math.h>
 #include <QVector>
-#include <climits>
+#include <algorithm>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
@@ -262,57 +262,19 @@ static Tile *findBestTile(const Tileset &tileset, unsigned terrain, unsigned con
     if (terrain == 0xFFFFFFFF)
         return NULL;
 
-    QList<Tile*> matches;
-    int penalty = INT_MAX;
-
-    // TODO: this is a slow linear search, perhaps we could use a better find algorithm...
-    foreach (Tile *t, tileset.tiles()) {
-        if ((t->terrain() & considerationMask) != (terrain & considerationMask))
-            continue;
-
-        // calculate the tile transition penalty based on shortest distance to target terrain type
-        int tr = tileset.terrainTransitionPenalty(t->terrain() >> 24, terrain >> 24);
-        int tl = tileset.terrainTransitionPenalty((t->terrain() >> 16) & 0xFF, (terrain >> 16) & 0xFF);
-        int br = tileset.terrainTransitionPenalty((t->terrain() >> 8) & 0xFF, (terrain >> 8) & 0xFF);
-        int bl = tileset.terrainTransitionPenalty(t->terrain() & 0xFF, terrain & 0xFF);
-
-        // if there is no path to the destination terrain, this isn't a useful transition
-        if (tr < 0 || tl < 0 || br < 0 || bl < 0)
-            continue;
-
-        // add tile to the candidate list
-        int transitionPenalty = tr + tl + br + bl;
-        if (transitionPenalty <= penalty) {
-            if (transitionPenalty < penalty)
-                matches.clear();
-            penalty = transitionPenalty;
-
-            matches.push_back(t);
-        }
-    }
+    const TerrainCandidates &candidates = tileset.terrainCandidates(terrain, considerationMask);
 
     // choose a candidate at random, with consideration for terrain probability
-    if (!matches.isEmpty()) {
-        // determine the range of probability
-        float sum = 0.f;
-        for (int i = 0; i < matches.size(); ++i) {
-            float probability = matches.at(i)->terrainProbability();
-            if (probability > 0.f)
-                sum += probability;
-        }
-
-        float random = ((float)rand() / RAND_MAX) * sum;
+    if (!candidates.tiles.isEmpty()) {
+        const QVector<float> &cumulative = candidates.cumulativeProbabilities;
+        float random = ((float)rand() / RAND_MAX) * cumulative.last();
 
         // determine which match was hit
-        sum = 0.f;
-        for (int i = 0; i < matches.size(); ++i) {
-            float probability = matches.at(i)->terrainProbability();
-            if (probability > 0.f) {
-                sum += probability;
-                if (random <= sum)
-                    return matches[i];
-            }
-        }
+        QVector<float>::const_iterator hit = std::lower_bound(cumulative.begin(),
+                                                              cumulative.end(),
+                                                              random);
+        if (hit != cumulative.end())
+            return candidates.tiles.at(hit - cumulative.begin());
     }
 
     // TODO: conveniently, the NULL tile doesn't currently work, but when it does, we need to signal a failure to find any matches some other way
@@ -76,6 +76,7 @@ SOURCES += aboutdialog.cpp \
     commanddatamodel.cpp \
     commanddialog.cpp \
     commandlineparser.cpp \
+    compressedtilelayer.cpp \
     consoledock.cpp \
     createellipseobjecttool.cpp \
     createmultipointobjecttool.cpp \
@@ -146,6 +147,7 @@ SOURCES += aboutdialog.cpp \
     selectsametiletool.cpp \
     snaphelper.cpp \
     stampbrush.cpp \
+    stamppreview.cpp \
     terrainbrush.cpp \
     terraindock.cpp \
     terrainmodel.cpp \
@@ -231,6 +233,7 @@ HEADERS += aboutdialog.h \
     commanddialog.h \
     command.h \
     commandlineparser.h \
+    compressedtilelayer.h \
     consoledock.h \
     createellipseobjecttool.h \
     createmultipointobjecttool.h \
@@ -302,6 +305,7 @@ HEADERS += aboutdialog.h \
     selectsametiletool.h \
     snaphelper.h \
     stampbrush.h \
+    stamppreview.h \
     terrainbrush.h \
     terraindock.h \
     terrainmodel.h \
@@ -45,6 +45,11 @@ public:
      */
     TileLayerItem(TileLayer *layer, MapDocument *mapDocument);
 
+    /**
+     * Returns the tile layer displayed by this item.
+     */
+    TileLayer *tileLayer() const { return mLayer; }
+
     /**
      * Updates the size and position of this item. Should be called when the
      * size of either the tile layer or its associated map have changed.
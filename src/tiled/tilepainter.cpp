@@ -184,14 +184,71 @@ void TilePainter::erase(const QRegion &region)
     mMapDocument->emitRegionChanged(paintable);
 }
 
-static QRegion fillRegion(const TileLayer *layer, QPoint fillOrigin)
+/**
+ * Converts the rows of the given cell mask to a region. Each row is made up
+ * of horizontal spans of height 1, which are already y-x sorted and never
+ * abut, so the region can be set up in one go instead of uniting the spans
+ * one by one.
+ */
+static QRegion maskToRegion(const quint8 *mask, int maskWidth,
+                            const QRect &bounds)
 {
-    // Create that region that will hold the fill
-    QRegion fillRegion;
+    QVector<QRect> rects;
+
+    for (int y = bounds.top(); y <= bounds.bottom(); ++y) {
+        const quint8 *row = mask + y * maskWidth;
+        int x = bounds.left();
+
+        while (x <= bounds.right()) {
+            if (!row[x]) {
+                ++x;
+                continue;
+            }
+
+            const int start = x;
+            while (x <= bounds.right() && row[x])
+                ++x;
+
+            rects.append(QRect(start, y, x - start, 1));
+        }
+    }
 
+    QRegion region;
+    if (!rects.isEmpty())
+        region.setRects(rects.constData(), rects.size());
+    return region;
+}
+
+/**
+ * Queues the start of each run of unfilled cells matching \a matchCell
+ * between \a left and \a right on line \a y.
+ */
+static void queueSpans(const TileLayer *layer, const Cell &matchCell,
+                       const quint8 *filledCells, int left, int right, int y,
+                       QVector<QPoint> &fillPositions)
+{
+    const quint8 *filledLine = filledCells + y * layer->width();
+    bool lastCellQueued = false;
+
+    for (int x = left; x <= right; ++x) {
+        if (!filledLine[x] && layer->cellAt(x, y) == matchCell) {
+            // Do not add the cell to the queue if its x-adjacent cell was
+            // added, since it will be part of the same span.
+            if (!lastCellQueued)
+                fillPositions.append(QPoint(x, y));
+
+            lastCellQueued = true;
+        } else {
+            lastCellQueued = false;
+        }
+    }
+}
+
+static QRegion fillRegion(const TileLayer *layer, QPoint fillOrigin)
+{
     // Silently quit if parameters are unsatisfactory
     if (!layer->contains(fillOrigin))
-        return fillRegion;
+        return QRegion();
 
     // Cache cell that we will match other cells against
     const Cell matchCell = layer->cellAt(fillOrigin);
@@ -201,91 +258,57 @@ static QRegion fillRegion(const TileLayer *layer, QPoint fillOrigin)
     const int layerHeight = layer->height();
     const int layerSize = layerWidth * layerHeight;
 
-    // Create a queue to hold cells that need filling
-    QList<QPoint> fillPositions;
+    // Create a stack to hold the seeds of spans that need filling. The order
+    // in which the spans are processed does not matter.
+    QVector<QPoint> fillPositions;
     fillPositions.append(fillOrigin);
 
-    // Create an array that will store which cells have been processed
-    // This is faster than checking if a given cell is in the region/list
-    QVector<quint8> processedCellsVec(layerSize);
-    quint8 *processedCells = processedCellsVec.data();
+    // Create an array that stores which cells are part of the fill. The
+    // region is only built from it at the end, since uniting the spans one
+    // by one gets very slow for large fills.
+    QVector<quint8> filledCellsVec(layerSize);
+    quint8 *filledCells = filledCellsVec.data();
+
+    // Keep track of the area touched by the fill, to limit the conversion
+    QRect fillBounds;
 
-    // Loop through queued positions and fill them, while at the same time
-    // checking adjacent positions to see if they should be added
-    while (!fillPositions.empty()) {
-        const QPoint currentPoint = fillPositions.takeFirst();
-        const int startOfLine = currentPoint.y() * layerWidth;
+    // Loop through queued positions and fill the span they are part of,
+    // while at the same time checking adjacent lines for spans to fill
+    while (!fillPositions.isEmpty()) {
+        const QPoint currentPoint = fillPositions.last();
+        fillPositions.removeLast();
+
+        const int y = currentPoint.y();
+        quint8 *filledLine = filledCells + y * layerWidth;
+
+        // The span may have been filled since this point was queued
+        if (filledLine[currentPoint.x()])
+            continue;
 
         // Seek as far left as we can
         int left = currentPoint.x();
-        while (left > 0 && layer->cellAt(left - 1, currentPoint.y()) == matchCell)
+        while (left > 0 && layer->cellAt(left - 1, y) == matchCell)
             --left;
 
         // Seek as far right as we can
         int right = currentPoint.x();
-        while (right + 1 < layerWidth && layer->cellAt(right + 1, currentPoint.y()) == matchCell)
+        while (right + 1 < layerWidth && layer->cellAt(right + 1, y) == matchCell)
             ++right;
 
-        // Add cells between left and right to the region
-        fillRegion += QRegion(left, currentPoint.y(), right - left + 1, 1);
-
-        // Add cell strip to processed cells
-        memset(&processedCells[startOfLine + left],
-               1,
-               right - left);
-
-        // These variables cache whether the last cell was added to the queue
-        // or not as an optimization, since adjacent cells on the x axis
-        // do not need to be added to the queue.
-        bool lastAboveCell = false;
-        bool lastBelowCell = false;
-
-        // Loop between left and right and check if cells above or
-        // below need to be added to the queue
-        for (int x = left; x <= right; ++x) {
-            const QPoint fillPoint(x, currentPoint.y());
-
-            // Check cell above
-            if (fillPoint.y() > 0) {
-                QPoint aboveCell(fillPoint.x(), fillPoint.y() - 1);
-                if (!processedCells[aboveCell.y() * layerWidth + aboveCell.x()] &&
-                    layer->cellAt(aboveCell) == matchCell)
-                {
-                    // Do not add the above cell to the queue if its
-                    // x-adjacent cell was added.
-                    if (!lastAboveCell)
-                        fillPositions.append(aboveCell);
-
-                    lastAboveCell = true;
-                } else {
-                    lastAboveCell = false;
-                }
-
-                processedCells[aboveCell.y() * layerWidth + aboveCell.x()] = 1;
-            }
-
-            // Check cell below
-            if (fillPoint.y() + 1 < layerHeight) {
-                QPoint belowCell(fillPoint.x(), fillPoint.y() + 1);
-                if (!processedCells[belowCell.y() * layerWidth + belowCell.x()] &&
-                    layer->cellAt(belowCell) == matchCell)
-                {
-                    // Do not add the below cell to the queue if its
-                    // x-adjacent cell was added.
-                    if (!lastBelowCell)
-                        fillPositions.append(belowCell);
-
-                    lastBelowCell = true;
-                } else {
-                    lastBelowCell = false;
-                }
-
-                processedCells[belowCell.y() * layerWidth + belowCell.x()] = 1;
-            }
-        }
+        // Mark the cells between left and right as filled
+        memset(filledLine + left, 1, right - left + 1);
+        fillBounds |= QRect(left, y, right - left + 1, 1);
+
+        // Check whether cells above or below need to be added to the queue
+        if (y > 0)
+            queueSpans(layer, matchCell, filledCells, left, right, y - 1,
+                       fillPositions);
+        if (y + 1 < layerHeight)
+            queueSpans(layer, matchCell, filledCells, left, right, y + 1,
+                       fillPositions);
     }
 
-    return fillRegion;
+    return maskToRegion(filledCells, layerWidth, fillBounds);
 }
 
 QRegion TilePainter::computePaintableFillRegion(const QPoint &fillOrigin) const
@@ -324,6 +324,8 @@ TilesetDock::TilesetDock(QWidget *parent):
 
     connect(TilesetManager::instance(), SIGNAL(tilesetChanged(Tileset*)),
             this, SLOT(tilesetChanged(Tileset*)));
+    connect(TilesetManager::instance(), SIGNAL(tileImagesChanged(Tileset*,QList<Tile*>)),
+            this, SLOT(tileImagesChanged(Tileset*)));
 
     connect(DocumentManager::instance(), SIGNAL(documentAboutToClose(MapDocument*)),
             SLOT(documentAboutToClose(MapDocument*)));
@@ -579,6 +581,16 @@ void TilesetDock::tilesetChanged(Tileset *tileset)
         model->tilesetChanged();
 }
 
+void TilesetDock::tileImagesChanged(Tileset *tileset)
+{
+    // The tile sizes are unchanged, so a repaint of the view is enough
+    const int index = indexOf(mTilesets, tileset);
+    if (index < 0)
+        return;
+
+    tilesetViewAt(index)->viewport()->update();
+}
+
 void TilesetDock::tilesetRemoved(Tileset *tileset)
 {
     // Delete the related tileset view
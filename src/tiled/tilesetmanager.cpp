@@ -24,18 +24,182 @@
 #include "filesystemwatcher.h"
 #include "tileanimationdriver.h"
 #include "tile.h"
+#include "tracing.h"
 
+#include <QBitmap>
+#include <QCryptographicHash>
+#include <QFile>
 #include <QImage>
+#include <QRunnable>
 
 using namespace Tiled;
 using namespace Tiled::Internal;
 
+namespace Tiled {
+namespace Internal {
+
+/**
+ * The state of a tileset image scan that is running on a worker thread.
+ */
+class TilesetImageScan
+{
+public:
+    int id;
+    bool reload;
+
+    // Weak, so that the tileset is never released on the worker thread. It is
+    // resolved again on the GUI thread once the scan has finished.
+    QWeakPointer<Tileset> tileset;
+
+    // Copied from the tileset, since it may change while scanning
+    QString fileName;
+    QSize tileSize;
+    int margin;
+    int spacing;
+    QColor transparentColor;
+    QSize imageSize;
+    QByteArray previousFileHash;
+    QVector<uint> previousTileHashes;
+
+    // Written by the worker thread
+    bool success;
+    bool unchanged;
+    QByteArray fileHash;
+    QVector<uint> tileHashes;
+    QImage image;               // Set when the whole tileset needs reloading
+    QVector<int> changedTiles;
+    QVector<QImage> changedTileImages;
+    QVector<QImage> changedTileMasks;
+};
+
+} // namespace Internal
+} // namespace Tiled
+
+namespace {
+
+/**
+ * Hashes the pixels of the given \a image, ignoring the padding at the end of
+ * its scan lines.
+ */
+uint hashImage(const QImage &image)
+{
+    const int bytesPerLine = (image.width() * image.depth() + 7) / 8;
+    uint hash = 0;
+
+    for (int y = 0; y < image.height(); ++y) {
+        const char *line = reinterpret_cast<const char*>(image.constScanLine(y));
+        hash = qHash(QByteArray::fromRawData(line, bytesPerLine), hash);
+    }
+
+    foreach (QRgb color, image.colorTable())
+        hash = qHash(color, hash);
+
+    return hash;
+}
+
+/**
+ * Reads, hashes and decodes a tileset image on a worker thread.
+ */
+class ScanJob : public QRunnable
+{
+public:
+    ScanJob(TilesetManager *manager,
+            const QSharedPointer<TilesetImageScan> &scan)
+        : mManager(manager)
+        , mScan(scan)
+    {}
+
+    void run() override
+    {
+        scan(*mScan);
+
+        // The manager waits for pending scans before it is deleted
+        QMetaObject::invokeMethod(mManager, "imageScanFinished",
+                                  Qt::QueuedConnection,
+                                  Q_ARG(int, mScan->id));
+    }
+
+private:
+    static void scan(TilesetImageScan &scan);
+
+    TilesetManager *mManager;
+    QSharedPointer<TilesetImageScan> mScan;
+};
+
+void ScanJob::scan(TilesetImageScan &scan)
+{
+    TILED_TRACE("ScanJob::scan");
+
+    scan.success = false;
+    scan.unchanged = false;
+
+    QFile file(scan.fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    const QByteArray data = file.readAll();
+    file.close();
+
+    scan.fileHash = QCryptographicHash::hash(data, QCryptographicHash::Md5);
+    if (scan.fileHash == scan.previousFileHash) {
+        scan.success = true;
+        scan.unchanged = true;
+        return;
+    }
+
+    const QImage image = QImage::fromData(data);
+    if (image.isNull())
+        return;
+
+    // Hash the tiles in the same order as Tileset::loadFromImage slices them
+    const QSize tileSize = scan.tileSize;
+    const int stopWidth = image.width() - tileSize.width();
+    const int stopHeight = image.height() - tileSize.height();
+
+    QVector<QImage> tileImages;
+
+    for (int y = scan.margin; y <= stopHeight; y += tileSize.height() + scan.spacing) {
+        for (int x = scan.margin; x <= stopWidth; x += tileSize.width() + scan.spacing) {
+            const QImage tileImage = image.copy(x, y, tileSize.width(), tileSize.height());
+            scan.tileHashes.append(hashImage(tileImage));
+            tileImages.append(tileImage);
+        }
+    }
+
+    scan.success = true;
+
+    if (!scan.reload)
+        return;
+
+    // Only individual tiles can be updated when the layout is the same
+    if (image.size() != scan.imageSize ||
+            scan.tileHashes.size() != scan.previousTileHashes.size()) {
+        scan.image = image;
+        return;
+    }
+
+    for (int i = 0; i < scan.tileHashes.size(); ++i) {
+        if (scan.tileHashes.at(i) == scan.previousTileHashes.at(i))
+            continue;
+
+        const QImage &tileImage = tileImages.at(i);
+        scan.changedTiles.append(i);
+        scan.changedTileImages.append(tileImage);
+
+        if (scan.transparentColor.isValid())
+            scan.changedTileMasks.append(tileImage.createMaskFromColor(scan.transparentColor.rgb()));
+    }
+}
+
+} // anonymous namespace
+
 TilesetManager *TilesetManager::mInstance = 0;
 
 TilesetManager::TilesetManager():
     mWatcher(new FileSystemWatcher(this)),
     mAnimationDriver(new TileAnimationDriver(this)),
-    mReloadTilesetsOnChange(false)
+    mReloadTilesetsOnChange(false),
+    mNextScanId(0)
 {
     connect(mWatcher, SIGNAL(fileChanged(QString)),
             this, SLOT(fileChanged(QString)));
@@ -55,6 +219,8 @@ TilesetManager::~TilesetManager()
     // Since all MapDocuments should be deleted first, we assert that there are
     // no remaining tileset references.
     Q_ASSERT(mTilesets.size() == 0);
+
+    mScanThreadPool.waitForDone();
 }
 
 TilesetManager *TilesetManager::instance()
@@ -102,8 +268,13 @@ void TilesetManager::addReference(const SharedTileset &tileset)
         mTilesets[tileset]++;
     } else {
         mTilesets.insert(tileset, 1);
-        if (!tileset->imageSource().isEmpty())
+        if (!tileset->imageSource().isEmpty()) {
             mWatcher->addPath(tileset->imageSource());
+
+            // Remember the current contents to detect what changes later
+            if (mReloadTilesetsOnChange)
+                scanTilesetImage(tileset, false);
+        }
     }
 }
 
@@ -114,6 +285,9 @@ void TilesetManager::removeReference(const SharedTileset &tileset)
 
     if (mTilesets.value(tileset) == 0) {
         mTilesets.remove(tileset);
+        mImageStates.remove(tileset.data());
+        mScanningTilesets.remove(tileset.data());
+        mPendingReloads.remove(tileset.data());
         if (!tileset->imageSource().isEmpty())
             mWatcher->removePath(tileset->imageSource());
     }
@@ -144,12 +318,29 @@ void TilesetManager::forceTilesetReload(SharedTileset &tileset)
     QString fileName = tileset->imageSource();
     if (tileset->loadFromImage(fileName))
         emit tilesetChanged(tileset.data());
+
+    // The stored hashes no longer reflect the loaded tiles
+    mImageStates.remove(tileset.data());
+    if (mReloadTilesetsOnChange)
+        scanTilesetImage(tileset, false);
 }
 
 void TilesetManager::setReloadTilesetsOnChange(bool enabled)
 {
+    if (mReloadTilesetsOnChange == enabled)
+        return;
+
     mReloadTilesetsOnChange = enabled;
     // TODO: Clear the file system watcher when disabled
+
+    if (enabled) {
+        foreach (const SharedTileset &tileset, tilesets())
+            if (!tileset->imageSource().isEmpty())
+                scanTilesetImage(tileset, false);
+    } else {
+        mImageStates.clear();
+        mPendingReloads.clear();
+    }
 }
 
 void TilesetManager::setAnimateTiles(bool enabled)
@@ -182,16 +373,120 @@ void TilesetManager::fileChanged(const QString &path)
 
 void TilesetManager::fileChangedTimeout()
 {
-    for (SharedTileset &tileset : tilesets()) {
-        QString fileName = tileset->imageSource();
-        if (mChangedFiles.contains(fileName))
-            if (tileset->loadFromImage(fileName))
-                emit tilesetChanged(tileset.data());
-    }
+    foreach (const SharedTileset &tileset, tilesets())
+        if (mChangedFiles.contains(tileset->imageSource()))
+            scanTilesetImage(tileset, true);
 
     mChangedFiles.clear();
 }
 
+/**
+ * Starts scanning the image of the given \a tileset on a worker thread. When
+ * \a reload is true, the tileset is updated with the changes found. Otherwise
+ * only the hashes of its current contents are stored.
+ */
+void TilesetManager::scanTilesetImage(const SharedTileset &tileset, bool reload)
+{
+    Tileset *t = tileset.data();
+
+    // Only one scan per tileset may run at a time, to apply them in order
+    if (mScanningTilesets.contains(t)) {
+        if (reload)
+            mPendingReloads.insert(t);
+        return;
+    }
+
+    const ImageState state = mImageStates.value(t);
+
+    QSharedPointer<TilesetImageScan> scan(new TilesetImageScan);
+    scan->id = mNextScanId++;
+    scan->tileset = tileset;
+    scan->reload = reload;
+    scan->fileName = t->imageSource();
+    scan->tileSize = t->tileSize();
+    scan->margin = t->margin();
+    scan->spacing = t->tileSpacing();
+    scan->transparentColor = t->transparentColor();
+    scan->imageSize = QSize(t->imageWidth(), t->imageHeight());
+    scan->previousFileHash = state.fileHash;
+    scan->previousTileHashes = state.tileHashes;
+
+    mImageScans.insert(scan->id, scan);
+    mScanningTilesets.insert(t, scan->id);
+    mScanThreadPool.start(new ScanJob(this, scan));
+}
+
+void TilesetManager::imageScanFinished(int id)
+{
+    QSharedPointer<TilesetImageScan> scan = mImageScans.take(id);
+    if (!scan)
+        return;
+
+    // Skip results for tilesets that were released meanwhile
+    const SharedTileset tileset = scan->tileset.toStrongRef();
+    Tileset *t = tileset.data();
+    if (!t || mScanningTilesets.value(t, -1) != id)
+        return;
+
+    mScanningTilesets.remove(t);
+
+    // Skip results for tilesets that were changed meanwhile
+    if (t->imageSource() != scan->fileName ||
+            t->tileSize() != scan->tileSize ||
+            t->margin() != scan->margin ||
+            t->tileSpacing() != scan->spacing ||
+            t->transparentColor() != scan->transparentColor) {
+        mImageStates.remove(t);
+        mPendingReloads.remove(t);
+        return;
+    }
+
+    if (scan->success)
+        applyImageScan(t, scan.data());
+
+    if (mPendingReloads.remove(t))
+        scanTilesetImage(tileset, true);
+}
+
+void TilesetManager::applyImageScan(Tileset *tileset, TilesetImageScan *scan)
+{
+    if (scan->unchanged)
+        return;
+
+    if (scan->reload) {
+        if (!scan->image.isNull()) {
+            // Without previous hashes or when the layout changed, all tiles
+            // need to be updated
+            if (!tileset->loadFromImage(scan->image, scan->fileName))
+                return;
+
+            emit tilesetChanged(tileset);
+        } else {
+            QList<Tile*> changedTiles;
+
+            for (int i = 0; i < scan->changedTiles.size(); ++i) {
+                Tile *tile = tileset->tileAt(scan->changedTiles.at(i));
+                if (!tile)
+                    continue;
+
+                QPixmap tilePixmap = QPixmap::fromImage(scan->changedTileImages.at(i));
+                if (i < scan->changedTileMasks.size())
+                    tilePixmap.setMask(QBitmap::fromImage(scan->changedTileMasks.at(i)));
+
+                tile->setImage(tilePixmap);
+                changedTiles.append(tile);
+            }
+
+            if (!changedTiles.isEmpty())
+                emit tileImagesChanged(tileset, changedTiles);
+        }
+    }
+
+    ImageState &state = mImageStates[tileset];
+    state.fileHash = scan->fileHash;
+    state.tileHashes = scan->tileHashes;
+}
+
 void TilesetManager::advanceTileAnimations(int ms)
 {
     // TODO: This could be more optimal by keeping track of the list of
@@ -25,17 +25,22 @@
 #include "tileset.h"
 
 #include <QObject>
+#include <QHash>
 #include <QList>
 #include <QMap>
+#include <QSharedPointer>
 #include <QString>
 #include <QSet>
+#include <QThreadPool>
 #include <QTimer>
+#include <QVector>
 
 namespace Tiled {
 namespace Internal {
 
 class FileSystemWatcher;
 class TileAnimationDriver;
+class TilesetImageScan;
 
 /**
  * A tileset specification that uniquely identifies a certain tileset. Does not
@@ -54,6 +59,10 @@ struct TilesetSpec
  * The tileset manager keeps track of all tilesets used by loaded maps. It also
  * watches the tileset images for changes and will attempt to reload them when
  * they change.
+ *
+ * Changed images are read, hashed and decoded on a worker thread. Touched
+ * files with unchanged contents are ignored, and when the layout of the image
+ * is unchanged only the tiles whose pixels differ are updated.
  */
 class TilesetManager : public QObject
 {
@@ -136,6 +145,12 @@ signals:
      */
     void tilesetChanged(Tileset *tileset);
 
+    /**
+     * Emitted when only the images of the given \a tiles have changed, after
+     * their tileset image was reloaded.
+     */
+    void tileImagesChanged(Tileset *tileset, const QList<Tile*> &tiles);
+
     /**
      * Emitted when any images of the tiles in the given \a tileset have
      * changed. This is used to trigger repaints for displaying tile
@@ -146,6 +161,7 @@ signals:
 private slots:
     void fileChanged(const QString &path);
     void fileChangedTimeout();
+    void imageScanFinished(int id);
 
     void advanceTileAnimations(int ms);
 
@@ -162,8 +178,21 @@ private:
      */
     ~TilesetManager();
 
+    void scanTilesetImage(const SharedTileset &tileset, bool reload);
+    void applyImageScan(Tileset *tileset, TilesetImageScan *scan);
+
     static TilesetManager *mInstance;
 
+    /**
+     * The contents of a tileset image at the time it was last loaded, used to
+     * find out which tiles changed when the image is modified.
+     */
+    struct ImageState
+    {
+        QByteArray fileHash;
+        QVector<uint> tileHashes;
+    };
+
     /**
      * Stores the tilesets and maps them to the number of references.
      */
@@ -173,6 +202,13 @@ private:
     QSet<QString> mChangedFiles;
     QTimer mChangedFilesTimer;
     bool mReloadTilesetsOnChange;
+
+    QHash<Tileset*, ImageState> mImageStates;
+    QHash<int, QSharedPointer<TilesetImageScan> > mImageScans;
+    QHash<Tileset*, int> mScanningTilesets;    // Maps to the running scan
+    QSet<Tileset*> mPendingReloads;
+    QThreadPool mScanThreadPool;
+    int mNextScanId;
 };
 
 inline bool TilesetManager::reloadTilesetsOnChange() const
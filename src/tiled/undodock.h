@@ -24,12 +24,15 @@
 
 #include <QDockWidget>
 
+class QLabel;
 class QUndoGroup;
 class QUndoView;
 
 namespace Tiled {
 namespace Internal {
 
+class MapDocument;
+
 /**
  * A dock widget showing the undo stack. Mainly for debugging, but can also be
  * useful for the user.
@@ -41,12 +44,23 @@ class UndoDock : public QDockWidget
 public:
     UndoDock(QUndoGroup *undoGroup, QWidget *parent = 0);
 
+    /**
+     * Sets the map document for which to show the memory usage of the undo
+     * stack.
+     */
+    void setMapDocument(MapDocument *mapDocument);
+
 protected:
     void changeEvent(QEvent *e);
 
+private slots:
+    void updateMemoryUsage();
+
 private:
     void retranslateUi();
     QUndoView *mUndoView;
+    QLabel *mMemoryUsageLabel;
+    MapDocument *mMapDocument;
 };
 
 } // namespace Internal
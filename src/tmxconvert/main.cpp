@@ -0,0 +1,242 @@
+/*
+ * main.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tmxconverter.h"
+
+#if QT_VERSION >= 0x050000
+#include <QGuiApplication>
+#else
+#include <QApplication>
+#endif
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QStringList>
+
+namespace {
+
+struct CommandLineOptions {
+    CommandLineOptions()
+        : showHelp(false)
+        , showVersion(false)
+        , listFormats(false)
+        , threadCount(0)
+    {}
+
+    bool showHelp;
+    bool showVersion;
+    bool listFormats;
+    QString format;
+    QString outputDirectory;
+    QString pluginDirectory;
+    int threadCount;
+    QStringList filesToConvert;
+};
+
+} // anonymous namespace
+
+static void showHelp()
+{
+    qWarning() <<
+            "Usage:\n"
+            "  tmxconvert [options] -f FORMAT [input files...]\n"
+            "\n"
+            "Options:\n"
+            "  -h --help               : Display this help\n"
+            "  -v --version            : Display the version\n"
+            "  -f --format FORMAT      : The output format, given as file extension (json, lua, tmx, ...)\n"
+            "  -o --output-dir DIR     : The directory to write the converted maps to\n"
+            "                            (default: next to each input file)\n"
+            "  -j --jobs COUNT         : The number of maps to convert in parallel\n"
+            "                            (default: the number of CPU cores)\n"
+            "     --plugin-dir DIR     : The directory to load the map format plugins from\n"
+            "     --list-formats       : List the supported output formats\n"
+            "\n"
+            "Input files may contain the wildcards * and ? in their file name.\n";
+}
+
+static void showVersion()
+{
+    qWarning() << "TMX Map Converter"
+            << qPrintable(QCoreApplication::applicationVersion());
+}
+
+static QString requireValue(const QStringList &arguments, int &i,
+                            CommandLineOptions &options)
+{
+    i++;
+    if (i >= arguments.size()) {
+        options.showHelp = true;
+        return QString();
+    }
+    return arguments.at(i);
+}
+
+static void parseCommandLineArguments(CommandLineOptions &options)
+{
+    const QStringList arguments = QCoreApplication::arguments();
+
+    for (int i = 1; i < arguments.size(); ++i) {
+        const QString &arg = arguments.at(i);
+        if (arg == QLatin1String("--help") || arg == QLatin1String("-h")) {
+            options.showHelp = true;
+        } else if (arg == QLatin1String("--version")
+                || arg == QLatin1String("-v")) {
+            options.showVersion = true;
+        } else if (arg == QLatin1String("--format")
+                || arg == QLatin1String("-f")) {
+            options.format = requireValue(arguments, i, options);
+        } else if (arg == QLatin1String("--output-dir")
+                || arg == QLatin1String("-o")) {
+            options.outputDirectory = requireValue(arguments, i, options);
+        } else if (arg == QLatin1String("--jobs")
+                || arg == QLatin1String("-j")) {
+            const QString value = requireValue(arguments, i, options);
+            bool countIsInt;
+            options.threadCount = value.toInt(&countIsInt);
+            if (!options.showHelp && (!countIsInt || options.threadCount < 1)) {
+                qWarning() << value << ": the number of jobs is not a positive integer.";
+                options.showHelp = true;
+            }
+        } else if (arg == QLatin1String("--plugin-dir")) {
+            options.pluginDirectory = requireValue(arguments, i, options);
+        } else if (arg == QLatin1String("--list-formats")) {
+            options.listFormats = true;
+        } else if (arg.isEmpty()) {
+            options.showHelp = true;
+        } else if (arg.at(0) == QLatin1Char('-')) {
+            qWarning() << "Unknown option" << arg;
+            options.showHelp = true;
+        } else {
+            options.filesToConvert.append(arg);
+        }
+    }
+}
+
+/**
+ * Expands any wildcards in the file name part of the given patterns. The
+ * shell usually does this already, but not on all platforms.
+ */
+static QStringList expandFileNames(const QStringList &patterns)
+{
+    QStringList fileNames;
+
+    foreach (const QString &pattern, patterns) {
+        const QFileInfo fileInfo(pattern);
+        const QString name = fileInfo.fileName();
+
+        if (!name.contains(QLatin1Char('*')) &&
+                !name.contains(QLatin1Char('?'))) {
+            fileNames.append(pattern);
+            continue;
+        }
+
+        const QDir dir = fileInfo.dir();
+        const QStringList matches = dir.entryList(QStringList(name),
+                                                  QDir::Files | QDir::Readable,
+                                                  QDir::Name);
+        if (matches.isEmpty())
+            qWarning() << "No files matching" << pattern;
+
+        foreach (const QString &match, matches)
+            fileNames.append(dir.filePath(match));
+    }
+
+    return fileNames;
+}
+
+static QString defaultPluginPath()
+{
+    // Determine the plugin path the same way as Tiled itself
+#ifndef TILED_PLUGIN_DIR
+    QString pluginPath = QCoreApplication::applicationDirPath();
+#endif
+
+#ifdef Q_OS_WIN32
+    pluginPath += QLatin1String("/plugins/tiled");
+#elif defined(Q_OS_MAC)
+    pluginPath += QLatin1String("/../PlugIns");
+#elif defined(TILED_PLUGIN_DIR)
+    QString pluginPath = QLatin1String(TILED_PLUGIN_DIR);
+#else
+    pluginPath += QLatin1String("/../lib/tiled/plugins");
+#endif
+
+    return pluginPath;
+}
+
+int main(int argc, char *argv[])
+{
+    // A GUI application is needed for loading the tileset images
+#if QT_VERSION >= 0x050000
+    QGuiApplication a(argc, argv);
+#else
+    QApplication a(argc, argv);
+#endif
+
+    a.setOrganizationDomain(QLatin1String("mapeditor.org"));
+    a.setApplicationName(QLatin1String("TmxConvert"));
+    a.setApplicationVersion(QLatin1String("1.0"));
+
+    CommandLineOptions options;
+    parseCommandLineArguments(options);
+
+    if (options.showVersion) {
+        showVersion();
+        return 0;
+    }
+
+    TmxConverter converter;
+    converter.loadPlugins(options.pluginDirectory.isEmpty() ?
+                              defaultPluginPath() : options.pluginDirectory);
+
+    if (options.listFormats) {
+        foreach (const QString &format, converter.outputFormats())
+            qWarning() << qPrintable(format);
+        return 0;
+    }
+
+    if (options.showHelp || options.format.isEmpty() ||
+            options.filesToConvert.isEmpty()) {
+        showHelp();
+        return 0;
+    }
+
+    if (!converter.outputFormats().contains(options.format.toLower())) {
+        qWarning() << "Unsupported output format" << options.format;
+        return 1;
+    }
+
+    if (!options.outputDirectory.isEmpty() &&
+            !QDir().mkpath(options.outputDirectory)) {
+        qWarning() << "Could not create output directory"
+                   << options.outputDirectory;
+        return 1;
+    }
+
+    converter.setOutputFormat(options.format);
+    converter.setOutputDirectory(options.outputDirectory);
+    if (options.threadCount > 0)
+        converter.setThreadCount(options.threadCount);
+
+    const QStringList fileNames = expandFileNames(options.filesToConvert);
+    return converter.convert(fileNames) > 0 ? 1 : 0;
+}
@@ -0,0 +1,315 @@
+/*
+ * tmxconverter.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tmxconverter.h"
+
+#include "binarymapreader.h"
+#include "binarymapwriter.h"
+#include "map.h"
+#include "mapreaderinterface.h"
+#include "mapwriter.h"
+#include "mapwriterinterface.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QLibrary>
+#include <QMutexLocker>
+#include <QPluginLoader>
+#include <QRegExp>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+using namespace Tiled;
+
+namespace {
+
+/**
+ * A binary map reader that takes external tilesets from the shared cache.
+ */
+class CachedBinaryMapReader : public BinaryMapReader
+{
+public:
+    CachedBinaryMapReader(TilesetCache *cache)
+        : mCache(cache)
+    {}
+
+protected:
+    SharedTileset readExternalTileset(const QString &source,
+                                      QString *error) override
+    {
+        return mCache->tileset(source, error);
+    }
+
+private:
+    TilesetCache *mCache;
+};
+
+bool hasSuffix(const QString &fileName, const char *suffix)
+{
+    return QFileInfo(fileName).suffix().compare(QLatin1String(suffix),
+                                                Qt::CaseInsensitive) == 0;
+}
+
+/**
+ * Extracts the file extensions from name filters like
+ * "Json files (*.json)".
+ */
+QStringList extensionsFromNameFilters(const QStringList &nameFilters)
+{
+    QStringList extensions;
+    QRegExp pattern(QLatin1String("\\*\\.(\\w+)"));
+
+    foreach (const QString &nameFilter, nameFilters) {
+        int pos = 0;
+        while ((pos = pattern.indexIn(nameFilter, pos)) != -1) {
+            extensions.append(pattern.cap(1).toLower());
+            pos += pattern.matchedLength();
+        }
+    }
+
+    return extensions;
+}
+
+} // anonymous namespace
+
+class ConvertJob : public QRunnable
+{
+public:
+    ConvertJob(TmxConverter *converter, const QString &fileName)
+        : mConverter(converter)
+        , mFileName(fileName)
+    {}
+
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QString error;
+        mConverter->convertFile(mFileName, &error);
+        mConverter->reportResult(mFileName, timer.elapsed(), error);
+    }
+
+private:
+    TmxConverter *mConverter;
+    QString mFileName;
+};
+
+
+TmxConverter::TmxConverter()
+    : mOutputFormat(QLatin1String("tmx"))
+    , mThreadCount(QThread::idealThreadCount())
+    , mFailedCount(0)
+{
+}
+
+TmxConverter::~TmxConverter()
+{
+    foreach (const Plugin &plugin, mPlugins)
+        delete plugin.mutex;
+}
+
+void TmxConverter::loadPlugins(const QString &pluginPath)
+{
+    QDirIterator iterator(pluginPath, QDir::Files | QDir::Readable);
+    while (iterator.hasNext()) {
+        const QString &pluginFile = iterator.next();
+        if (!QLibrary::isLibrary(pluginFile))
+            continue;
+
+        QPluginLoader loader(pluginFile);
+        QObject *instance = loader.instance();
+
+        if (!instance) {
+            qWarning() << "Error:" << qPrintable(loader.errorString());
+            continue;
+        }
+
+        Plugin plugin;
+        plugin.instance = instance;
+        plugin.mutex = new QMutex;
+        mPlugins.append(plugin);
+    }
+}
+
+QStringList TmxConverter::outputFormats() const
+{
+    QStringList formats;
+    formats.append(QLatin1String("tmx"));
+    formats.append(QLatin1String("tmb"));
+
+    foreach (const Plugin &plugin, mPlugins) {
+        if (MapWriterInterface *writer =
+                qobject_cast<MapWriterInterface*>(plugin.instance)) {
+            foreach (const QString &extension,
+                     extensionsFromNameFilters(writer->nameFilters())) {
+                if (!formats.contains(extension))
+                    formats.append(extension);
+            }
+        }
+    }
+
+    return formats;
+}
+
+int TmxConverter::convert(const QStringList &fileNames)
+{
+    mFailedCount = 0;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(qMax(1, mThreadCount));
+
+    foreach (const QString &fileName, fileNames)
+        threadPool.start(new ConvertJob(this, fileName));
+
+    threadPool.waitForDone();
+
+    qWarning().nospace() << "Converted " << (fileNames.size() - mFailedCount)
+                         << " of " << fileNames.size() << " maps in "
+                         << timer.elapsed() << " ms (" << mTilesetCache.size()
+                         << " tilesets loaded)";
+
+    return mFailedCount;
+}
+
+bool TmxConverter::convertFile(const QString &fileName, QString *error)
+{
+    Map *map = readMap(fileName, error);
+    if (!map)
+        return false;
+
+    const bool written = writeMap(map, outputFileName(fileName), error);
+    delete map;
+    return written;
+}
+
+Map *TmxConverter::readMap(const QString &fileName, QString *error)
+{
+    // The formats of libtiled are read without locking, since each reader
+    // has its own state
+    if (hasSuffix(fileName, "tmx")) {
+        CachedMapReader reader(&mTilesetCache);
+        Map *map = reader.readMap(fileName);
+        if (!map)
+            *error = reader.errorString();
+        return map;
+    }
+
+    if (hasSuffix(fileName, "tmb")) {
+        CachedBinaryMapReader reader(&mTilesetCache);
+        Map *map = reader.readMap(fileName);
+        if (!map)
+            *error = reader.errorString();
+        return map;
+    }
+
+    // Plugins keep state between calls, so each plugin is only used by one
+    // thread at a time
+    foreach (const Plugin &plugin, mPlugins) {
+        MapReaderInterface *reader =
+                qobject_cast<MapReaderInterface*>(plugin.instance);
+        if (!reader || !reader->supportsFile(fileName))
+            continue;
+
+        QMutexLocker locker(plugin.mutex);
+        Map *map = reader->read(fileName);
+        if (!map)
+            *error = reader->errorString();
+        return map;
+    }
+
+    *error = QLatin1String("Unrecognized file format.");
+    return 0;
+}
+
+bool TmxConverter::writeMap(const Map *map, const QString &fileName,
+                            QString *error)
+{
+    const QString format = mOutputFormat.toLower();
+
+    if (format == QLatin1String("tmx")) {
+        MapWriter writer;
+        if (!writer.writeMap(map, fileName)) {
+            *error = writer.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    if (format == QLatin1String("tmb")) {
+        BinaryMapWriter writer;
+        if (!writer.writeMap(map, fileName)) {
+            *error = writer.errorString();
+            return false;
+        }
+        return true;
+    }
+
+    foreach (const Plugin &plugin, mPlugins) {
+        MapWriterInterface *writer =
+                qobject_cast<MapWriterInterface*>(plugin.instance);
+        if (!writer ||
+                !extensionsFromNameFilters(writer->nameFilters()).contains(format))
+            continue;
+
+        QMutexLocker locker(plugin.mutex);
+        if (!writer->write(map, fileName)) {
+            *error = writer->errorString();
+            return false;
+        }
+        return true;
+    }
+
+    *error = QString(QLatin1String("No writer found for format '%1'."))
+            .arg(mOutputFormat);
+    return false;
+}
+
+QString TmxConverter::outputFileName(const QString &fileName) const
+{
+    const QFileInfo fileInfo(fileName);
+    const QDir dir = mOutputDirectory.isEmpty() ? fileInfo.dir()
+                                                : QDir(mOutputDirectory);
+
+    return dir.filePath(fileInfo.completeBaseName() + QLatin1Char('.') +
+                        mOutputFormat);
+}
+
+void TmxConverter::reportResult(const QString &fileName, qint64 elapsed,
+                                const QString &error)
+{
+    QMutexLocker locker(&mReportMutex);
+
+    if (error.isEmpty()) {
+        qWarning().nospace() << "Converted " << fileName << " in "
+                             << elapsed << " ms";
+    } else {
+        ++mFailedCount;
+        qWarning().nospace() << "Failed to convert " << fileName << " after "
+                             << elapsed << " ms: " << qPrintable(error);
+    }
+}
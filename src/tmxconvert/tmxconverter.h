@@ -0,0 +1,104 @@
+/*
+ * tmxconverter.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of Road to Ballhalla Editor.
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU General Public License as published by the Free
+ * Software Foundation; either version 2 of the License, or (at your option)
+ * any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but WITHOUT
+ * ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ * FITNESS FOR A PARTICULAR PURPOSE.  See the GNU General Public License for
+ * more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TMXCONVERTER_H
+#define TMXCONVERTER_H
+
+#include "tilesetcache.h"
+
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+namespace Tiled {
+class Map;
+}
+
+class ConvertJob;
+
+/**
+ * Converts maps between the formats supported by libtiled and the map
+ * reader and writer plugins, without a GUI.
+ *
+ * The maps are converted in parallel on a thread pool. External tilesets
+ * referenced by TMX and binary maps are read only once and shared between
+ * all maps.
+ */
+class TmxConverter
+{
+public:
+    TmxConverter();
+    ~TmxConverter();
+
+    void loadPlugins(const QString &pluginPath);
+
+    /**
+     * Returns the file extensions of the formats that maps can be written
+     * in.
+     */
+    QStringList outputFormats() const;
+
+    QString outputFormat() const { return mOutputFormat; }
+    void setOutputFormat(const QString &format) { mOutputFormat = format; }
+
+    QString outputDirectory() const { return mOutputDirectory; }
+    void setOutputDirectory(const QString &directory)
+    { mOutputDirectory = directory; }
+
+    int threadCount() const { return mThreadCount; }
+    void setThreadCount(int threadCount) { mThreadCount = threadCount; }
+
+    /**
+     * Converts the given files to the output format. Returns the number of
+     * files that failed to convert.
+     */
+    int convert(const QStringList &fileNames);
+
+private:
+    friend class ConvertJob;
+
+    struct Plugin {
+        QObject *instance;
+        QMutex *mutex;
+    };
+
+    bool convertFile(const QString &fileName, QString *error);
+    Tiled::Map *readMap(const QString &fileName, QString *error);
+    bool writeMap(const Tiled::Map *map, const QString &fileName,
+                  QString *error);
+    QString outputFileName(const QString &fileName) const;
+
+    void reportResult(const QString &fileName, qint64 elapsed,
+                      const QString &error);
+
+    QList<Plugin> mPlugins;
+    Tiled::TilesetCache mTilesetCache;
+
+    QString mOutputFormat;
+    QString mOutputDirectory;
+    int mThreadCount;
+
+    QMutex mReportMutex;
+    int mFailedCount;
+};
+
+#endif // TMXCONVERTER_H
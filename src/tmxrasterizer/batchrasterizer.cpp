@@ -0,0 +1,234 @@
+/*
+ * batchrasterizer.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of the TMX Rasterizer.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "batchrasterizer.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QRunnable>
+#include <QThread>
+#include <QThreadPool>
+
+using namespace Tiled;
+
+namespace {
+
+/**
+ * Renders one map of the batch, using its own copy of the rasterizer.
+ */
+class RenderJob : public QRunnable
+{
+public:
+    RenderJob(const TmxRasterizer &rasterizer,
+              BatchRasterizer::Job *job,
+              bool pyramid)
+        : mRasterizer(rasterizer)
+        , mJob(job)
+        , mPyramid(pyramid)
+    {}
+
+    void run() override
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        int result;
+        if (mPyramid)
+            result = mRasterizer.renderPyramid(mJob->mapFileName, mJob->outputFileName);
+        else
+            result = mRasterizer.render(mJob->mapFileName, mJob->outputFileName);
+
+        // Remember what the map was made of, for the watch mode
+        mJob->tilesetFiles = mRasterizer.tilesetFiles();
+        mJob->dependencies = mRasterizer.tilesetFiles();
+        mJob->dependencies += mRasterizer.imageFiles();
+        mJob->dependencies.append(mJob->mapFileName);
+
+        mJob->failed = result != 0;
+
+        if (mJob->failed) {
+            qWarning().nospace() << "Failed to render " << mJob->mapFileName;
+        } else {
+            qWarning().nospace() << "Rendered " << mJob->mapFileName << " in "
+                                 << timer.elapsed() << " ms";
+        }
+    }
+
+private:
+    TmxRasterizer mRasterizer;
+    BatchRasterizer::Job *mJob;
+    bool mPyramid;
+};
+
+} // anonymous namespace
+
+BatchRasterizer::BatchRasterizer(const TmxRasterizer &rasterizer,
+                                 QObject *parent)
+    : QObject(parent)
+    , mRasterizer(rasterizer)
+    , mPyramid(false)
+    , mJobCount(QThread::idealThreadCount())
+{
+    mRasterizer.setTilesetCache(&mTilesetCache);
+
+    // Editors tend to write a file in several steps, so wait until it is
+    // quiet before rendering again
+    mChangedTimer.setInterval(200);
+    mChangedTimer.setSingleShot(true);
+
+    connect(&mWatcher, SIGNAL(fileChanged(QString)),
+            SLOT(fileChanged(QString)));
+    connect(&mChangedTimer, SIGNAL(timeout()),
+            SLOT(renderChanged()));
+}
+
+BatchRasterizer::~BatchRasterizer()
+{
+    qDeleteAll(mJobs);
+}
+
+void BatchRasterizer::addJob(const QString &mapFileName,
+                             const QString &outputFileName)
+{
+    Job *job = new Job;
+    job->mapFileName = mapFileName;
+    job->outputFileName = outputFileName;
+    job->failed = false;
+    mJobs.append(job);
+}
+
+int BatchRasterizer::render()
+{
+    return render(mJobs);
+}
+
+int BatchRasterizer::render(const QList<Job*> &jobs)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    TmxRasterizer rasterizer(mRasterizer);
+
+    // When several maps are rendered at once, each of them gets one thread
+    const int jobCount = qMax(1, qMin(mJobCount, jobs.size()));
+    if (jobCount > 1)
+        rasterizer.setThreadCount(1);
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(jobCount);
+
+    foreach (Job *job, jobs)
+        threadPool.start(new RenderJob(rasterizer, job, mPyramid));
+
+    threadPool.waitForDone();
+
+    int failed = 0;
+    foreach (const Job *job, jobs)
+        if (job->failed)
+            ++failed;
+
+    if (jobs.size() > 1) {
+        qWarning().nospace() << "Rendered " << (jobs.size() - failed) << " of "
+                             << jobs.size() << " maps in " << timer.elapsed()
+                             << " ms (" << mTilesetCache.size()
+                             << " tilesets loaded)";
+    }
+
+    return failed;
+}
+
+void BatchRasterizer::watch()
+{
+    updateWatchedFiles();
+}
+
+void BatchRasterizer::fileChanged(const QString &path)
+{
+    mChangedFiles.insert(path);
+    mChangedTimer.start();
+}
+
+void BatchRasterizer::renderChanged()
+{
+    QList<Job*> changedJobs;
+
+    foreach (Job *job, mJobs) {
+        bool changed = false;
+        foreach (const QString &dependency, job->dependencies) {
+            if (mChangedFiles.contains(dependency)) {
+                changed = true;
+                break;
+            }
+        }
+        if (changed)
+            changedJobs.append(job);
+    }
+
+    mChangedFiles.clear();
+
+    if (changedJobs.isEmpty())
+        return;
+
+    // Tilesets are read again, since they or their images may have changed
+    foreach (Job *job, changedJobs)
+        foreach (const QString &tilesetFile, job->tilesetFiles)
+            mTilesetCache.remove(tilesetFile);
+
+    render(changedJobs);
+    updateWatchedFiles();
+}
+
+/**
+ * Makes sure all dependencies are watched. Files that were replaced rather
+ * than modified in place are dropped by the watcher, so this is done again
+ * after each render.
+ */
+void BatchRasterizer::updateWatchedFiles()
+{
+    QSet<QString> watched = mWatcher.files().toSet();
+    QStringList toWatch;
+
+    foreach (const Job *job, mJobs) {
+        foreach (const QString &dependency, job->dependencies) {
+            // Files embedded as resources can't change
+            if (dependency.startsWith(QLatin1Char(':')))
+                continue;
+            if (watched.contains(dependency))
+                continue;
+            if (!QFileInfo(dependency).exists())
+                continue;
+
+            watched.insert(dependency);
+            toWatch.append(dependency);
+        }
+    }
+
+    if (!toWatch.isEmpty())
+        mWatcher.addPaths(toWatch);
+}
@@ -0,0 +1,114 @@
+/*
+ * batchrasterizer.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of the TMX Rasterizer.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef BATCHRASTERIZER_H
+#define BATCHRASTERIZER_H
+
+#include "tilesetcache.h"
+#include "tmxrasterizer.h"
+
+#include <QFileSystemWatcher>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+/**
+ * Renders a list of maps, several at the same time. The maps share a
+ * tileset cache, so that each tileset and its image is only loaded once.
+ *
+ * In watch mode, the maps are rendered again whenever they or any of the
+ * tilesets and images they use change on disk.
+ */
+class BatchRasterizer : public QObject
+{
+    Q_OBJECT
+
+public:
+    /**
+     * Creates a batch rasterizer that renders each map with the settings of
+     * the given \a rasterizer.
+     */
+    explicit BatchRasterizer(const TmxRasterizer &rasterizer,
+                             QObject *parent = 0);
+    ~BatchRasterizer();
+
+    void addJob(const QString &mapFileName, const QString &outputFileName);
+
+    /**
+     * Sets whether tile pyramids are written instead of single images, in
+     * which case the output file names are directories.
+     */
+    void setPyramid(bool pyramid) { mPyramid = pyramid; }
+
+    /**
+     * Sets the number of maps rendered at the same time.
+     */
+    void setJobCount(int jobCount) { mJobCount = jobCount; }
+
+    /**
+     * Renders all maps. Returns the number of maps that failed to render.
+     */
+    int render();
+
+    /**
+     * Starts watching the maps and their dependencies for changes. Needs a
+     * running event loop.
+     */
+    void watch();
+
+    struct Job {
+        QString mapFileName;
+        QString outputFileName;
+        QStringList tilesetFiles;
+        QStringList dependencies;
+        bool failed;
+    };
+
+private slots:
+    void fileChanged(const QString &path);
+    void renderChanged();
+
+private:
+    int render(const QList<Job*> &jobs);
+    void updateWatchedFiles();
+
+    TmxRasterizer mRasterizer;
+    TilesetCache mTilesetCache;
+    QList<Job*> mJobs;
+    bool mPyramid;
+    int mJobCount;
+
+    QFileSystemWatcher mWatcher;
+    QTimer mChangedTimer;
+    QSet<QString> mChangedFiles;
+};
+
+#endif // BATCHRASTERIZER_H
@@ -26,6 +26,7 @@
  * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 
+#include "batchrasterizer.h"
 #include "tmxrasterizer.h"
 
 #if QT_VERSION >= 0x050000
@@ -35,7 +36,12 @@
 #endif
 
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRegExp>
 #include <QStringList>
+#include <QTextStream>
 
 namespace {
 
@@ -47,16 +53,24 @@ struct CommandLineOptions {
         , tileSize(0)
         , useAntiAliasing(false)
         , ignoreVisibility(false)
+        , threadCount(0)
+        , bandHeight(0)
+        , pyramid(false)
+        , watch(false)
     {}
 
     bool showHelp;
     bool showVersion;
-    QString fileToOpen;
-    QString fileToSave;
+    QStringList files;
     qreal scale;
     int tileSize;
     bool useAntiAliasing;
     bool ignoreVisibility;
+    int threadCount;
+    int bandHeight;
+    bool pyramid;
+    bool watch;
+    QString manifest;
     QStringList layersToHide;
 };
 
@@ -68,6 +82,9 @@ static void showHelp()
     qWarning() <<
             "Usage:\n"
             "  tmxrasterizer [options] [input file] [output file]\n"
+            "  tmxrasterizer [options] --pyramid [input file] [output directory]\n"
+            "  tmxrasterizer [options] [input file] [output file] [input file] [output file]...\n"
+            "  tmxrasterizer [options] --batch [manifest file]\n"
             "\n"
             "Options:\n"
             "  -h --help               : Display this help\n"
@@ -79,7 +96,19 @@ static void showHelp()
             "     --ignore-visibility  : Ignore all layer visibility flags in the map file, and render all\n"
             "                            layers in the output (default is to omit invisible layers)\n"
             "     --hide-layer         : Specifies a layer to omit from the output image\n"
-            "                            Can be repeated to hide multiple layers\n";
+            "                            Can be repeated to hide multiple layers\n"
+            "  -j --threads COUNT      : The number of threads used for rendering\n"
+            "                            (default: the number of CPU cores)\n"
+            "     --band-height ROWS   : The height of the bands in which the image is rendered (default: 256)\n"
+            "                            PNG images are written band by band, which limits the memory use\n"
+            "     --pyramid            : Write a pyramid of 256x256 image tiles for all zoom levels to the\n"
+            "                            output directory, stored as z/x/y.png. When the pyramid is written\n"
+            "                            again, unchanged tiles are not saved again. The highest zoom level\n"
+            "                            is still rendered completely, only lower levels are skipped\n"
+            "     --batch MANIFEST     : Render the maps listed in the manifest file, one input and output file\n"
+            "                            per line separated by whitespace. Lines starting with # are ignored\n"
+            "     --watch              : Keep running and render the maps again whenever they, or the tilesets\n"
+            "                            and images they use, change\n";
 }
 
 static void showVersion()
@@ -132,6 +161,42 @@ static void parseCommandLineArguments(CommandLineOptions &options)
             } else {
                 options.layersToHide.append(arguments.at(i));
             }
+        } else if (arg == QLatin1String("--threads")
+                || arg == QLatin1String("-j")) {
+            i++;
+            if (i >= arguments.size()) {
+                options.showHelp = true;
+            } else {
+                bool threadCountIsInt;
+                options.threadCount = arguments.at(i).toInt(&threadCountIsInt);
+                if (!threadCountIsInt || options.threadCount < 1) {
+                    qWarning() << arguments.at(i) << ": the specified thread count is not a positive integer.";
+                    options.showHelp = true;
+                }
+            }
+        } else if (arg == QLatin1String("--band-height")) {
+            i++;
+            if (i >= arguments.size()) {
+                options.showHelp = true;
+            } else {
+                bool bandHeightIsInt;
+                options.bandHeight = arguments.at(i).toInt(&bandHeightIsInt);
+                if (!bandHeightIsInt || options.bandHeight < 1) {
+                    qWarning() << arguments.at(i) << ": the specified band height is not a positive integer.";
+                    options.showHelp = true;
+                }
+            }
+        } else if (arg == QLatin1String("--pyramid")) {
+            options.pyramid = true;
+        } else if (arg == QLatin1String("--batch")) {
+            i++;
+            if (i >= arguments.size()) {
+                options.showHelp = true;
+            } else {
+                options.manifest = arguments.at(i);
+            }
+        } else if (arg == QLatin1String("--watch")) {
+            options.watch = true;
         } else if (arg == QLatin1String("--anti-aliasing")
                 || arg == QLatin1String("-a")) {
             options.useAntiAliasing = true;
@@ -142,17 +207,52 @@ static void parseCommandLineArguments(CommandLineOptions &options)
         } else if (arg.at(0) == QLatin1Char('-')) {
             qWarning() << "Unknown option" << arg;
             options.showHelp = true;
-        } else if (options.fileToOpen.isEmpty()) {
-            options.fileToOpen = arg;
-        } else if (options.fileToSave.isEmpty()) {
-            options.fileToSave = arg;
         } else {
-            // All args are already defined. Show help.
-            options.showHelp = true;
+            options.files.append(arg);
         }
     }
 }
 
+/**
+ * Reads the input and output file pairs listed in the given manifest.
+ * Relative paths are relative to the directory of the manifest.
+ */
+static bool readManifest(const QString &fileName, QStringList &files)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning().nospace() << "Error while reading " << fileName << ":\n"
+                             << qPrintable(file.errorString());
+        return false;
+    }
+
+    const QDir dir = QFileInfo(fileName).dir();
+    const QRegExp whitespace(QLatin1String("\\s+"));
+
+    QTextStream stream(&file);
+    int lineNumber = 0;
+
+    while (!stream.atEnd()) {
+        const QString line = stream.readLine().trimmed();
+        ++lineNumber;
+
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#')))
+            continue;
+
+        const QStringList parts = line.split(whitespace);
+        if (parts.size() != 2) {
+            qWarning().nospace() << fileName << ":" << lineNumber
+                                 << ": expected an input and an output file";
+            return false;
+        }
+
+        files.append(QDir::cleanPath(dir.absoluteFilePath(parts.at(0))));
+        files.append(QDir::cleanPath(dir.absoluteFilePath(parts.at(1))));
+    }
+
+    return true;
+}
+
 int main(int argc, char *argv[])
 {
 #if QT_VERSION >= 0x050000
@@ -172,7 +272,9 @@ int main(int argc, char *argv[])
         showVersion();
         return 0;
     }
-    if (options.showHelp || options.fileToOpen.isEmpty() || options.fileToSave.isEmpty()) {
+    if (!options.manifest.isEmpty() && !readManifest(options.manifest, options.files))
+        return 1;
+    if (options.showHelp || options.files.isEmpty() || options.files.size() % 2 != 0) {
         showHelp();
         return 0;
     }
@@ -186,6 +288,11 @@ int main(int argc, char *argv[])
     w.setIgnoreVisibility(options.ignoreVisibility);
     w.setLayersToHide(options.layersToHide);
 
+    if (options.threadCount > 0)
+        w.setThreadCount(options.threadCount);
+    if (options.bandHeight > 0)
+        w.setBandHeight(options.bandHeight);
+
 
     if (options.tileSize > 0) {
         w.setTileSize(options.tileSize);
@@ -193,6 +300,28 @@ int main(int argc, char *argv[])
         w.setScale(options.scale);
     }
 
-    return w.render(options.fileToOpen, options.fileToSave);
+    if (options.files.size() == 2 && !options.watch) {
+        if (options.pyramid)
+            return w.renderPyramid(options.files.at(0), options.files.at(1));
+
+        return w.render(options.files.at(0), options.files.at(1));
+    }
+
+    BatchRasterizer batch(w);
+    batch.setPyramid(options.pyramid);
+    if (options.threadCount > 0)
+        batch.setJobCount(options.threadCount);
+
+    for (int i = 0; i < options.files.size(); i += 2)
+        batch.addJob(options.files.at(i), options.files.at(i + 1));
+
+    const int failures = batch.render();
+
+    if (options.watch) {
+        batch.watch();
+        return a.exec();
+    }
+
+    return failures > 0 ? 1 : 0;
 }
 
@@ -0,0 +1,271 @@
+/*
+ * pngstreamwriter.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of the TMX Rasterizer.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "pngstreamwriter.h"
+
+#if defined(Q_OS_WIN) && QT_VERSION >= 0x050000
+#include <QtZlib/zlib.h>
+#else
+#include <zlib.h>
+#endif
+
+#include <QtEndian>
+
+#ifdef Z_PREFIX
+#undef compress
+#endif
+
+#include <cstdlib>
+#include <cstring>
+
+struct PngStreamWriter::Stream
+{
+    z_stream z;
+};
+
+// The amount of compressed data collected before an IDAT chunk is written
+static const int ChunkSize = 64 * 1024;
+
+enum FilterType {
+    FilterNone  = 0,
+    FilterSub   = 1,
+    FilterUp    = 2
+};
+
+static QByteArray bigEndian(quint32 value)
+{
+    uchar bytes[4];
+    qToBigEndian<quint32>(value, bytes);
+    return QByteArray(reinterpret_cast<const char*>(bytes), 4);
+}
+
+/**
+ * Estimates how well a filtered row will compress, as the sum of the
+ * absolute values of its bytes interpreted as signed (as done by libpng).
+ */
+static int filterCost(const uchar *row, int length)
+{
+    int cost = 0;
+    for (int i = 0; i < length; ++i)
+        cost += std::abs(static_cast<signed char>(row[i]));
+    return cost;
+}
+
+PngStreamWriter::PngStreamWriter()
+    : mWidth(0)
+    , mHeight(0)
+    , mRowsWritten(0)
+    , mStream(0)
+{
+}
+
+PngStreamWriter::~PngStreamWriter()
+{
+    if (mStream) {
+        deflateEnd(&mStream->z);
+        delete mStream;
+    }
+}
+
+bool PngStreamWriter::open(const QString &fileName, int width, int height)
+{
+    Q_ASSERT(!mStream);
+
+    mFile.setFileName(fileName);
+    if (!mFile.open(QIODevice::WriteOnly)) {
+        mError = mFile.errorString();
+        return false;
+    }
+
+    mWidth = width;
+    mHeight = height;
+    mRowsWritten = 0;
+
+    const int rowLength = width * 4;
+    mRow.resize(rowLength);
+    mPreviousRow.fill('\0', rowLength);
+    mSubRow.resize(rowLength);
+    mUpRow.resize(rowLength);
+    mFiltered.resize(rowLength + 1);
+    mOutput.resize(ChunkSize);
+
+    mStream = new Stream;
+    mStream->z.zalloc = Z_NULL;
+    mStream->z.zfree = Z_NULL;
+    mStream->z.opaque = Z_NULL;
+    if (deflateInit(&mStream->z, Z_DEFAULT_COMPRESSION) != Z_OK) {
+        mError = QLatin1String("Could not initialize compression");
+        delete mStream;
+        mStream = 0;
+        return false;
+    }
+    mStream->z.next_out = reinterpret_cast<Bytef*>(mOutput.data());
+    mStream->z.avail_out = ChunkSize;
+
+    static const char signature[] = "\x89PNG\r\n\x1a\n";
+    if (mFile.write(signature, 8) != 8) {
+        mError = mFile.errorString();
+        return false;
+    }
+
+    QByteArray header;
+    header.append(bigEndian(width));
+    header.append(bigEndian(height));
+    header.append(char(8));     // Bit depth
+    header.append(char(6));     // Color type: RGBA
+    header.append(char(0));     // Compression method
+    header.append(char(0));     // Filter method
+    header.append(char(0));     // No interlacing
+
+    return writeChunk("IHDR", header);
+}
+
+bool PngStreamWriter::writeRow(const QRgb *row)
+{
+    Q_ASSERT(mStream && mRowsWritten < mHeight);
+
+    uchar *rgba = reinterpret_cast<uchar*>(mRow.data());
+    for (int x = 0; x < mWidth; ++x) {
+        const QRgb pixel = row[x];
+        rgba[x * 4 + 0] = qRed(pixel);
+        rgba[x * 4 + 1] = qGreen(pixel);
+        rgba[x * 4 + 2] = qBlue(pixel);
+        rgba[x * 4 + 3] = qAlpha(pixel);
+    }
+
+    // Pick the filter that is likely to compress best for this row
+    const int length = mRow.size();
+    const uchar *previous = reinterpret_cast<const uchar*>(mPreviousRow.constData());
+    uchar *filtered = reinterpret_cast<uchar*>(mFiltered.data()) + 1;
+
+    uchar *subRow = reinterpret_cast<uchar*>(mSubRow.data());
+    uchar *upRow = reinterpret_cast<uchar*>(mUpRow.data());
+
+    for (int i = 0; i < length; ++i) {
+        subRow[i] = rgba[i] - (i >= 4 ? rgba[i - 4] : 0);
+        upRow[i] = rgba[i] - previous[i];
+    }
+
+    const int noneCost = filterCost(rgba, length);
+    const int subCost = filterCost(subRow, length);
+    const int upCost = filterCost(upRow, length);
+
+    if (subCost <= noneCost && subCost <= upCost) {
+        mFiltered[0] = char(FilterSub);
+        std::memcpy(filtered, subRow, length);
+    } else if (upCost <= noneCost) {
+        mFiltered[0] = char(FilterUp);
+        std::memcpy(filtered, upRow, length);
+    } else {
+        mFiltered[0] = char(FilterNone);
+        std::memcpy(filtered, rgba, length);
+    }
+
+    qSwap(mRow, mPreviousRow);
+    ++mRowsWritten;
+
+    mStream->z.next_in = reinterpret_cast<Bytef*>(mFiltered.data());
+    mStream->z.avail_in = mFiltered.size();
+    return compress(Z_NO_FLUSH);
+}
+
+bool PngStreamWriter::close()
+{
+    Q_ASSERT(mStream && mRowsWritten == mHeight);
+
+    mStream->z.next_in = Z_NULL;
+    mStream->z.avail_in = 0;
+    if (!compress(Z_FINISH))
+        return false;
+
+    deflateEnd(&mStream->z);
+    delete mStream;
+    mStream = 0;
+
+    if (!writeChunk("IEND", QByteArray()))
+        return false;
+
+    mFile.close();
+    if (mFile.error() != QFile::NoError) {
+        mError = mFile.errorString();
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Compresses the pending input, writing an IDAT chunk whenever the output
+ * buffer fills up. With Z_FINISH, all remaining output is written.
+ */
+bool PngStreamWriter::compress(int flush)
+{
+    z_stream &z = mStream->z;
+
+    forever {
+        const int result = deflate(&z, flush);
+        if (result == Z_STREAM_ERROR) {
+            mError = QLatin1String("Compression error");
+            return false;
+        }
+
+        const bool finished = result == Z_STREAM_END;
+        const int pending = ChunkSize - z.avail_out;
+
+        if (z.avail_out == 0 || (finished && pending > 0)) {
+            if (!writeChunk("IDAT", mOutput.left(pending)))
+                return false;
+            z.next_out = reinterpret_cast<Bytef*>(mOutput.data());
+            z.avail_out = ChunkSize;
+            if (!finished)
+                continue;
+        }
+
+        if (finished || (flush == Z_NO_FLUSH && z.avail_in == 0))
+            return true;
+    }
+}
+
+bool PngStreamWriter::writeChunk(const char *type, const QByteArray &data)
+{
+    QByteArray chunk = bigEndian(data.size());
+    chunk.append(type, 4);
+    chunk.append(data);
+
+    const uLong crc = crc32(crc32(0L, Z_NULL, 0),
+                            reinterpret_cast<const Bytef*>(chunk.constData() + 4),
+                            chunk.size() - 4);
+    chunk.append(bigEndian(crc));
+
+    if (mFile.write(chunk) != chunk.size()) {
+        mError = mFile.errorString();
+        return false;
+    }
+
+    return true;
+}
@@ -0,0 +1,90 @@
+/*
+ * pngstreamwriter.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of the TMX Rasterizer.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef PNGSTREAMWRITER_H
+#define PNGSTREAMWRITER_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QRgb>
+#include <QString>
+
+/**
+ * Writes a 32-bit RGBA PNG image one row at a time.
+ *
+ * Unlike QImageWriter, this does not need the whole image in memory. The
+ * compressed data is written to the file in chunks as the rows come in.
+ */
+class PngStreamWriter
+{
+public:
+    PngStreamWriter();
+    ~PngStreamWriter();
+
+    /**
+     * Creates the file \a fileName and writes the PNG header for an image
+     * of the given size.
+     */
+    bool open(const QString &fileName, int width, int height);
+
+    /**
+     * Writes the next row of the image. The \a row needs to contain width
+     * non-premultiplied ARGB pixels.
+     */
+    bool writeRow(const QRgb *row);
+
+    /**
+     * Finishes the image. Needs to be called after all rows were written.
+     */
+    bool close();
+
+    QString errorString() const { return mError; }
+
+private:
+    struct Stream;
+
+    bool compress(int flush);
+    bool writeChunk(const char *type, const QByteArray &data);
+
+    QFile mFile;
+    QString mError;
+    int mWidth;
+    int mHeight;
+    int mRowsWritten;
+
+    QByteArray mRow;
+    QByteArray mPreviousRow;
+    QByteArray mSubRow;
+    QByteArray mUpRow;
+    QByteArray mFiltered;
+    QByteArray mOutput;
+
+    Stream *mStream;
+};
+
+#endif // PNGSTREAMWRITER_H
@@ -0,0 +1,335 @@
+/*
+ * tilepyramid.cpp
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of the TMX Rasterizer.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tilepyramid.h"
+
+#include "tmxrasterizer.h"
+
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QRunnable>
+#include <QTextStream>
+#include <QThreadPool>
+
+namespace {
+
+class BaseRowJob : public QRunnable
+{
+public:
+    BaseRowJob(TilePyramid *pyramid, int row)
+        : mPyramid(pyramid), mRow(row) {}
+
+    void run() override { mPyramid->renderBaseRow(mRow); }
+
+private:
+    TilePyramid *mPyramid;
+    int mRow;
+};
+
+class RowJob : public QRunnable
+{
+public:
+    RowJob(TilePyramid *pyramid, int zoom, int row)
+        : mPyramid(pyramid), mZoom(zoom), mRow(row) {}
+
+    void run() override { mPyramid->renderRow(mZoom, mRow); }
+
+private:
+    TilePyramid *mPyramid;
+    int mZoom;
+    int mRow;
+};
+
+bool isEmptyTile(const QImage &tile)
+{
+    // Fully transparent premultiplied pixels are all zero
+    for (int y = 0; y < tile.height(); ++y) {
+        const QRgb *line = reinterpret_cast<const QRgb*>(tile.constScanLine(y));
+        for (int x = 0; x < tile.width(); ++x)
+            if (line[x])
+                return false;
+    }
+    return true;
+}
+
+QByteArray contentHash(const QImage &tile)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (int y = 0; y < tile.height(); ++y) {
+        hash.addData(reinterpret_cast<const char*>(tile.constScanLine(y)),
+                     tile.width() * 4);
+    }
+    return hash.result().toHex();
+}
+
+} // anonymous namespace
+
+static const char HashFileName[] = "tiles.sha1";
+
+TilePyramid::TilePyramid(const TmxRasterizer *rasterizer,
+                         const QString &directory)
+    : mRasterizer(rasterizer)
+    , mDirectory(directory)
+    , mMaxZoom(0)
+    , mTilesWritten(0)
+    , mTilesUnchanged(0)
+    , mError(false)
+{
+    const QSize imageSize = rasterizer->imageSize();
+    mColumns = qMax(1, (imageSize.width() + TileSize - 1) / TileSize);
+    mRows = qMax(1, (imageSize.height() + TileSize - 1) / TileSize);
+
+    // At the lowest zoom level, the whole map fits in a single tile
+    while ((1 << mMaxZoom) < mColumns || (1 << mMaxZoom) < mRows)
+        ++mMaxZoom;
+}
+
+bool TilePyramid::render()
+{
+    if (!QDir().mkpath(mDirectory.path())) {
+        qWarning().nospace() << "Could not create directory "
+                             << mDirectory.path();
+        return false;
+    }
+
+    if (!readHashes())
+        return false;
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(qMax(1, mRasterizer->threadCount()));
+
+    for (int row = 0; row < rowCount(mMaxZoom); ++row)
+        threadPool.start(new BaseRowJob(this, row));
+    threadPool.waitForDone();
+
+    // Each level is built from the complete level below it
+    for (int zoom = mMaxZoom - 1; zoom >= 0 && !mError; --zoom) {
+        for (int row = 0; row < rowCount(zoom); ++row)
+            threadPool.start(new RowJob(this, zoom, row));
+        threadPool.waitForDone();
+    }
+
+    if (mError)
+        return false;
+
+    // Remove tiles that became empty
+    QHash<QString, QByteArray>::const_iterator it = mOldHashes.constBegin();
+    for (; it != mOldHashes.constEnd(); ++it)
+        if (!mNewHashes.contains(it.key()))
+            QFile::remove(mDirectory.filePath(it.key() + QLatin1String(".png")));
+
+    qWarning().nospace() << "Wrote " << mTilesWritten << " tiles on "
+                         << mMaxZoom + 1 << " zoom levels, "
+                         << mTilesUnchanged << " tiles were unchanged";
+
+    return writeHashes();
+}
+
+/**
+ * Renders one row of tiles of the highest zoom level. The row is always
+ * rendered, only saving the tiles is skipped when their content did not
+ * change.
+ */
+void TilePyramid::renderBaseRow(int row)
+{
+    QImage band(mColumns * TileSize, TileSize,
+                QImage::Format_ARGB32_Premultiplied);
+    mRasterizer->drawBand(band, row * TileSize);
+
+    for (int column = 0; column < mColumns; ++column) {
+        const QImage tile = band.copy(column * TileSize, 0, TileSize, TileSize);
+        if (isEmptyTile(tile))
+            continue;
+
+        updateTile(mMaxZoom, column, row, tile, contentHash(tile));
+    }
+}
+
+/**
+ * Creates one row of tiles of the given \a zoom level by downsampling the
+ * tiles of the level below.
+ */
+void TilePyramid::renderRow(int zoom, int row)
+{
+    for (int column = 0; column < columnCount(zoom); ++column) {
+        QByteArray childHashes[4];
+        bool hasChildren = false;
+
+        for (int i = 0; i < 4; ++i) {
+            const int childX = column * 2 + (i & 1);
+            const int childY = row * 2 + (i >> 1);
+            childHashes[i] = newHash(tileKey(zoom + 1, childX, childY));
+            hasChildren |= !childHashes[i].isEmpty();
+        }
+
+        if (!hasChildren)
+            continue;
+
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        for (int i = 0; i < 4; ++i) {
+            hash.addData(childHashes[i]);
+            hash.addData("\n", 1);
+        }
+        const QByteArray tileHash = hash.result().toHex();
+
+        if (isUnchanged(zoom, column, row, tileHash)) {
+            keepTile(tileKey(zoom, column, row), tileHash);
+            continue;
+        }
+
+        QImage children(TileSize * 2, TileSize * 2,
+                        QImage::Format_ARGB32_Premultiplied);
+        children.fill(Qt::transparent);
+
+        QPainter painter(&children);
+        for (int i = 0; i < 4; ++i) {
+            if (childHashes[i].isEmpty())
+                continue;
+
+            const int childX = column * 2 + (i & 1);
+            const int childY = row * 2 + (i >> 1);
+            painter.drawImage((i & 1) * TileSize, (i >> 1) * TileSize,
+                              QImage(tilePath(zoom + 1, childX, childY)));
+        }
+        painter.end();
+
+        const QImage tile = children.scaled(TileSize, TileSize,
+                                            Qt::IgnoreAspectRatio,
+                                            Qt::SmoothTransformation);
+        updateTile(zoom, column, row, tile, tileHash);
+    }
+}
+
+QString TilePyramid::tilePath(int zoom, int x, int y) const
+{
+    return mDirectory.filePath(tileKey(zoom, x, y) + QLatin1String(".png"));
+}
+
+QString TilePyramid::tileKey(int zoom, int x, int y)
+{
+    return QString(QLatin1String("%1/%2/%3")).arg(zoom).arg(x).arg(y);
+}
+
+bool TilePyramid::readHashes()
+{
+    QFile file(mDirectory.filePath(QLatin1String(HashFileName)));
+    if (!file.exists())
+        return true;
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qWarning().nospace() << "Error while reading " << file.fileName();
+        return false;
+    }
+
+    while (!file.atEnd()) {
+        const QList<QByteArray> parts = file.readLine().trimmed().split(' ');
+        if (parts.size() == 2)
+            mOldHashes.insert(QString::fromLatin1(parts.at(0)), parts.at(1));
+    }
+
+    return true;
+}
+
+bool TilePyramid::writeHashes()
+{
+    QFile file(mDirectory.filePath(QLatin1String(HashFileName)));
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qWarning().nospace() << "Error while writing " << file.fileName();
+        return false;
+    }
+
+    QTextStream stream(&file);
+    QHash<QString, QByteArray>::const_iterator it = mNewHashes.constBegin();
+    for (; it != mNewHashes.constEnd(); ++it)
+        stream << it.key() << ' ' << it.value() << '\n';
+
+    stream.flush();
+    return file.error() == QFile::NoError;
+}
+
+QByteArray TilePyramid::newHash(const QString &key)
+{
+    QMutexLocker locker(&mMutex);
+    return mNewHashes.value(key);
+}
+
+void TilePyramid::updateTile(int zoom, int x, int y, const QImage &tile,
+                             const QByteArray &hash)
+{
+    const QString key = tileKey(zoom, x, y);
+
+    if (isUnchanged(zoom, x, y, hash)) {
+        keepTile(key, hash);
+        return;
+    }
+
+    const QString path = tilePath(zoom, x, y);
+    QDir().mkpath(QFileInfo(path).path());
+
+    const bool saved = tile.save(path, "PNG");
+
+    QMutexLocker locker(&mMutex);
+    if (saved) {
+        mNewHashes.insert(key, hash);
+        ++mTilesWritten;
+    } else {
+        qWarning().nospace() << "Error while writing " << path;
+        mError = true;
+    }
+}
+
+bool TilePyramid::isUnchanged(int zoom, int x, int y,
+                              const QByteArray &hash) const
+{
+    // The old hashes are not modified while rendering
+    return mOldHashes.value(tileKey(zoom, x, y)) == hash &&
+            QFile::exists(tilePath(zoom, x, y));
+}
+
+void TilePyramid::keepTile(const QString &key, const QByteArray &hash)
+{
+    QMutexLocker locker(&mMutex);
+    mNewHashes.insert(key, hash);
+    ++mTilesUnchanged;
+}
+
+int TilePyramid::columnCount(int zoom) const
+{
+    const int shift = mMaxZoom - zoom;
+    return (mColumns + (1 << shift) - 1) >> shift;
+}
+
+int TilePyramid::rowCount(int zoom) const
+{
+    const int shift = mMaxZoom - zoom;
+    return (mRows + (1 << shift) - 1) >> shift;
+}
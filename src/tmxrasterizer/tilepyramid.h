@@ -0,0 +1,98 @@
+/*
+ * tilepyramid.h
+ * Copyright 2016, David Stammer
+ *
+ * This file is part of the TMX Rasterizer.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ *    1. Redistributions of source code must retain the above copyright notice,
+ *       this list of conditions and the following disclaimer.
+ *
+ *    2. Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE CONTRIBUTORS ``AS IS'' AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO
+ * EVENT SHALL THE CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+ * PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS;
+ * OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR
+ * OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF
+ * ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef TILEPYRAMID_H
+#define TILEPYRAMID_H
+
+#include <QByteArray>
+#include <QDir>
+#include <QHash>
+#include <QImage>
+#include <QMutex>
+#include <QString>
+
+class TmxRasterizer;
+
+/**
+ * Writes a map as a pyramid of 256x256 pixel image tiles, stored as
+ * z/x/y.png like the tiles of slippy maps.
+ *
+ * Only the highest zoom level is rendered. Each lower level is downsampled
+ * from the four tiles below it. Fully transparent tiles are skipped.
+ *
+ * A content hash of every tile is kept in the output directory. When the
+ * pyramid is written again, only the tiles that changed are written, and
+ * lower levels are only downsampled where any of the tiles below changed.
+ *
+ * The highest zoom level is always rendered completely, since the hashes
+ * are taken from the rendered tiles. Writing the pyramid again therefore
+ * saves the encoding and downsampling, but not the rendering of the map.
+ */
+class TilePyramid
+{
+public:
+    static const int TileSize = 256;
+
+    TilePyramid(const TmxRasterizer *rasterizer, const QString &directory);
+
+    bool render();
+
+    void renderBaseRow(int row);
+    void renderRow(int zoom, int row);
+
+private:
+    QString tilePath(int zoom, int x, int y) const;
+    static QString tileKey(int zoom, int x, int y);
+
+    bool readHashes();
+    bool writeHashes();
+
+    QByteArray newHash(const QString &key);
+    void updateTile(int zoom, int x, int y, const QImage &tile,
+                    const QByteArray &hash);
+    bool isUnchanged(int zoom, int x, int y, const QByteArray &hash) const;
+    void keepTile(const QString &key, const QByteArray &hash);
+
+    int columnCount(int zoom) const;
+    int rowCount(int zoom) const;
+
+    const TmxRasterizer *mRasterizer;
+    QDir mDirectory;
+    int mMaxZoom;
+    int mColumns;
+    int mRows;
+
+    QHash<QString, QByteArray> mOldHashes;
+    QHash<QString, QByteArray> mNewHashes;
+    QMutex mMutex;
+    int mTilesWritten;
+    int mTilesUnchanged;
+    bool mError;
+};
+
+#endif // TILEPYRAMID_H
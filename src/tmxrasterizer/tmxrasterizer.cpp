@@ -35,19 +35,112 @@
 #include "mapreader.h"
 #include "objectgroup.h"
 #include "orthogonalrenderer.h"
+#include "pngstreamwriter.h"
 #include "staggeredrenderer.h"
 #include "tilelayer.h"
-
+#include "tilepyramid.h"
+#include "tilesetcache.h"
 
 #include <QDebug>
+#include <QFileInfo>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QRunnable>
+#include <QScopedPointer>
+#include <QThread>
+#include <QThreadPool>
+#include <QWaitCondition>
 
 using namespace Tiled;
 
+namespace {
+
+/**
+ * Collects the rendered bands, so that they can be written in order.
+ */
+class BandQueue
+{
+public:
+    void add(int index, const QImage &band)
+    {
+        QMutexLocker locker(&mMutex);
+        mBands.insert(index, band);
+        mBandAdded.wakeAll();
+    }
+
+    QImage take(int index)
+    {
+        QMutexLocker locker(&mMutex);
+        while (!mBands.contains(index))
+            mBandAdded.wait(&mMutex);
+        return mBands.take(index);
+    }
+
+private:
+    QMutex mMutex;
+    QWaitCondition mBandAdded;
+    QMap<int, QImage> mBands;
+};
+
+} // anonymous namespace
+
+/**
+ * Renders one horizontal band of the output image. Either into a part of
+ * a larger image, or into its own image that is passed on to a queue.
+ */
+class BandJob : public QRunnable
+{
+public:
+    BandJob(const TmxRasterizer *rasterizer, uchar *bits, int width,
+            int height, int bytesPerLine, int top)
+        : mRasterizer(rasterizer)
+        , mBand(bits, width, height, bytesPerLine,
+                QImage::Format_ARGB32_Premultiplied)
+        , mTop(top)
+        , mQueue(0)
+        , mIndex(0)
+    {}
+
+    BandJob(const TmxRasterizer *rasterizer, int width, int height, int top,
+            BandQueue *queue, int index)
+        : mRasterizer(rasterizer)
+        , mBand(width, height, QImage::Format_ARGB32_Premultiplied)
+        , mTop(top)
+        , mQueue(queue)
+        , mIndex(index)
+    {}
+
+    void run() override
+    {
+        mRasterizer->drawBand(mBand, mTop);
+
+        if (mQueue)
+            mQueue->add(mIndex, mBand.convertToFormat(QImage::Format_ARGB32));
+    }
+
+private:
+    const TmxRasterizer *mRasterizer;
+    QImage mBand;
+    int mTop;
+    BandQueue *mQueue;
+    int mIndex;
+};
+
+
 TmxRasterizer::TmxRasterizer():
     mScale(1.0),
     mTileSize(0),
     mUseAntiAliasing(true),
-    mIgnoreVisibility(false)
+    mIgnoreVisibility(false),
+    mBandHeight(256),
+    mThreadCount(QThread::idealThreadCount()),
+    mTilesetCache(0),
+    mMap(0),
+    mRenderer(0),
+    mXScale(1.0),
+    mYScale(1.0)
 {
 }
 
@@ -55,7 +148,7 @@ TmxRasterizer::~TmxRasterizer()
 {
 }
 
-bool TmxRasterizer::shouldDrawLayer(Layer *layer)
+bool TmxRasterizer::shouldDrawLayer(const Layer *layer) const
 {
     if (layer->isObjectGroup())
         return false;
@@ -72,58 +165,229 @@ bool TmxRasterizer::shouldDrawLayer(Layer *layer)
 int TmxRasterizer::render(const QString &mapFileName,
                           const QString &imageFileName)
 {
-    Map *map;
-    MapRenderer *renderer;
-    MapReader reader;
-    map = reader.readMap(mapFileName);
-    if (!map) {
-        qWarning().nospace() << "Error while reading " << mapFileName << ":\n"
-                             << qPrintable(reader.errorString());
+    if (!loadMap(mapFileName))
+        return 1;
+
+    // PNG images can be written while they are being rendered, so they never
+    // need to be in memory as a whole
+    bool success;
+    if (QFileInfo(imageFileName).suffix().compare(QLatin1String("png"),
+                                                  Qt::CaseInsensitive) == 0)
+        success = renderToPng(mImageSize, imageFileName);
+    else
+        success = renderToImage(mImageSize, imageFileName);
+
+    unloadMap();
+
+    return success ? 0 : 1;
+}
+
+int TmxRasterizer::renderPyramid(const QString &mapFileName,
+                                 const QString &directory)
+{
+    if (!loadMap(mapFileName))
         return 1;
+
+    TilePyramid pyramid(this, directory);
+    const bool success = pyramid.render();
+
+    unloadMap();
+
+    return success ? 0 : 1;
+}
+
+bool TmxRasterizer::loadMap(const QString &mapFileName)
+{
+    mTilesetFiles.clear();
+    mImageFiles.clear();
+
+    // Share the external tilesets between maps when rendering a batch
+    QScopedPointer<MapReader> reader(mTilesetCache ? new CachedMapReader(mTilesetCache)
+                                                   : new MapReader);
+
+    mMap = reader->readMap(mapFileName);
+    if (!mMap) {
+        qWarning().nospace() << "Error while reading " << mapFileName << ":\n"
+                             << qPrintable(reader->errorString());
+        return false;
+    }
+
+    foreach (const SharedTileset &tileset, mMap->tilesets()) {
+        if (!tileset->fileName().isEmpty())
+            mTilesetFiles.append(tileset->fileName());
+        if (!tileset->imageSource().isEmpty())
+            mImageFiles.append(tileset->imageSource());
+    }
+    foreach (const Layer *layer, mMap->layers()) {
+        if (const ImageLayer *imageLayer = dynamic_cast<const ImageLayer*>(layer))
+            if (!imageLayer->imageSource().isEmpty())
+                mImageFiles.append(imageLayer->imageSource());
     }
 
-    switch (map->orientation()) {
+    switch (mMap->orientation()) {
     case Map::Isometric:
-        renderer = new IsometricRenderer(map);
+        mRenderer = new IsometricRenderer(mMap);
         break;
     case Map::Staggered:
-        renderer = new StaggeredRenderer(map);
+        mRenderer = new StaggeredRenderer(mMap);
         break;
     case Map::Hexagonal:
-        renderer = new HexagonalRenderer(map);
+        mRenderer = new HexagonalRenderer(mMap);
         break;
     case Map::Orthogonal:
     default:
-        renderer = new OrthogonalRenderer(map);
+        mRenderer = new OrthogonalRenderer(mMap);
         break;
     }
 
-    qreal xScale, yScale;
-
     if (mTileSize > 0) {
-        xScale = (qreal) mTileSize / map->tileWidth();
-        yScale = (qreal) mTileSize / map->tileHeight();
+        mXScale = (qreal) mTileSize / mMap->tileWidth();
+        mYScale = (qreal) mTileSize / mMap->tileHeight();
     } else {
-        xScale = yScale = mScale;
+        mXScale = mYScale = mScale;
+    }
+
+    mImageSize = mRenderer->mapSize();
+    mImageSize.rwidth() *= mXScale;
+    mImageSize.rheight() *= mYScale;
+
+    return true;
+}
+
+void TmxRasterizer::unloadMap()
+{
+    delete mRenderer;
+    delete mMap;
+    mRenderer = 0;
+    mMap = 0;
+}
+
+/**
+ * Renders the whole image at once, with each thread painting its own bands
+ * of it.
+ */
+bool TmxRasterizer::renderToImage(const QSize &imageSize,
+                                  const QString &imageFileName)
+{
+    QImage image(imageSize, QImage::Format_ARGB32_Premultiplied);
+    if (image.isNull()) {
+        qWarning().nospace() << "Could not allocate an image of size "
+                             << imageSize.width() << "x" << imageSize.height();
+        return false;
+    }
+
+    const int bandHeight = mBandHeight > 0 ? mBandHeight : imageSize.height();
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(qMax(1, mThreadCount));
+
+    for (int top = 0; top < imageSize.height(); top += bandHeight) {
+        const int height = qMin(bandHeight, imageSize.height() - top);
+
+        // The band refers to the rows of the image, without copying them
+        threadPool.start(new BandJob(this, image.scanLine(top), image.width(),
+                                     height, image.bytesPerLine(), top));
+    }
+
+    threadPool.waitForDone();
+
+    if (!image.save(imageFileName)) {
+        qWarning().nospace() << "Error while writing " << imageFileName;
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Renders the image in bands, which are written to the PNG file in order as
+ * they become available. Only a limited number of bands is rendered ahead,
+ * which bounds the memory use.
+ */
+bool TmxRasterizer::renderToPng(const QSize &imageSize,
+                                const QString &imageFileName)
+{
+    PngStreamWriter writer;
+    if (!writer.open(imageFileName, imageSize.width(), imageSize.height())) {
+        qWarning().nospace() << "Error while writing " << imageFileName << ":\n"
+                             << qPrintable(writer.errorString());
+        return false;
+    }
+
+    const int bandHeight = mBandHeight > 0 ? mBandHeight : imageSize.height();
+    const int bandCount = (imageSize.height() + bandHeight - 1) / bandHeight;
+    const int threadCount = qMax(1, mThreadCount);
+    const int bandsAhead = threadCount * 2;
+
+    // Declared before the thread pool, so that the jobs are done adding
+    // their bands by the time the queue is destroyed
+    BandQueue queue;
+
+    QThreadPool threadPool;
+    threadPool.setMaxThreadCount(threadCount);
+
+    int bandsStarted = 0;
+
+    for (int index = 0; index < bandCount; ++index) {
+        while (bandsStarted < bandCount && bandsStarted <= index + bandsAhead) {
+            const int top = bandsStarted * bandHeight;
+            const int height = qMin(bandHeight, imageSize.height() - top);
+
+            threadPool.start(new BandJob(this, imageSize.width(), height, top,
+                                         &queue, bandsStarted));
+            ++bandsStarted;
+        }
+
+        const QImage band = queue.take(index);
+
+        for (int y = 0; y < band.height(); ++y) {
+            const QRgb *row = reinterpret_cast<const QRgb*>(band.constScanLine(y));
+            if (!writer.writeRow(row)) {
+                threadPool.waitForDone();
+                qWarning().nospace() << "Error while writing " << imageFileName
+                                     << ":\n" << qPrintable(writer.errorString());
+                return false;
+            }
+        }
     }
 
-    QSize mapSize = renderer->mapSize();
-    mapSize.rwidth() *= xScale;
-    mapSize.rheight() *= yScale;
+    if (!writer.close()) {
+        qWarning().nospace() << "Error while writing " << imageFileName << ":\n"
+                             << qPrintable(writer.errorString());
+        return false;
+    }
 
-    QImage image(mapSize, QImage::Format_ARGB32);
-    image.fill(Qt::transparent);
-    QPainter painter(&image);
+    return true;
+}
+
+/**
+ * Draws the part of the map that ends up in the rows starting at \a top of
+ * the output image into the given \a band.
+ *
+ * Called from several threads at once. This is safe because each thread
+ * paints on its own QImage and the map is not modified while rendering.
+ */
+void TmxRasterizer::drawBand(QImage &band, int top) const
+{
+    band.fill(Qt::transparent);
+    QPainter painter(&band);
 
-    if (xScale != qreal(1) || yScale != qreal(1)) {
+    if (mXScale != qreal(1) || mYScale != qreal(1)) {
         if (mUseAntiAliasing) {
             painter.setRenderHints(QPainter::SmoothPixmapTransform |
                                    QPainter::Antialiasing);
         }
-        painter.setTransform(QTransform::fromScale(xScale, yScale));
     }
+
+    painter.setTransform(QTransform::fromScale(mXScale, mYScale) *
+                         QTransform::fromTranslate(0, -top));
+
+    // Only the tiles that may end up in this band need to be drawn
+    const QRectF exposed(0, top / mYScale,
+                         band.width() / mXScale, band.height() / mYScale);
+
     // Perform a similar rendering than found in exportasimagedialog.cpp
-    foreach (Layer *layer, map->layers()) {
+    foreach (const Layer *layer, mMap->layers()) {
 
         if (!shouldDrawLayer(layer)) 
             continue;
@@ -135,17 +399,9 @@ int TmxRasterizer::render(const QString &mapFileName,
         const ImageLayer *imageLayer = dynamic_cast<const ImageLayer*>(layer);
 
         if (tileLayer) {
-            renderer->drawTileLayer(&painter, tileLayer);
+            mRenderer->drawTileLayer(&painter, tileLayer, exposed);
         } else if (imageLayer) {
-            renderer->drawImageLayer(&painter, imageLayer);
+            mRenderer->drawImageLayer(&painter, imageLayer, exposed);
         }
     }
-
-    // Save image
-    image.save(imageFileName);
-
-    delete renderer;
-    delete map;
-
-    return 0;
 }
@@ -31,9 +31,16 @@
 
 #include "layer.h"
 
+#include <QImage>
 #include <QString>
 #include <QStringList>
 
+namespace Tiled {
+class Map;
+class MapRenderer;
+class TilesetCache;
+}
+
 using namespace Tiled;
 
 class TmxRasterizer
@@ -47,25 +54,63 @@ public:
     int tileSize() const { return mTileSize; }
     bool useAntiAliasing() const { return mUseAntiAliasing; }
     bool IgnoreVisibility() const { return mIgnoreVisibility; }
+    int bandHeight() const { return mBandHeight; }
+    int threadCount() const { return mThreadCount; }
 
     void setScale(qreal scale) { mScale = scale; }
     void setTileSize(int tileSize) { mTileSize = tileSize; }
     void setAntiAliasing(bool useAntiAliasing) { mUseAntiAliasing = useAntiAliasing; }
     void setIgnoreVisibility(bool IgnoreVisibility) { mIgnoreVisibility = IgnoreVisibility; }
+    void setBandHeight(int bandHeight) { mBandHeight = bandHeight; }
+    void setThreadCount(int threadCount) { mThreadCount = threadCount; }
 
     void setLayersToHide(QStringList layersToHide) { mLayersToHide = layersToHide; }
 
+    /**
+     * Sets a cache through which external tilesets are read, so that they
+     * can be shared with other rasterizers. The cache is not owned.
+     */
+    void setTilesetCache(TilesetCache *cache) { mTilesetCache = cache; }
+
+    /**
+     * The external tilesets and images used by the last rendered map.
+     */
+    const QStringList &tilesetFiles() const { return mTilesetFiles; }
+    const QStringList &imageFiles() const { return mImageFiles; }
+
     int render(const QString &mapFileName, const QString &imageFileName);
+    int renderPyramid(const QString &mapFileName, const QString &directory);
+
+    void drawBand(QImage &band, int top) const;
+
+    QSize imageSize() const { return mImageSize; }
 
 private:
     qreal mScale;
     int mTileSize;
     bool mUseAntiAliasing;
     bool mIgnoreVisibility;
+    int mBandHeight;
+    int mThreadCount;
     QStringList mLayersToHide;
+    TilesetCache *mTilesetCache;
+    QStringList mTilesetFiles;
+    QStringList mImageFiles;
+
+    // Only valid while rendering
+    Map *mMap;
+    MapRenderer *mRenderer;
+    qreal mXScale;
+    qreal mYScale;
+    QSize mImageSize;
+
+    bool loadMap(const QString &mapFileName);
+    void unloadMap();
 
-    bool shouldDrawLayer(Layer *layer);
+    bool shouldDrawLayer(const Layer *layer) const;
 
+    bool renderToImage(const QSize &imageSize, const QString &imageFileName);
+    bool renderToPng(const QSize &imageSize, const QString &imageFileName);
 };
 
 #endif // TMXRASTERIZER_H
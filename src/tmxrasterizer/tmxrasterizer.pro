@@ -22,6 +22,15 @@ macx {
     QMAKE_LIBDIR = $$OUT_PWD/../../lib $$QMAKE_LIBDIR
 }
 
+win32 {
+    lessThan(QT_MAJOR_VERSION, 5) {
+        INCLUDEPATH += ../zlib
+    }
+} else {
+    # The PNG writer uses zlib directly
+    LIBS += -lz
+}
+
 # Make sure the executable can find libtiled
 !win32:!macx:contains(RPATH, yes) {
     QMAKE_RPATHDIR += \$\$ORIGIN/../lib
@@ -31,10 +40,16 @@ macx {
     QMAKE_RPATHDIR =
 }
 
-SOURCES += main.cpp \
+SOURCES += batchrasterizer.cpp \
+         main.cpp \
+         pngstreamwriter.cpp \
+         tilepyramid.cpp \
          tmxrasterizer.cpp
 
-HEADERS += tmxrasterizer.h
+HEADERS += batchrasterizer.h \
+         pngstreamwriter.h \
+         tilepyramid.h \
+         tmxrasterizer.h
 
 manpage.path = $${PREFIX}/share/man/man1/
 manpage.files += ../../man/tmxrasterizer.1
@@ -0,0 +1,182 @@
+#include "binarymapreader.h"
+#include "binarymapwriter.h"
+#include "map.h"
+#include "mapobject.h"
+#include "objectgroup.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QBuffer>
+#include <QtEndian>
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+
+/**
+ * Writes a map in the binary format and reads it back.
+ */
+class test_BinaryMap : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void roundTrip();
+    void truncatedData();
+    void corruptTileLayerSize();
+
+private:
+    QByteArray mData;
+    Map *mMap;
+};
+
+void test_BinaryMap::initTestCase()
+{
+    mMap = new Map(Map::Orthogonal, 40, 30, 32, 32);
+    mMap->setProperty(QLatin1String("author"), QLatin1String("test"));
+
+    SharedTileset tileset = Tileset::create(QLatin1String("Tiles"), 32, 32);
+    for (int i = 0; i < 4; ++i) {
+        QPixmap pixmap(32, 32);
+        pixmap.fill(QColor::fromHsv(i * 90, 255, 255));
+        tileset->addTile(pixmap);
+    }
+    mMap->addTileset(tileset);
+
+    // The unusual position makes the layer header easy to find in the data
+    TileLayer *tileLayer = new TileLayer(QLatin1String("Ground"), 2, 3, 40, 30);
+    for (int y = 0; y < tileLayer->height(); ++y) {
+        for (int x = 0; x < tileLayer->width(); ++x) {
+            if ((x + y) % 5 == 0)
+                continue;
+
+            Cell cell(tileset->tileAt((x * 3 + y) % 4));
+            cell.flippedHorizontally = x % 7 == 0;
+            cell.flippedVertically = y % 11 == 0;
+            tileLayer->setCell(x, y, cell);
+        }
+    }
+    mMap->addLayer(tileLayer);
+
+    ObjectGroup *objectGroup = new ObjectGroup(QLatin1String("Objects"),
+                                               0, 0, 40, 30);
+    mMap->addLayer(objectGroup);
+
+    for (int i = 0; i < 3; ++i) {
+        MapObject *mapObject = new MapObject(QString::number(i),
+                                             QLatin1String("Type"),
+                                             QPointF(i * 32, i * 16),
+                                             QSizeF(32, 32));
+        objectGroup->addObject(mapObject);
+    }
+
+    QBuffer buffer(&mData);
+    buffer.open(QIODevice::WriteOnly);
+
+    BinaryMapWriter writer;
+    QVERIFY2(writer.writeMap(mMap, &buffer), qPrintable(writer.errorString()));
+    QVERIFY(BinaryMapReader::isBinaryMap(mData));
+}
+
+void test_BinaryMap::cleanupTestCase()
+{
+    delete mMap;
+}
+
+void test_BinaryMap::roundTrip()
+{
+    BinaryMapReader reader;
+    QScopedPointer<Map> map(reader.readMap(mData));
+    QVERIFY2(map, qPrintable(reader.errorString()));
+
+    QCOMPARE(map->width(), mMap->width());
+    QCOMPARE(map->height(), mMap->height());
+    QCOMPARE(map->tileWidth(), mMap->tileWidth());
+    QCOMPARE(map->tileHeight(), mMap->tileHeight());
+    QCOMPARE(map->property(QLatin1String("author")), QLatin1String("test"));
+    QCOMPARE(map->nextObjectId(), mMap->nextObjectId());
+    QCOMPARE(map->tilesetCount(), 1);
+    QCOMPARE(map->tilesetAt(0)->tileCount(), 4);
+    QCOMPARE(map->layerCount(), 2);
+
+    const TileLayer *expectedLayer = mMap->layerAt(0)->asTileLayer();
+    const TileLayer *tileLayer = map->layerAt(0)->asTileLayer();
+    QVERIFY(tileLayer);
+    QCOMPARE(tileLayer->name(), expectedLayer->name());
+    QCOMPARE(tileLayer->bounds(), expectedLayer->bounds());
+
+    for (int y = 0; y < tileLayer->height(); ++y) {
+        for (int x = 0; x < tileLayer->width(); ++x) {
+            const Cell &expected = expectedLayer->cellAt(x, y);
+            const Cell &cell = tileLayer->cellAt(x, y);
+
+            QCOMPARE(cell.isEmpty(), expected.isEmpty());
+            if (expected.isEmpty())
+                continue;
+
+            QCOMPARE(cell.tile->id(), expected.tile->id());
+            QCOMPARE(cell.flippedHorizontally, expected.flippedHorizontally);
+            QCOMPARE(cell.flippedVertically, expected.flippedVertically);
+        }
+    }
+
+    const ObjectGroup *expectedGroup = mMap->layerAt(1)->asObjectGroup();
+    const ObjectGroup *objectGroup = map->layerAt(1)->asObjectGroup();
+    QVERIFY(objectGroup);
+    QCOMPARE(objectGroup->objectCount(), expectedGroup->objectCount());
+
+    for (int i = 0; i < objectGroup->objectCount(); ++i) {
+        const MapObject *expected = expectedGroup->objectAt(i);
+        const MapObject *mapObject = objectGroup->objectAt(i);
+
+        QCOMPARE(mapObject->id(), expected->id());
+        QCOMPARE(mapObject->name(), expected->name());
+        QCOMPARE(mapObject->type(), expected->type());
+        QCOMPARE(mapObject->position(), expected->position());
+        QCOMPARE(mapObject->size(), expected->size());
+    }
+}
+
+void test_BinaryMap::truncatedData()
+{
+    // Every truncation should be reported as an error, without crashing
+    for (int size = 0; size < mData.size(); size += 7) {
+        BinaryMapReader reader;
+        QScopedPointer<Map> map(reader.readMap(mData.left(size)));
+        QVERIFY(!map);
+        QVERIFY(!reader.errorString().isEmpty());
+    }
+}
+
+void test_BinaryMap::corruptTileLayerSize()
+{
+    // Find the position and size of the tile layer (2, 3, 40, 30)
+    QByteArray header(16, 0);
+    qToLittleEndian<qint32>(2, reinterpret_cast<uchar*>(header.data()));
+    qToLittleEndian<qint32>(3, reinterpret_cast<uchar*>(header.data() + 4));
+    qToLittleEndian<qint32>(40, reinterpret_cast<uchar*>(header.data() + 8));
+    qToLittleEndian<qint32>(30, reinterpret_cast<uchar*>(header.data() + 12));
+
+    const int index = mData.indexOf(header);
+    QVERIFY(index != -1);
+
+    // A size that does not fit in the file must not be allocated
+    QByteArray data = mData;
+    qToLittleEndian<qint32>(0x7fffffff, reinterpret_cast<uchar*>(data.data() + index + 8));
+    qToLittleEndian<qint32>(0x7fffffff, reinterpret_cast<uchar*>(data.data() + index + 12));
+
+    BinaryMapReader reader;
+    QScopedPointer<Map> map(reader.readMap(data));
+    QVERIFY(!map);
+    QVERIFY(!reader.errorString().isEmpty());
+
+    qToLittleEndian<qint32>(-1, reinterpret_cast<uchar*>(data.data() + index + 8));
+
+    map.reset(reader.readMap(data));
+    QVERIFY(!map);
+}
+
+QTEST_MAIN(test_BinaryMap)
+#include "test_binarymap.moc"
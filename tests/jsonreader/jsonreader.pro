@@ -0,0 +1,30 @@
+include(../../src/libtiled/libtiled.pri)
+
+CONFIG += qtestlib
+TEMPLATE = app
+
+macx {
+    LIBS += -L$$OUT_PWD/../../bin/Tiled.app/Contents/Frameworks
+} else {
+    LIBS += -L$$OUT_PWD/../../lib
+}
+
+!win32:!macx {
+    QMAKE_RPATHDIR += \$\$ORIGIN/../../lib
+
+    # It is not possible to use ORIGIN in QMAKE_RPATHDIR, so a bit manually
+    QMAKE_LFLAGS += -Wl,-z,origin \'-Wl,-rpath,$$join(QMAKE_RPATHDIR, ":")\'
+    QMAKE_RPATHDIR =
+}
+
+JSONPLUGINDIR = $$PWD/../../src/plugins/json
+INCLUDEPATH += $$JSONPLUGINDIR
+
+# Input
+SOURCES += test_jsonreader.cpp \
+    $$JSONPLUGINDIR/jsonmapreader.cpp \
+    $$JSONPLUGINDIR/jsonstreamreader.cpp \
+    $$JSONPLUGINDIR/jsonstreamwriter.cpp \
+    $$JSONPLUGINDIR/maptojsonwriter.cpp \
+    $$JSONPLUGINDIR/varianttomapconverter.cpp \
+    $$JSONPLUGINDIR/qjsonparser/json.cpp
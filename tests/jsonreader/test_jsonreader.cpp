@@ -0,0 +1,240 @@
+#include "jsonmapreader.h"
+#include "jsonstreamwriter.h"
+#include "maptojsonwriter.h"
+#include "varianttomapconverter.h"
+
+#include "qjsonparser/json.h"
+
+#include "map.h"
+#include "tilelayer.h"
+#include "tileset.h"
+
+#include <QBuffer>
+#include <QtTest/QtTest>
+
+using namespace Tiled;
+using namespace Json;
+
+/**
+ * Compares the streaming JsonMapReader with reading through JsonReader and
+ * VariantToMapConverter.
+ *
+ * The size of the generated map can be changed by setting the
+ * TILED_JSON_BENCHMARK_SIZE environment variable. A size of 3600 results in
+ * a document of roughly 100 MB.
+ */
+class test_JsonReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void compareReaders();
+    void compressedLayerData_data();
+    void compressedLayerData();
+    void corruptLayerSize_data();
+    void corruptLayerSize();
+
+    void benchmarkVariantReader();
+    void benchmarkStreamReader();
+
+private:
+    Map *mMap;
+    QByteArray mData;
+};
+
+/**
+ * Compares the size, layers and cells of two maps. Since failures only
+ * return from this function, callers need to check
+ * QTest::currentTestFailed() before going on.
+ */
+static void compareMaps(const Map *expected, const Map *actual)
+{
+    QVERIFY(actual);
+    QCOMPARE(actual->width(), expected->width());
+    QCOMPARE(actual->height(), expected->height());
+    QCOMPARE(actual->layerCount(), expected->layerCount());
+    QCOMPARE(actual->tilesetCount(), expected->tilesetCount());
+
+    for (int i = 0; i < expected->layerCount(); ++i) {
+        const TileLayer *expectedLayer = expected->layerAt(i)->asTileLayer();
+        const TileLayer *actualLayer = actual->layerAt(i)->asTileLayer();
+
+        QVERIFY(actualLayer);
+        QCOMPARE(actualLayer->name(), expectedLayer->name());
+
+        for (int y = 0; y < expectedLayer->height(); ++y) {
+            for (int x = 0; x < expectedLayer->width(); ++x) {
+                const Cell &expectedCell = expectedLayer->cellAt(x, y);
+                const Cell &actualCell = actualLayer->cellAt(x, y);
+
+                QCOMPARE(actualCell.isEmpty(), expectedCell.isEmpty());
+                if (expectedCell.isEmpty())
+                    continue;
+
+                QCOMPARE(actualCell.tile->id(), expectedCell.tile->id());
+                QCOMPARE(actualCell.flippedHorizontally, expectedCell.flippedHorizontally);
+            }
+        }
+    }
+}
+
+void test_JsonReader::initTestCase()
+{
+    int size = qgetenv("TILED_JSON_BENCHMARK_SIZE").toInt();
+    if (size <= 0)
+        size = 256;
+
+    mMap = new Map(Map::Orthogonal, size, size, 32, 32);
+
+    SharedTileset tileset = Tileset::create(QLatin1String("Tiles"), 32, 32);
+    for (int i = 0; i < 64; ++i)
+        tileset->addTile(QPixmap());
+    mMap->addTileset(tileset);
+
+    for (int i = 0; i < 2; ++i) {
+        TileLayer *tileLayer = new TileLayer(QString::number(i), 0, 0,
+                                             size, size);
+
+        for (int y = 0; y < size; ++y) {
+            for (int x = 0; x < size; ++x) {
+                const int id = (x * 7 + y * 3 + i) % 65;
+                if (id == 64)
+                    continue;
+
+                Cell cell(tileset->tileAt(id));
+                cell.flippedHorizontally = (x + y) % 13 == 0;
+                tileLayer->setCell(x, y, cell);
+            }
+        }
+
+        mMap->addLayer(tileLayer);
+    }
+
+    QBuffer buffer(&mData);
+    buffer.open(QIODevice::WriteOnly);
+
+    JsonStreamWriter writer(&buffer);
+    MapToJsonWriter mapWriter;
+    mapWriter.write(writer, mMap, QDir());
+    QVERIFY(writer.flush());
+}
+
+void test_JsonReader::cleanupTestCase()
+{
+    delete mMap;
+}
+
+void test_JsonReader::compareReaders()
+{
+    JsonReader reader;
+    QVERIFY(reader.parse(mData));
+
+    VariantToMapConverter converter;
+    QScopedPointer<Map> variantMap(converter.toMap(reader.result(), QDir()));
+    QVERIFY(variantMap);
+    compareMaps(mMap, variantMap.data());
+    if (QTest::currentTestFailed())
+        return;
+
+    JsonMapReader mapReader;
+    QScopedPointer<Map> streamMap(mapReader.read(mData, QDir()));
+    QVERIFY(streamMap);
+    compareMaps(mMap, streamMap.data());
+}
+
+void test_JsonReader::compressedLayerData_data()
+{
+    QTest::addColumn<int>("format");
+
+    QTest::newRow("base64") << int(Map::Base64);
+    QTest::newRow("zlib") << int(Map::Base64Zlib);
+    QTest::newRow("gzip") << int(Map::Base64Gzip);
+}
+
+void test_JsonReader::compressedLayerData()
+{
+    QFETCH(int, format);
+
+    const Map::LayerDataFormat previousFormat = mMap->layerDataFormat();
+    mMap->setLayerDataFormat(static_cast<Map::LayerDataFormat>(format));
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+
+    JsonStreamWriter writer(&buffer);
+    MapToJsonWriter mapWriter;
+    mapWriter.write(writer, mMap, QDir());
+    QVERIFY(writer.flush());
+
+    mMap->setLayerDataFormat(previousFormat);
+
+    JsonMapReader mapReader;
+    QScopedPointer<Map> map(mapReader.read(data, QDir()));
+    QVERIFY(map);
+    compareMaps(mMap, map.data());
+    if (QTest::currentTestFailed())
+        return;
+
+    QCOMPARE(int(map->layerDataFormat()), format);
+}
+
+void test_JsonReader::corruptLayerSize_data()
+{
+    QTest::addColumn<QByteArray>("layer");
+
+    QTest::newRow("negative") << QByteArray(
+            "\"width\":-1,\"height\":2,\"data\":[]");
+    QTest::newRow("overflow") << QByteArray(
+            "\"width\":100000,\"height\":100000,\"data\":[]");
+    QTest::newRow("plain") << QByteArray(
+            "\"width\":2,\"height\":2,\"data\":[0]");
+    QTest::newRow("zlib") << QByteArray(
+            "\"width\":10000,\"height\":10000,\"encoding\":\"base64\","
+            "\"compression\":\"zlib\",\"data\":\"eJwDAAAAAAE=\"");
+}
+
+/**
+ * Checks that a tile layer size that does not match its data is reported
+ * as an error, without allocating the claimed size.
+ */
+void test_JsonReader::corruptLayerSize()
+{
+    QFETCH(QByteArray, layer);
+
+    const QByteArray data =
+            "{\"orientation\":\"orthogonal\",\"width\":2,\"height\":2,"
+            "\"tilewidth\":32,\"tileheight\":32,\"tilesets\":[],"
+            "\"layers\":[{\"type\":\"tilelayer\",\"name\":\"Corrupt\","
+            "\"x\":0,\"y\":0," + layer + "}]}";
+
+    JsonMapReader mapReader;
+    QScopedPointer<Map> map(mapReader.read(data, QDir()));
+    QVERIFY(!map);
+    QVERIFY(mapReader.errorString().contains(QLatin1String("Corrupt")));
+}
+
+void test_JsonReader::benchmarkVariantReader()
+{
+    QBENCHMARK_ONCE {
+        JsonReader reader;
+        reader.parse(mData);
+
+        VariantToMapConverter converter;
+        delete converter.toMap(reader.result(), QDir());
+    }
+}
+
+void test_JsonReader::benchmarkStreamReader()
+{
+    QBENCHMARK_ONCE {
+        JsonMapReader mapReader;
+        delete mapReader.read(mData, QDir());
+    }
+}
+
+QTEST_MAIN(test_JsonReader)
+#include "test_jsonreader.moc"
@@ -3,7 +3,10 @@
 #include "objectgroup.h"
 #include "tilelayer.h"
 #include "mapreader.h"
+#include "mapwriter.h"
+#include "rtbmapobject.h"
 
+#include <QBuffer>
 #include <QtTest/QtTest>
 
 using namespace Tiled;
@@ -14,6 +17,7 @@ class test_MapReader : public QObject
 
 private slots:
     void loadMap();
+    void saveCopyKeepsObjectIds();
 };
 
 void test_MapReader::loadMap()
@@ -53,5 +57,75 @@ void test_MapReader::loadMap()
     QCOMPARE(mapObject->height(), qreal(64));
 }
 
+void test_MapReader::saveCopyKeepsObjectIds()
+{
+    Map map(Map::Orthogonal, 10, 10, 32, 32);
+
+    ObjectGroup *objectGroup = new ObjectGroup(QLatin1String("Objects"),
+                                               0, 0, 10, 10);
+    map.addLayer(objectGroup);
+
+    MapObject *target = new MapObject(QLatin1String("Target"), QString(),
+                                      QPointF(32, 32), QSizeF(32, 32));
+    target->setRTBMapObject(new RTBTarget);
+    objectGroup->addObject(target);
+
+    const QString targetId = QString::number(target->id());
+
+    MapObject *teleporter = new MapObject(QLatin1String("Teleporter"), QString(),
+                                          QPointF(64, 32), QSizeF(32, 32));
+    RTBTeleporter *rtbTeleporter = new RTBTeleporter;
+    rtbTeleporter->setTeleporterTarget(targetId);
+    teleporter->setRTBMapObject(rtbTeleporter);
+    objectGroup->addObject(teleporter);
+
+    MapObject *camera = new MapObject(QLatin1String("Camera"), QString(),
+                                      QPointF(96, 32), QSizeF(32, 32));
+    RTBCameraTrigger *rtbCamera = new RTBCameraTrigger;
+    rtbCamera->setTarget(targetId);
+    camera->setRTBMapObject(rtbCamera);
+    objectGroup->addObject(camera);
+
+    // Saving in the background writes a copy of the map
+    const Map snapshot(map);
+
+    QByteArray data;
+    QBuffer buffer(&data);
+    buffer.open(QIODevice::WriteOnly);
+
+    MapWriter writer;
+    writer.writeMap(&snapshot, &buffer);
+    buffer.close();
+
+    buffer.open(QIODevice::ReadOnly);
+
+    MapReader reader;
+    QScopedPointer<Map> loaded(reader.readMap(&buffer));
+    QVERIFY2(loaded, qPrintable(reader.errorString()));
+    QCOMPARE(loaded->nextObjectId(), map.nextObjectId());
+    QCOMPARE(loaded->layerCount(), 1);
+
+    const ObjectGroup *loadedGroup = loaded->layerAt(0)->asObjectGroup();
+    QVERIFY(loadedGroup);
+    QCOMPARE(loadedGroup->objectCount(), objectGroup->objectCount());
+
+    for (int i = 0; i < objectGroup->objectCount(); ++i) {
+        QVERIFY(objectGroup->objectAt(i)->id() != 0);
+        QCOMPARE(loadedGroup->objectAt(i)->id(), objectGroup->objectAt(i)->id());
+    }
+
+    const RTBMapObject *loadedTeleporter = loadedGroup->objectAt(1)->rtbMapObject();
+    QVERIFY(loadedTeleporter);
+    QCOMPARE(loadedTeleporter->objectType(), int(RTBMapObject::Teleporter));
+    QCOMPARE(static_cast<const RTBTeleporter*>(loadedTeleporter)->teleporterTarget(),
+             QString::number(loadedGroup->objectAt(0)->id()));
+
+    const RTBMapObject *loadedCamera = loadedGroup->objectAt(2)->rtbMapObject();
+    QVERIFY(loadedCamera);
+    QCOMPARE(loadedCamera->objectType(), int(RTBMapObject::CameraTrigger));
+    QCOMPARE(static_cast<const RTBCameraTrigger*>(loadedCamera)->target(),
+             QString::number(loadedGroup->objectAt(0)->id()));
+}
+
 QTEST_MAIN(test_MapReader)
 #include "test_mapreader.moc"
@@ -1,4 +1,6 @@
 TEMPLATE=subdirs
 SUBDIRS = \
+    binarymap \
+    jsonreader \
     mapreader \
     staggeredrenderer
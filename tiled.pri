@@ -22,3 +22,9 @@ CONFIG += depend_includepath c++11
 !isEmpty(USE_FHS_PLUGIN_PATH) {
     DEFINES += TILED_PLUGIN_DIR=\\\"$${LIBDIR}/tiled/plugins/\\\"
 }
+
+# Build with CONFIG+=tracing to record timed zones that can be exported as a
+# Chrome trace (see src/libtiled/tracing.h)
+tracing {
+    DEFINES += TILED_ENABLE_TRACING
+}